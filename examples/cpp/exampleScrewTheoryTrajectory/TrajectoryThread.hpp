@@ -3,45 +3,33 @@
 #ifndef __TRAJECTORY_THREAD_HPP__
 #define __TRAJECTORY_THREAD_HPP__
 
+#include <vector>
+
 #include <yarp/os/PeriodicThread.h>
 
-#include <yarp/dev/IEncoders.h>
 #include <yarp/dev/IPositionDirect.h>
 
-#include <ScrewTheoryIkProblem.hpp>
-#include <ConfigurationSelector.hpp>
-#include <ICartesianTrajectory.hpp>
+#include <kdl/jntarray.hpp>
 
 class TrajectoryThread : public yarp::os::PeriodicThread
 {
 public:
-    TrajectoryThread(yarp::dev::IEncoders * iEncoders, yarp::dev::IPositionDirect * iPosDirect,
-            roboticslab::ScrewTheoryIkProblem * ikProblem,
-            roboticslab::ConfigurationSelector * ikConfig,
-            roboticslab::ICartesianTrajectory * iCartTrajectory,
+    TrajectoryThread(yarp::dev::IPositionDirect * iPosDirect,
+            const std::vector<KDL::JntArray> & path,
             int period)
         : yarp::os::PeriodicThread(period * 0.001),
-          iEncoders(iEncoders),
           iPosDirect(iPosDirect),
-          ikProblem(ikProblem),
-          ikConfig(ikConfig),
-          iCartTrajectory(iCartTrajectory),
-          axes(0),
-          startTime(0)
+          path(path),
+          index(0)
     {}
 
 protected:
-    virtual bool threadInit();
     virtual void run();
 
 private:
-    yarp::dev::IEncoders * iEncoders;
     yarp::dev::IPositionDirect * iPosDirect;
-    roboticslab::ScrewTheoryIkProblem * ikProblem;
-    roboticslab::ConfigurationSelector * ikConfig;
-    roboticslab::ICartesianTrajectory * iCartTrajectory;
-    int axes;
-    double startTime;
+    const std::vector<KDL::JntArray> & path;
+    int index;
 };
 
 #endif  // __TRAJECTORY_THREAD_HPP__
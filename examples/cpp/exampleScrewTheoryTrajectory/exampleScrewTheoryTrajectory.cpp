@@ -49,13 +49,14 @@ make -j$(nproc)
 
 #include <ColorDebug.h>
 
-#include <ConfigurationSelector.hpp>
 #include <KdlTrajectory.hpp>
 #include <KdlVectorConverter.hpp>
 #include <KinematicRepresentation.hpp>
 #include <MatrixExponential.hpp>
 #include <ProductOfExponentials.hpp>
 #include <ScrewTheoryIkProblem.hpp>
+#include <ScrewTheoryPathSolver.hpp>
+#include <ThreadPool.hpp>
 
 #include "TrajectoryThread.hpp"
 
@@ -184,10 +185,10 @@ int main(int argc, char *argv[])
             CD_ERROR("Unable to retrieve limits for joint %d.\n", i);
             return 1;
         }
-    }
 
-    rl::ConfigurationSelectorLeastOverallAngularDisplacementFactory confFactory(qMin, qMax);
-    std::auto_ptr<rl::ConfigurationSelector> ikConfig(confFactory.create());
+        qMin(i) = rl::KinRepresentation::degToRad(qMin(i));
+        qMax(i) = rl::KinRepresentation::degToRad(qMax(i));
+    }
 
     std::vector<double> x = rl::KdlVectorConverter::frameToVector(H);
 
@@ -211,6 +212,37 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    // Sample the whole trajectory beforehand, one waypoint per command period.
+    std::vector<KDL::Frame> waypoints;
+
+    for (double movementTime = 0.0; movementTime <= trajDuration; movementTime += periodMs * 0.001)
+    {
+        std::vector<double> position;
+
+        if (!trajectory.getPosition(movementTime, position))
+        {
+            CD_ERROR("Unable to sample cartesian trajectory at %f.\n", movementTime);
+            return 1;
+        }
+
+        waypoints.push_back(rl::KdlVectorConverter::vectorToFrame(position));
+    }
+
+    // Pick the IK branch sequence of least overall joint displacement.
+    rl::ScrewTheoryPathSolver pathSolver(*ikProblem, qMin, qMax);
+    rl::ThreadPool pool;
+
+    std::vector<KDL::JntArray> path;
+    double cost;
+
+    if (!pathSolver.solve(waypoints, jntArray, path, &pool, &cost))
+    {
+        CD_ERROR("Unable to solve IK along the trajectory.\n");
+        return 1;
+    }
+
+    CD_INFO("Joint-space path found: %d waypoints, overall displacement %f rad.\n", (int)path.size(), cost);
+
     std::vector<int> modes(axes, VOCAB_CM_POSITION_DIRECT);
 
     if (!iControlMode->setControlModes(modes.data()))
@@ -219,7 +251,7 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    TrajectoryThread trajThread(iEncoders, iPositionDirect, ikProblem.get(), ikConfig.get(), &trajectory, periodMs);
+    TrajectoryThread trajThread(iPositionDirect, path, periodMs);
 
     if (trajThread.start())
     {
@@ -20,6 +20,44 @@ KDL::Frame vectorToFrame(const std::vector<double> &x)
         return KDL::Frame::Identity();
     }
 
+    return arrayToFrame(x.data());
+}
+
+// -----------------------------------------------------------------------------
+
+std::vector<double> frameToVector(const KDL::Frame& f)
+{
+    std::vector<double> x(6);
+    frameToArray(f, x.data());
+    return x;
+}
+
+// -----------------------------------------------------------------------------
+
+KDL::Twist vectorToTwist(const std::vector<double> &xdot)
+{
+    if (xdot.size() != 6)
+    {
+        CD_WARNING("Size mismatch; expected: 6, was: %d\n", xdot.size());
+        return KDL::Twist::Zero();
+    }
+
+    return arrayToTwist(xdot.data());
+}
+
+// -----------------------------------------------------------------------------
+
+std::vector<double> twistToVector(const KDL::Twist& t)
+{
+    std::vector<double> xdot(6);
+    twistToArray(t, xdot.data());
+    return xdot;
+}
+
+// -----------------------------------------------------------------------------
+
+KDL::Frame arrayToFrame(const double * x)
+{
     KDL::Frame f;
 
     f.p.x(x[0]);
@@ -35,10 +73,8 @@ KDL::Frame vectorToFrame(const std::vector<double> &x)
 
 // -----------------------------------------------------------------------------
 
-std::vector<double> frameToVector(const KDL::Frame& f)
+void frameToArray(const KDL::Frame & f, double * x)
 {
-    std::vector<double> x(6);
-
     x[0] = f.p.x();
     x[1] = f.p.y();
     x[2] = f.p.z();
@@ -48,20 +84,12 @@ std::vector<double> frameToVector(const KDL::Frame& f)
     x[3] = rotVector.x();
     x[4] = rotVector.y();
     x[5] = rotVector.z();
-
-    return x;
 }
 
 // -----------------------------------------------------------------------------
 
-KDL::Twist vectorToTwist(const std::vector<double> &xdot)
+KDL::Twist arrayToTwist(const double * xdot)
 {
-    if (xdot.size() != 6)
-    {
-        CD_WARNING("Size mismatch; expected: 6, was: %d\n", xdot.size());
-        return KDL::Twist::Zero();
-    }
-
     KDL::Twist t;
 
     t.vel.x(xdot[0]);
@@ -77,10 +105,8 @@ KDL::Twist vectorToTwist(const std::vector<double> &xdot)
 
 // -----------------------------------------------------------------------------
 
-std::vector<double> twistToVector(const KDL::Twist& t)
+void twistToArray(const KDL::Twist & t, double * xdot)
 {
-    std::vector<double> xdot(6);
-
     xdot[0] = t.vel.x();
     xdot[1] = t.vel.y();
     xdot[2] = t.vel.z();
@@ -88,8 +114,6 @@ std::vector<double> twistToVector(const KDL::Twist& t)
     xdot[3] = t.rot.x();
     xdot[4] = t.rot.y();
     xdot[5] = t.rot.z();
-
-    return xdot;
 }
 
 // -----------------------------------------------------------------------------
@@ -63,6 +63,14 @@ public:
         q = *optimalConfig.retrievePose();
     }
 
+    //! @brief Joint array of minimum joint limits.
+    const KDL::JntArray & getMinLimits() const
+    { return _qMin; }
+
+    //! @brief Joint array of maximum joint limits.
+    const KDL::JntArray & getMaxLimits() const
+    { return _qMax; }
+
 protected:
 
     /**
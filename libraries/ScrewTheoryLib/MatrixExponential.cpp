@@ -2,6 +2,8 @@
 
 #include "MatrixExponential.hpp"
 
+#include <cmath>
+
 #include <ColorDebug.h>
 
 #include "ScrewTheoryTools.hpp"
@@ -12,11 +14,11 @@ using namespace roboticslab;
 
 namespace
 {
-    inline KDL::Rotation operator-(const KDL::Rotation & lhs, const KDL::Rotation & rhs)
+    inline void sinCos(double theta, double & s, double & c)
     {
-        return KDL::Rotation(lhs(0, 0) - rhs(0, 0), lhs(0, 1) - rhs(0, 1), lhs(0, 2) - rhs(0, 2),
-                             lhs(1, 0) - rhs(1, 0), lhs(1, 1) - rhs(1, 1), lhs(1, 2) - rhs(1, 2),
-                             lhs(2, 0) - rhs(2, 0), lhs(2, 1) - rhs(2, 1), lhs(2, 2) - rhs(2, 2));
+        // Merged into a single sincos() call by optimizing compilers.
+        s = std::sin(theta);
+        c = std::cos(theta);
     }
 }
 
@@ -28,6 +30,40 @@ MatrixExponential::MatrixExponential(motion _motionType, const KDL::Vector & _ax
       origin(_origin)
 {
     axis.Normalize();
+    updateScrewData();
+}
+
+// -----------------------------------------------------------------------------
+
+void MatrixExponential::updateScrewData()
+{
+    // Rodrigues' formula: R = cos(theta) * I + sin(theta) * [w] + (1 - cos(theta)) * w * w^T,
+    // and the translation of a rotation about an axis through point q is (I - R) * q_n, where
+    // q_n is the component of q normal to w. Since R * q_n = cos(theta) * q_n + sin(theta) * (w x q),
+    // it follows that p = (1 - cos(theta)) * q_n - sin(theta) * (w x q).
+    axisPow = vectorPow2(axis);
+    originNormal = axis * origin * axis;
+    axisCrossOrigin = axis * origin;
+}
+
+// -----------------------------------------------------------------------------
+
+inline void MatrixExponential::rotationAsFrame(double theta, KDL::Frame & H) const
+{
+    double s, c;
+    sinCos(theta, s, c);
+
+    const double v = 1.0 - c;
+
+    const double sx = s * axis.x();
+    const double sy = s * axis.y();
+    const double sz = s * axis.z();
+
+    H.M = KDL::Rotation(c + v * axisPow(0, 0), v * axisPow(0, 1) - sz, v * axisPow(0, 2) + sy,
+                        v * axisPow(1, 0) + sz, c + v * axisPow(1, 1), v * axisPow(1, 2) - sx,
+                        v * axisPow(2, 0) - sy, v * axisPow(2, 1) + sx, c + v * axisPow(2, 2));
+
+    H.p = originNormal * v - axisCrossOrigin * s;
 }
 
 // -----------------------------------------------------------------------------
@@ -39,8 +75,7 @@ KDL::Frame MatrixExponential::asFrame(double theta) const
     switch (motionType)
     {
     case ROTATION:
-        H.M = KDL::Rotation::Rot2(axis, theta);
-        H.p = (KDL::Rotation::Identity() - H.M) * (axis * origin * axis);
+        rotationAsFrame(theta, H);
         break;
     case TRANSLATION:
         H.p = axis * theta;
@@ -54,6 +89,50 @@ KDL::Frame MatrixExponential::asFrame(double theta) const
 
 // -----------------------------------------------------------------------------
 
+void MatrixExponential::asFrames(const double * thetas, int n, KDL::Frame * frames) const
+{
+    switch (motionType)
+    {
+    case ROTATION:
+        for (int i = 0; i < n; i++)
+        {
+            rotationAsFrame(thetas[i], frames[i]);
+        }
+        break;
+    case TRANSLATION:
+        for (int i = 0; i < n; i++)
+        {
+            frames[i] = KDL::Frame(axis * thetas[i]);
+        }
+        break;
+    default:
+        CD_WARNING("Unrecognized motion type: %d.\n", motionType);
+
+        for (int i = 0; i < n; i++)
+        {
+            frames[i] = KDL::Frame::Identity();
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+KDL::Twist MatrixExponential::asTwist() const
+{
+    switch (motionType)
+    {
+    case ROTATION:
+        return KDL::Twist(origin * axis, axis);
+    case TRANSLATION:
+        return KDL::Twist(axis, KDL::Vector::Zero());
+    default:
+        CD_WARNING("Unrecognized motion type: %d.\n", motionType);
+        return KDL::Twist::Zero();
+    }
+}
+
+// -----------------------------------------------------------------------------
+
 void MatrixExponential::changeBase(const KDL::Frame & H_new_old)
 {
     axis = H_new_old.M * axis;
@@ -62,6 +141,8 @@ void MatrixExponential::changeBase(const KDL::Frame & H_new_old)
     {
         origin = H_new_old * origin;
     }
+
+    updateScrewData();
 }
 
 // -----------------------------------------------------------------------------
@@ -39,12 +39,37 @@ public:
     /**
      * @brief Evaluates this term for the given magnitude of the screw
      *
+     * Angle-invariant parts of the exponential are precomputed upon construction
+     * and change of base, only the angle-dependent terms are evaluated here.
+     *
      * @param theta Input magnitude this screw should be computed at.
      *
      * @return Resulting homogeneous transformation matrix.
      */
     KDL::Frame asFrame(double theta) const;
 
+    /**
+     * @brief Evaluates this term for several magnitudes of the screw
+     *
+     * Same as calling @ref asFrame on each element, but the motion type is
+     * resolved once for the whole batch.
+     *
+     * @param thetas Input array of magnitudes.
+     * @param n Number of elements in \p thetas.
+     * @param frames Output array of at least \p n homogeneous transformation matrices.
+     */
+    void asFrames(const double * thetas, int n, KDL::Frame * frames) const;
+
+    /**
+     * @brief Unit twist associated to this screw
+     *
+     * Spatial velocity of a rigid body moving along this screw at unit speed,
+     * expressed in the base frame.
+     *
+     * @return Resulting twist.
+     */
+    KDL::Twist asTwist() const;
+
     /**
      * @brief Retrieves the \ref motion type of this screw
      *
@@ -91,9 +116,18 @@ public:
 
 private:
 
+    void updateScrewData();
+
+    void rotationAsFrame(double theta, KDL::Frame & H) const;
+
     motion motionType;
     KDL::Vector axis;
     KDL::Vector origin;
+
+    // Angle-invariant terms of a rotation, see updateScrewData().
+    KDL::Rotation axisPow;
+    KDL::Vector originNormal;
+    KDL::Vector axisCrossOrigin;
 };
 
 }  // namespace roboticslab
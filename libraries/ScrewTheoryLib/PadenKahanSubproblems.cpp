@@ -22,7 +22,8 @@ PadenKahanOne::PadenKahanOne(int _id, const MatrixExponential & _exp, const KDL:
 bool PadenKahanOne::solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const
 {
     solutions.resize(PadenKahanOne::solutions());
-    JointIdsToSolutions jointIdsToSolutions(1);
+    JointIdsToSolutions & jointIdsToSolutions = solutions[0];
+    jointIdsToSolutions.resize(1);
 
     KDL::Vector f = pointTransform * p;
     KDL::Vector k = rhs * p;
@@ -39,13 +40,28 @@ bool PadenKahanOne::solve(const KDL::Frame & rhs, const KDL::Frame & pointTransf
     double theta = std::atan2(KDL::dot(exp.getAxis(), u_p * v_p), KDL::dot(u_p, v_p));
 
     jointIdsToSolutions[0] = std::make_pair(id, normalizeAngle(theta));
-    solutions[0] = jointIdsToSolutions;
 
     return KDL::Equal(u_w, v_w) && KDL::Equal(u_p.Norm(), v_p.Norm());
 }
 
 // -----------------------------------------------------------------------------
 
+int PadenKahanOne::solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count, Solutions * solutions,
+        bool * reachable) const
+{
+    SubproblemParams params = SubproblemParams();
+    toArray(exp.getAxis(), params.axis1);
+    toArray(exp.getOrigin(), params.origin1);
+
+    const int ids[] = {id};
+    const SubproblemKernels & kernels = getSubproblemKernels();
+
+    return solveSubproblemBatch(kernels.padenKahanOne, kernels.lanes, params, p, ids, PadenKahanOne::solutions(), 1,
+            rhs, pointTransforms, count, solutions, reachable);
+}
+
+// -----------------------------------------------------------------------------
+
 PadenKahanTwo::PadenKahanTwo(int _id1, int _id2, const MatrixExponential & _exp1, const MatrixExponential & _exp2, const KDL::Vector & _p, const KDL::Vector & _r)
   : id1(_id1),
     id2(_id2),
@@ -64,7 +80,10 @@ PadenKahanTwo::PadenKahanTwo(int _id1, int _id2, const MatrixExponential & _exp1
 bool PadenKahanTwo::solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const
 {
     solutions.resize(PadenKahanTwo::solutions());
-    JointIdsToSolutions jointIdsToSolution1(2), jointIdsToSolution2(2);
+    JointIdsToSolutions & jointIdsToSolution1 = solutions[0];
+    JointIdsToSolutions & jointIdsToSolution2 = solutions[1];
+    jointIdsToSolution1.resize(2);
+    jointIdsToSolution2.resize(2);
 
     KDL::Vector f = pointTransform * p;
     KDL::Vector k = rhs * p;
@@ -140,14 +159,30 @@ bool PadenKahanTwo::solve(const KDL::Frame & rhs, const KDL::Frame & pointTransf
         ret = gamma2_zero && KDL::Equal(n1_p.Norm(), v_p.Norm());
     }
 
-    solutions[0] = jointIdsToSolution1;
-    solutions[1] = jointIdsToSolution2;
-
     return ret;
 }
 
 // -----------------------------------------------------------------------------
 
+int PadenKahanTwo::solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count, Solutions * solutions,
+        bool * reachable) const
+{
+    SubproblemParams params = SubproblemParams();
+    toArray(exp1.getAxis(), params.axis1);
+    toArray(exp2.getAxis(), params.axis2);
+    toArray(r, params.point);
+    toArray(axesCross, params.cross);
+    params.scalar = axesDot;
+
+    const int ids[] = {id1, id2};
+    const SubproblemKernels & kernels = getSubproblemKernels();
+
+    return solveSubproblemBatch(kernels.padenKahanTwo, kernels.lanes, params, p, ids, PadenKahanTwo::solutions(), 2,
+            rhs, pointTransforms, count, solutions, reachable);
+}
+
+// -----------------------------------------------------------------------------
+
 PadenKahanThree::PadenKahanThree(int _id, const MatrixExponential & _exp, const KDL::Vector & _p, const KDL::Vector & _k)
     : id(_id),
       exp(_exp),
@@ -161,7 +196,10 @@ PadenKahanThree::PadenKahanThree(int _id, const MatrixExponential & _exp, const
 bool PadenKahanThree::solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const
 {
     solutions.resize(PadenKahanThree::solutions());
-    JointIdsToSolutions jointIdsToSolution1(1), jointIdsToSolution2(1);
+    JointIdsToSolutions & jointIdsToSolution1 = solutions[0];
+    JointIdsToSolutions & jointIdsToSolution2 = solutions[1];
+    jointIdsToSolution1.resize(1);
+    jointIdsToSolution2.resize(1);
 
     KDL::Vector f = pointTransform * p;
     KDL::Vector rhsAsVector = rhs * p - k;
@@ -206,10 +244,24 @@ bool PadenKahanThree::solve(const KDL::Frame & rhs, const KDL::Frame & pointTran
         ret = beta_zero;
     }
 
-    solutions[0] = jointIdsToSolution1;
-    solutions[1] = jointIdsToSolution2;
-
     return ret;
 }
 
 // -----------------------------------------------------------------------------
+
+int PadenKahanThree::solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count, Solutions * solutions,
+        bool * reachable) const
+{
+    SubproblemParams params = SubproblemParams();
+    toArray(exp.getAxis(), params.axis1);
+    toArray(exp.getOrigin(), params.origin1);
+    toArray(k, params.point);
+
+    const int ids[] = {id};
+    const SubproblemKernels & kernels = getSubproblemKernels();
+
+    return solveSubproblemBatch(kernels.padenKahanThree, kernels.lanes, params, p, ids, PadenKahanThree::solutions(), 1,
+            rhs, pointTransforms, count, solutions, reachable);
+}
+
+// -----------------------------------------------------------------------------
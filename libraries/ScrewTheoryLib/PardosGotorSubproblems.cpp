@@ -32,7 +32,8 @@ PardosGotorOne::PardosGotorOne(int _id, const MatrixExponential & _exp, const KD
 bool PardosGotorOne::solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const
 {
     solutions.resize(PardosGotorOne::solutions());
-    JointIdsToSolutions jointIdsToSolutions(1);
+    JointIdsToSolutions & jointIdsToSolutions = solutions[0];
+    jointIdsToSolutions.resize(1);
 
     KDL::Vector f = pointTransform * p;
     KDL::Vector k = rhs * p;
@@ -41,13 +42,27 @@ bool PardosGotorOne::solve(const KDL::Frame & rhs, const KDL::Frame & pointTrans
     double theta = KDL::dot(exp.getAxis(), diff);
 
     jointIdsToSolutions[0] = std::make_pair(id, theta);
-    solutions[0] = jointIdsToSolutions;
 
     return true;
 }
 
 // -----------------------------------------------------------------------------
 
+int PardosGotorOne::solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count, Solutions * solutions,
+        bool * reachable) const
+{
+    SubproblemParams params = SubproblemParams();
+    toArray(exp.getAxis(), params.axis1);
+
+    const int ids[] = {id};
+    const SubproblemKernels & kernels = getSubproblemKernels();
+
+    return solveSubproblemBatch(kernels.pardosGotorOne, kernels.lanes, params, p, ids, PardosGotorOne::solutions(), 1,
+            rhs, pointTransforms, count, solutions, reachable);
+}
+
+// -----------------------------------------------------------------------------
+
 PardosGotorTwo::PardosGotorTwo(int _id1, int _id2, const MatrixExponential & _exp1, const MatrixExponential & _exp2, const KDL::Vector & _p)
     : id1(_id1),
       id2(_id2),
@@ -63,7 +78,8 @@ PardosGotorTwo::PardosGotorTwo(int _id1, int _id2, const MatrixExponential & _ex
 bool PardosGotorTwo::solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const
 {
     solutions.resize(PardosGotorTwo::solutions());
-    JointIdsToSolutions jointIdsToSolutions(2);
+    JointIdsToSolutions & jointIdsToSolutions = solutions[0];
+    jointIdsToSolutions.resize(2);
 
     KDL::Vector f = pointTransform * p;
     KDL::Vector k = rhs * p;
@@ -88,13 +104,29 @@ bool PardosGotorTwo::solve(const KDL::Frame & rhs, const KDL::Frame & pointTrans
     jointIdsToSolutions[0] = std::make_pair(id1, theta1);
     jointIdsToSolutions[1] = std::make_pair(id2, theta2);
 
-    solutions[0] = jointIdsToSolutions;
-
     return true;
 }
 
 // -----------------------------------------------------------------------------
 
+int PardosGotorTwo::solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count, Solutions * solutions,
+        bool * reachable) const
+{
+    SubproblemParams params = SubproblemParams();
+    toArray(exp1.getAxis(), params.axis1);
+    toArray(exp2.getAxis(), params.axis2);
+    toArray(crossPr2, params.cross);
+    params.scalar = crossPr2Norm;
+
+    const int ids[] = {id1, id2};
+    const SubproblemKernels & kernels = getSubproblemKernels();
+
+    return solveSubproblemBatch(kernels.pardosGotorTwo, kernels.lanes, params, p, ids, PardosGotorTwo::solutions(), 2,
+            rhs, pointTransforms, count, solutions, reachable);
+}
+
+// -----------------------------------------------------------------------------
+
 PardosGotorThree::PardosGotorThree(int _id, const MatrixExponential & _exp, const KDL::Vector & _p, const KDL::Vector & _k)
     : id(_id),
       exp(_exp),
@@ -107,7 +139,10 @@ PardosGotorThree::PardosGotorThree(int _id, const MatrixExponential & _exp, cons
 bool PardosGotorThree::solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const
 {
     solutions.resize(PardosGotorThree::solutions());
-    JointIdsToSolutions jointIdsToSolution1(1), jointIdsToSolution2(1);
+    JointIdsToSolutions & jointIdsToSolution1 = solutions[0];
+    JointIdsToSolutions & jointIdsToSolution2 = solutions[1];
+    jointIdsToSolution1.resize(1);
+    jointIdsToSolution2.resize(1);
 
     KDL::Vector f = pointTransform * p;
     KDL::Vector rhsAsVector = rhs * p - k;
@@ -137,14 +172,27 @@ bool PardosGotorThree::solve(const KDL::Frame & rhs, const KDL::Frame & pointTra
         ret = sq2_zero;
     }
 
-    solutions[0] = jointIdsToSolution1;
-    solutions[1] = jointIdsToSolution2;
-
     return ret;
 }
 
 // -----------------------------------------------------------------------------
 
+int PardosGotorThree::solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count, Solutions * solutions,
+        bool * reachable) const
+{
+    SubproblemParams params = SubproblemParams();
+    toArray(exp.getAxis(), params.axis1);
+    toArray(k, params.point);
+
+    const int ids[] = {id};
+    const SubproblemKernels & kernels = getSubproblemKernels();
+
+    return solveSubproblemBatch(kernels.pardosGotorThree, kernels.lanes, params, p, ids, PardosGotorThree::solutions(), 1,
+            rhs, pointTransforms, count, solutions, reachable);
+}
+
+// -----------------------------------------------------------------------------
+
 PardosGotorFour::PardosGotorFour(int _id1, int _id2, const MatrixExponential & _exp1, const MatrixExponential & _exp2, const KDL::Vector & _p)
     : id1(_id1),
       id2(_id2),
@@ -160,7 +208,10 @@ PardosGotorFour::PardosGotorFour(int _id1, int _id2, const MatrixExponential & _
 bool PardosGotorFour::solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const
 {
     solutions.resize(PardosGotorFour::solutions());
-    JointIdsToSolutions jointIdsToSolution1(2), jointIdsToSolution2(2);
+    JointIdsToSolutions & jointIdsToSolution1 = solutions[0];
+    JointIdsToSolutions & jointIdsToSolution2 = solutions[1];
+    jointIdsToSolution1.resize(2);
+    jointIdsToSolution2.resize(2);
 
     KDL::Vector f = pointTransform * p;
     KDL::Vector k = rhs * p;
@@ -246,10 +297,26 @@ bool PardosGotorFour::solve(const KDL::Frame & rhs, const KDL::Frame & pointTran
         ret = c_zero;
     }
 
-    solutions[0] = jointIdsToSolution1;
-    solutions[1] = jointIdsToSolution2;
-
     return ret;
 }
 
 // -----------------------------------------------------------------------------
+
+int PardosGotorFour::solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count, Solutions * solutions,
+        bool * reachable) const
+{
+    SubproblemParams params = SubproblemParams();
+    toArray(exp1.getAxis(), params.axis1);
+    toArray(exp2.getAxis(), params.axis2);
+    toArray(exp1.getOrigin(), params.origin1);
+    toArray(exp2.getOrigin(), params.origin2);
+    toArray(n, params.point);
+
+    const int ids[] = {id1, id2};
+    const SubproblemKernels & kernels = getSubproblemKernels();
+
+    return solveSubproblemBatch(kernels.pardosGotorFour, kernels.lanes, params, p, ids, PardosGotorFour::solutions(), 2,
+            rhs, pointTransforms, count, solutions, reachable);
+}
+
+// -----------------------------------------------------------------------------
@@ -49,6 +49,12 @@ namespace
             return UNKNOWN_OR_STATIC_JOINT;
         }
     }
+
+    // Lie bracket of two twists, i.e. the derivative of b as it moves along a.
+    inline KDL::Twist lieBracket(const KDL::Twist & a, const KDL::Twist & b)
+    {
+        return KDL::Twist(a.rot * b.vel - b.rot * a.vel, a.rot * b.rot);
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -99,6 +105,111 @@ bool PoeExpression::evaluate(const KDL::JntArray & q, KDL::Frame & H) const
 
 // -----------------------------------------------------------------------------
 
+bool PoeExpression::evaluate(const KDL::JntArray & q, KDL::Frame & H, KDL::Jacobian & J, jacobian_frame frame) const
+{
+    return evaluateJacobian(q, NULL, H, J, NULL, frame);
+}
+
+// -----------------------------------------------------------------------------
+
+bool PoeExpression::evaluate(const KDL::JntArray & q, const KDL::JntArray & qdot, KDL::Frame & H, KDL::Jacobian & J,
+        KDL::Jacobian & Jdot, jacobian_frame frame) const
+{
+    return evaluateJacobian(q, &qdot, H, J, &Jdot, frame);
+}
+
+// -----------------------------------------------------------------------------
+
+bool PoeExpression::evaluateJacobian(const KDL::JntArray & q, const KDL::JntArray * qdot, KDL::Frame & H,
+        KDL::Jacobian & J, KDL::Jacobian * Jdot, jacobian_frame frame) const
+{
+    if (exps.size() != q.rows() || exps.size() != J.columns())
+    {
+        CD_WARNING("Size mismatch: %d (terms of PoE) != %d (joint array) or %d (Jacobian).\n", exps.size(), q.rows(), J.columns());
+        return false;
+    }
+
+    if (qdot != NULL && (exps.size() != qdot->rows() || exps.size() != Jdot->columns()))
+    {
+        CD_WARNING("Size mismatch: %d (terms of PoE) != %d (joint velocities) or %d (Jacobian derivative).\n",
+                exps.size(), qdot->rows(), Jdot->columns());
+        return false;
+    }
+
+    // Spatial velocity of the frame reached so far.
+    KDL::Twist V = KDL::Twist::Zero();
+
+    H = KDL::Frame::Identity();
+
+    for (int i = 0; i < exps.size(); i++)
+    {
+        // Adjoint of the product of preceding terms applied to this twist.
+        KDL::Twist xi = H * exps[i].asTwist();
+        J.setColumn(i, xi);
+
+        if (qdot != NULL)
+        {
+            // Only preceding joints move this twist around.
+            Jdot->setColumn(i, lieBracket(V, xi));
+            V = V + xi * (*qdot)(i);
+        }
+
+        H = H * exps[i].asFrame(q(i));
+    }
+
+    H = H * H_S_T;
+
+    switch (frame)
+    {
+    case SPATIAL:
+        break;
+    case BODY:
+    {
+        KDL::Frame H_inv = H.Inverse();
+
+        for (int i = 0; i < exps.size(); i++)
+        {
+            KDL::Twist xi = J.getColumn(i);
+            J.setColumn(i, H_inv * xi);
+
+            if (qdot != NULL)
+            {
+                // d/dt Ad(H^-1) = -Ad(H^-1) * ad(V)
+                Jdot->setColumn(i, H_inv * (Jdot->getColumn(i) - lieBracket(V, xi)));
+            }
+        }
+
+        break;
+    }
+    case HYBRID:
+    {
+        // Linear velocity of the tool origin.
+        KDL::Vector pdot = V.vel + V.rot * H.p;
+
+        for (int i = 0; i < exps.size(); i++)
+        {
+            KDL::Twist xi = J.getColumn(i);
+            J.setColumn(i, xi.RefPoint(H.p));
+
+            if (qdot != NULL)
+            {
+                KDL::Twist xidot = Jdot->getColumn(i);
+                Jdot->setColumn(i, KDL::Twist(xidot.vel + xidot.rot * H.p + xi.rot * pdot, xidot.rot));
+            }
+        }
+
+        break;
+    }
+    default:
+        CD_WARNING("Unrecognized Jacobian frame: %d.\n", frame);
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 void PoeExpression::reverseSelf()
 {
     H_S_T = H_S_T.Inverse();
@@ -191,3 +302,76 @@ PoeExpression PoeExpression::fromChain(const KDL::Chain & chain)
 }
 
 // -----------------------------------------------------------------------------
+
+PoeEvaluator::PoeEvaluator(const PoeExpression & _poe)
+    : poe(_poe),
+      jointValues(_poe.size()),
+      terms(_poe.size()),
+      prefixes(_poe.size()),
+      suffixes(_poe.size() + 1, _poe.getTransform()),
+      validSuffixes(_poe.size()),
+      updatedTerms(0),
+      initialized(false)
+{}
+
+// -----------------------------------------------------------------------------
+
+bool PoeEvaluator::evaluate(const KDL::JntArray & q, KDL::Frame & H)
+{
+    const int size = poe.size();
+
+    if (size != q.rows())
+    {
+        CD_WARNING("Size mismatch: %d (terms of PoE) != %d (joint array).\n", size, q.rows());
+        return false;
+    }
+
+    // Leftmost and rightmost changed terms.
+    int first = size;
+    int last = -1;
+
+    updatedTerms = 0;
+
+    for (int i = 0; i < size; i++)
+    {
+        if (!initialized || q(i) != jointValues(i))
+        {
+            terms[i] = poe.exponentialAtJoint(i).asFrame(q(i));
+            jointValues(i) = q(i);
+            updatedTerms++;
+
+            first = std::min(first, i);
+            last = i;
+        }
+    }
+
+    initialized = true;
+
+    // Same order of operations as in PoeExpression::evaluate.
+    for (int i = first; i < size; i++)
+    {
+        prefixes[i] = (i == 0 ? KDL::Frame::Identity() : prefixes[i - 1]) * terms[i];
+    }
+
+    validSuffixes = std::max(validSuffixes, last + 1);
+
+    H = (size == 0 ? KDL::Frame::Identity() : prefixes[size - 1]) * poe.getTransform();
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+const KDL::Frame & PoeEvaluator::getSuffix(int i)
+{
+    for (int j = validSuffixes - 1; j >= i; j--)
+    {
+        suffixes[j] = terms[j] * suffixes[j + 1];
+    }
+
+    validSuffixes = std::min(validSuffixes, i);
+
+    return suffixes[i];
+}
+
+// -----------------------------------------------------------------------------
@@ -7,6 +7,7 @@
 
 #include <kdl/chain.hpp>
 #include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
 #include <kdl/jntarray.hpp>
 
 #include "MatrixExponential.hpp"
@@ -28,6 +29,14 @@ class PoeExpression
 {
 public:
 
+    //! Lists available Jacobian representations.
+    enum jacobian_frame
+    {
+        SPATIAL, ///< Twists expressed in the base frame, reference point at the base origin.
+        BODY,    ///< Twists expressed in the tool frame, reference point at the tool origin.
+        HYBRID   ///< Twists expressed in the base frame, reference point at the tool origin (as in KDL).
+    };
+
     /**
      * @brief Constructor
      *
@@ -116,6 +125,41 @@ public:
      */
     bool evaluate(const KDL::JntArray & q, KDL::Frame & H) const;
 
+    /**
+     * @brief Performs forward kinematics and computes the Jacobian
+     *
+     * Columns of the spatial Jacobian are the POE twists transformed by the adjoint
+     * of the preceding terms, all of them obtained within the same pass that yields
+     * the pose.
+     *
+     * @param q Input joint array (radians).
+     * @param H Output pose in cartesian space, same as in @ref evaluate.
+     * @param J Output Jacobian, must have as many columns as terms in this POE.
+     * @param frame Representation of the Jacobian as defined in @ref jacobian_frame.
+     *
+     * @return False on size mismatch.
+     */
+    bool evaluate(const KDL::JntArray & q, KDL::Frame & H, KDL::Jacobian & J, jacobian_frame frame = SPATIAL) const;
+
+    /**
+     * @brief Performs forward kinematics and computes the Jacobian and its time derivative
+     *
+     * Columns of the time derivative are obtained in closed form from the Lie
+     * brackets of the spatial Jacobian columns, within the same pass.
+     *
+     * @param q Input joint array (radians).
+     * @param qdot Input joint velocities (radians/second).
+     * @param H Output pose in cartesian space, same as in @ref evaluate.
+     * @param J Output Jacobian, must have as many columns as terms in this POE.
+     * @param Jdot Output Jacobian time derivative, must have as many columns as
+     * terms in this POE.
+     * @param frame Representation of both matrices as defined in @ref jacobian_frame.
+     *
+     * @return False on size mismatch.
+     */
+    bool evaluate(const KDL::JntArray & q, const KDL::JntArray & qdot, KDL::Frame & H, KDL::Jacobian & J,
+            KDL::Jacobian & Jdot, jacobian_frame frame = SPATIAL) const;
+
     /**
      * @brief Inverts this POE formula
      *
@@ -160,10 +204,112 @@ public:
 
 private:
 
+    bool evaluateJacobian(const KDL::JntArray & q, const KDL::JntArray * qdot, KDL::Frame & H, KDL::Jacobian & J,
+            KDL::Jacobian * Jdot, jacobian_frame frame) const;
+
     std::vector<MatrixExponential> exps;
     KDL::Frame H_S_T;
 };
 
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Incremental forward kinematics of a POE formula
+ *
+ * Remembers the last joint values along with every POE term, evaluated at them,
+ * and the products of the leading terms (prefix products). Only terms whose joint
+ * value has changed since the previous call are evaluated again, and only prefix
+ * products downstream of the first such joint are recomputed. Products of the
+ * trailing terms and the tool frame (suffix products) are updated on demand.
+ *
+ * Results match those of @ref PoeExpression::evaluate bit by bit. Instances are not
+ * thread-safe.
+ */
+class PoeEvaluator
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param poe Product of exponentials (POE) formula, copied.
+     */
+    explicit PoeEvaluator(const PoeExpression & poe);
+
+    /**
+     * @brief Performs forward kinematics
+     *
+     * @param q Input joint array (radians).
+     * @param H Output pose in cartesian space.
+     *
+     * @return False if the size of the input joint array does not match the size
+     * of the POE.
+     */
+    bool evaluate(const KDL::JntArray & q, KDL::Frame & H);
+
+    /**
+     * @brief Product of the POE terms up to and including the i-th one
+     *
+     * Pre-multiply the pose of any link following the i-th joint at the zero
+     * configuration by this frame to obtain its current pose. Valid after a
+     * successful call to @ref evaluate.
+     *
+     * @param i Joint index, in [0, size).
+     *
+     * @return Prefix product, as of the last evaluation.
+     */
+    const KDL::Frame & getPrefix(int i) const
+    { return prefixes[i]; }
+
+    /**
+     * @brief Product of the POE terms from the i-th one onwards, and the tool frame
+     *
+     * Valid after a successful call to @ref evaluate.
+     *
+     * @param i Joint index, in [0, size]. Returns the tool frame if equal to size.
+     *
+     * @return Suffix product, as of the last evaluation.
+     */
+    const KDL::Frame & getSuffix(int i);
+
+    /**
+     * @brief The i-th POE term, as of the last evaluation
+     *
+     * @param i Joint index, in [0, size).
+     *
+     * @return Term evaluated at the last joint value.
+     */
+    const KDL::Frame & getTerm(int i) const
+    { return terms[i]; }
+
+    //! Number of POE terms evaluated in the last call to @ref evaluate
+    int getUpdatedTerms() const
+    { return updatedTerms; }
+
+    //! Forces a full evaluation on the next call to @ref evaluate
+    void reset()
+    { initialized = false; }
+
+    //! Underlying POE formula
+    const PoeExpression & getPoe() const
+    { return poe; }
+
+private:
+
+    PoeExpression poe;
+
+    KDL::JntArray jointValues;
+
+    std::vector<KDL::Frame> terms;
+    std::vector<KDL::Frame> prefixes;
+    std::vector<KDL::Frame> suffixes;
+
+    // Suffixes at indices >= this one are up to date.
+    int validSuffixes;
+    int updatedTerms;
+    bool initialized;
+};
+
 }  // namespace roboticslab
 
 #endif  // __PRODUCT_OF_EXPONENTIALS_HPP__
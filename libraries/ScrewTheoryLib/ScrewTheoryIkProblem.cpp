@@ -3,9 +3,14 @@
 #include "ScrewTheoryIkProblem.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <numeric>
 
+#include <kdl/utilities/utility.h>
+
+#include "ThreadPool.hpp"
+
 using namespace roboticslab;
 
 // -----------------------------------------------------------------------------
@@ -26,6 +31,30 @@ namespace
     }
     solutionAccumulator;
 
+    inline bool isJointInLimits(double q, double qMin, double qMax)
+    {
+        return q >= (qMin - KDL::epsilon) && q <= (qMax + KDL::epsilon);
+    }
+
+    std::vector<ScrewTheoryIkSubproblem::JointIdsToSolutions> probeJointIds(const ScrewTheoryIkProblem::Steps & steps)
+    {
+        std::vector<ScrewTheoryIkSubproblem::JointIdsToSolutions> jointIds(steps.size());
+
+        // Joint ids do not depend on the input frames, only the values do.
+        for (int i = 0; i < steps.size(); i++)
+        {
+            ScrewTheoryIkSubproblem::Solutions probe;
+            steps[i]->solve(KDL::Frame::Identity(), KDL::Frame::Identity(), probe);
+
+            if (probe.size() != 0)
+            {
+                jointIds[i] = probe[0];
+            }
+        }
+
+        return jointIds;
+    }
+
     inline int computeSolutions(const ScrewTheoryIkProblem::Steps & steps)
     {
         if (!steps.empty())
@@ -41,11 +70,34 @@ namespace
 
 // -----------------------------------------------------------------------------
 
+int ScrewTheoryIkSubproblem::solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count,
+        Solutions * solutions, bool * reachable) const
+{
+    int reachableCount = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        bool ret = solve(rhs[i], pointTransforms[i], solutions[i]);
+
+        if (reachable != NULL)
+        {
+            reachable[i] = ret;
+        }
+
+        reachableCount += ret;
+    }
+
+    return reachableCount;
+}
+
+// -----------------------------------------------------------------------------
+
 ScrewTheoryIkProblem::ScrewTheoryIkProblem(const PoeExpression & _poe, const Steps & _steps, bool _reversed)
     : poe(_poe),
       steps(_steps),
       reversed(_reversed),
-      soln(computeSolutions(steps))
+      soln(computeSolutions(steps)),
+      stepJointIds(probeJointIds(steps))
 {}
 
 // -----------------------------------------------------------------------------
@@ -60,23 +112,131 @@ ScrewTheoryIkProblem::~ScrewTheoryIkProblem()
 
 // -----------------------------------------------------------------------------
 
-bool ScrewTheoryIkProblem::solve(const KDL::Frame & H_S_T, Solutions & solutions)
+bool ScrewTheoryIkProblem::solve(const KDL::Frame & H_S_T, Solutions & solutions) const
+{
+    Workspace workspace(*this);
+    return solve(H_S_T, solutions, workspace);
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryIkProblem::solve(const KDL::Frame & H_S_T, Solutions & solutions, Workspace & workspace) const
+{
+    if (solutions.size() != soln)
+    {
+        solutions.resize(soln, KDL::JntArray(poe.size()));
+    }
+
+    if (soln == 0)
+    {
+        return true;
+    }
+
+    return solve(H_S_T, &solutions[0], workspace);
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryIkProblem::solve(const KDL::Frame & H_S_T, Solutions & solutions, const KDL::JntArray & qMin,
+        const KDL::JntArray & qMax, Workspace & workspace, PruningStats * stats) const
+{
+    if (solutions.size() != soln)
+    {
+        solutions.resize(soln, KDL::JntArray(poe.size()));
+    }
+
+    if (soln == 0)
+    {
+        return true;
+    }
+
+    if (qMin.rows() != poe.size() || qMax.rows() != poe.size())
+    {
+        return solve(H_S_T, &solutions[0], workspace, NULL, NULL, stats);
+    }
+
+    return solve(H_S_T, &solutions[0], workspace, &qMin, &qMax, stats);
+}
+
+// -----------------------------------------------------------------------------
+
+int ScrewTheoryIkProblem::solveBatch(const KDL::Frame * targets, int count, KDL::JntArray * solutions, bool * reachable,
+        ThreadPool * pool) const
 {
-    if (!solutions.empty())
+    if (soln == 0)
     {
-        solutions.clear();
+        return count;
     }
 
-    // Reserve space in memory to avoid additional allocations on runtime.
-    solutions.reserve(soln);
-    solutions.push_back(KDL::JntArray(poe.size()));
+    std::atomic<int> reachableCount(0);
 
-    PoeTerms poeTerms(poe.size(), EXP_UNKNOWN);
+    ThreadPool::Task task = [&](int start, int end)
+    {
+        // Shared across all target poses of this chunk.
+        Workspace workspace(*this);
 
-    Frames rhsFrames;
+        int localCount = 0;
 
-    rhsFrames.reserve(soln);
-    rhsFrames.push_back((reversed ? H_S_T.Inverse() : H_S_T) * poe.getTransform().Inverse());
+        for (int i = start; i < end; i++)
+        {
+            bool ret = solve(targets[i], solutions + i * soln, workspace);
+
+            if (reachable != NULL)
+            {
+                reachable[i] = ret;
+            }
+
+            localCount += ret;
+        }
+
+        reachableCount += localCount;
+    };
+
+    if (pool != NULL)
+    {
+        pool->parallelFor(count, task);
+    }
+    else
+    {
+        task(0, count);
+    }
+
+    return reachableCount;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryIkProblem::solve(const KDL::Frame & H_S_T, KDL::JntArray * solutions, Workspace & workspace,
+        const KDL::JntArray * qMin, const KDL::JntArray * qMax, PruningStats * stats) const
+{
+    Frames & rhsFrames = workspace.rhsFrames;
+    PoeTerms & poeTerms = workspace.poeTerms;
+    std::vector<char> & pruned = workspace.pruned;
+
+    // Noop if sized for this problem, i.e. when reused across many target poses.
+    rhsFrames.resize(soln);
+    workspace.auxFrames.resize(soln);
+    workspace.termFrames.resize(soln);
+    workspace.thetas.resize(soln);
+    poeTerms.assign(poe.size(), EXP_UNKNOWN);
+    pruned.assign(soln, false);
+
+    const bool checkLimits = qMin != NULL && qMax != NULL;
+
+    for (int i = 0; i < soln; i++)
+    {
+        if (solutions[i].rows() != poe.size())
+        {
+            solutions[i].resize(poe.size());
+        }
+    }
+
+    KDL::SetToZero(solutions[0]);
+
+    rhsFrames[0] = (reversed ? H_S_T.Inverse() : H_S_T) * poe.getTransform().Inverse();
+
+    // Number of (partial) solutions found so far, grows on each step up to `soln`.
+    int size = 1;
 
     bool firstIteration = true;
     bool reachable = true;
@@ -86,39 +246,64 @@ bool ScrewTheoryIkProblem::solve(const KDL::Frame & H_S_T, Solutions & solutions
         if (!firstIteration)
         {
             // Re-compute right-hand side of PoE equation, i.e. prod(e_i) = H_S_T_q * H_S_T_0^(-1)
-            recalculateFrames(solutions, rhsFrames, poeTerms);
+            recalculateFrames(solutions, size, rhsFrames, workspace);
         }
 
-        // Save this, the vector of solutions might be resized in the following loop, increase size
-        // on demand for improved efficiency (instead of allocating everything from the start).
-        int previousSize = solutions.size();
+        // Save this, the number of solutions might be increased in the following loop.
+        int previousSize = size;
+
+        // The global number of solutions is increased by this step.
+        size = previousSize * steps[i]->solutions();
 
         for (int j = 0; j < previousSize; j++)
         {
+            if (pruned[j])
+            {
+                // At least one joint of this branch is out of limits, don't waste time on it.
+                for (int k = 1; k < steps[i]->solutions(); k++)
+                {
+                    solutions[j + previousSize * k] = solutions[j];
+                    pruned[j + previousSize * k] = true;
+                }
+
+                // Keep track of joint ids as if this branch had been solved.
+                const ScrewTheoryIkSubproblem::JointIdsToSolutions & jointIds = stepJointIds[i];
+
+                for (int l = 0; l < jointIds.size(); l++)
+                {
+                    poeTerms[jointIds[l].first] = EXP_KNOWN;
+                }
+
+                if (stats != NULL)
+                {
+                    stats->skippedSubproblems++;
+                }
+
+                continue;
+            }
+
             // Apply known frames to the first characteristic point for each subproblem.
             const KDL::Frame & H = transformPoint(solutions[j], poeTerms);
 
+            // Stack-resident, filled in place by the subproblem solver.
             ScrewTheoryIkSubproblem::Solutions partialSolutions;
 
             // Actually solve each subproblem, use current right-hand side of PoE to obtain
             // the right-hand side of said subproblem.
             reachable = reachable & steps[i]->solve(rhsFrames[j], H, partialSolutions);
 
-            // The global number of solutions is increased by this step.
-            if (partialSolutions.size() > 1)
+            if (stats != NULL)
             {
-                // Noop if current size is not less than requested.
-                solutions.resize(previousSize * partialSolutions.size());
-                rhsFrames.resize(previousSize * partialSolutions.size());
+                stats->solvedSubproblems++;
+            }
 
-                for (int k = 1; k < partialSolutions.size(); k++)
-                {
-                    // Replicate known solutions, these won't change further on.
-                    solutions[j + previousSize * k] = solutions[j];
+            for (int k = 1; k < partialSolutions.size(); k++)
+            {
+                // Replicate known solutions, these won't change further on.
+                solutions[j + previousSize * k] = solutions[j];
 
-                    // Replicate right-hand side frames for the next iteration, these might change.
-                    rhsFrames[j + previousSize * k] = rhsFrames[j];
-                }
+                // Replicate right-hand side frames for the next iteration, these might change.
+                rhsFrames[j + previousSize * k] = rhsFrames[j];
             }
 
             // For each local solution of this subproblem...
@@ -145,6 +330,12 @@ bool ScrewTheoryIkProblem::solve(const KDL::Frame & H_S_T, Solutions & solutions
 
                     // Store the final value in the desired index, don't shuffle it after this point.
                     solutions[j + previousSize * k](id) = theta;
+
+                    // Drop the whole branch as soon as one of its joints exceeds the limits.
+                    if (checkLimits && !isJointInLimits(theta, (*qMin)(id), (*qMax)(id)))
+                    {
+                        pruned[j + previousSize * k] = true;
+                    }
                 }
             }
         }
@@ -152,39 +343,136 @@ bool ScrewTheoryIkProblem::solve(const KDL::Frame & H_S_T, Solutions & solutions
         firstIteration = false;
     }
 
+    if (stats != NULL)
+    {
+        stats->prunedSolutions += std::count(pruned.begin(), pruned.begin() + size, true);
+    }
+
+    return reachable;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryIkProblem::solveBranch(const KDL::Frame & H_S_T, int branch, KDL::JntArray & solution, Workspace & workspace) const
+{
+    if (branch < 0 || branch >= soln)
+    {
+        return false;
+    }
+
+    Frames & rhsFrames = workspace.rhsFrames;
+    PoeTerms & poeTerms = workspace.poeTerms;
+
+    // Noop if sized for this problem, only the first element is used.
+    rhsFrames.resize(soln);
+    workspace.auxFrames.resize(soln);
+    workspace.termFrames.resize(soln);
+    workspace.thetas.resize(soln);
+    poeTerms.assign(poe.size(), EXP_UNKNOWN);
+
+    if (solution.rows() != poe.size())
+    {
+        solution.resize(poe.size());
+    }
+
+    KDL::SetToZero(solution);
+
+    rhsFrames[0] = (reversed ? H_S_T.Inverse() : H_S_T) * poe.getTransform().Inverse();
+
+    // Number of partial solutions the exhaustive search would have found before each step.
+    int previousSize = 1;
+
+    bool reachable = true;
+
+    for (int i = 0; i < steps.size(); i++)
+    {
+        if (i != 0)
+        {
+            recalculateFrames(&solution, 1, rhsFrames, workspace);
+        }
+
+        // Solutions are laid out as in solve(), i.e. index = j + previousSize * k.
+        int j = branch % previousSize;
+        int k = (branch / previousSize) % steps[i]->solutions();
+
+        if (j != 0)
+        {
+            // Replicate the bookkeeping of solve(), in which the first partial solution has
+            // already been processed at this point and its joints have been marked as known.
+            const ScrewTheoryIkSubproblem::JointIdsToSolutions & jointIds = stepJointIds[i];
+
+            for (int l = 0; l < jointIds.size(); l++)
+            {
+                poeTerms[jointIds[l].first] = EXP_KNOWN;
+            }
+        }
+
+        const KDL::Frame & H = transformPoint(solution, poeTerms);
+
+        ScrewTheoryIkSubproblem::Solutions partialSolutions;
+        reachable = reachable & steps[i]->solve(rhsFrames[0], H, partialSolutions);
+
+        const ScrewTheoryIkSubproblem::JointIdsToSolutions & jointIdsToSolutions = partialSolutions[k];
+
+        for (int l = 0; l < jointIdsToSolutions.size(); l++)
+        {
+            int id = jointIdsToSolutions[l].first;
+            double theta = jointIdsToSolutions[l].second;
+
+            poeTerms[id] = EXP_KNOWN;
+
+            if (reversed)
+            {
+                id = poe.size() - 1 - id;
+                theta = -theta;
+            }
+
+            solution(id) = theta;
+        }
+
+        previousSize *= steps[i]->solutions();
+    }
+
     return reachable;
 }
 
 // -----------------------------------------------------------------------------
 
-void ScrewTheoryIkProblem::recalculateFrames(const Solutions & solutions, Frames & frames, PoeTerms & poeTerms)
+void ScrewTheoryIkProblem::recalculateFrames(const KDL::JntArray * solutions, int size, Frames & frames, Workspace & workspace) const
 {
-    std::vector<KDL::Frame> pre, post;
+    const Frames & auxFrames = workspace.auxFrames;
 
     // Leftmost known terms of the PoE.
-    if (recalculateFrames(solutions, pre, poeTerms, false))
+    if (recalculateFrames(solutions, size, workspace, false))
     {
-        for (int i = 0; i < solutions.size(); i++)
+        for (int i = 0; i < size; i++)
         {
-            frames[i] = pre[i].Inverse() * frames[i];
+            frames[i] = auxFrames[i].Inverse() * frames[i];
         }
     }
 
     // Rightmost known terms of the PoE.
-    if (recalculateFrames(solutions, post, poeTerms, true))
+    if (recalculateFrames(solutions, size, workspace, true))
     {
-        for (int i = 0; i < solutions.size(); i++)
+        for (int i = 0; i < size; i++)
         {
-            frames[i] = frames[i] * post[i].Inverse();
+            frames[i] = frames[i] * auxFrames[i].Inverse();
         }
     }
 }
 
 // -----------------------------------------------------------------------------
 
-bool ScrewTheoryIkProblem::recalculateFrames(const Solutions & solutions, Frames & frames, PoeTerms & poeTerms, bool backwards)
+bool ScrewTheoryIkProblem::recalculateFrames(const KDL::JntArray * solutions, int size, Workspace & workspace,
+        bool backwards) const
 {
-    frames.resize(solutions.size());
+    Frames & frames = workspace.auxFrames;
+    PoeTerms & poeTerms = workspace.poeTerms;
+
+    for (int j = 0; j < size; j++)
+    {
+        frames[j] = KDL::Frame::Identity();
+    }
 
     bool hasMultipliedTerms = false;
 
@@ -197,10 +485,16 @@ bool ScrewTheoryIkProblem::recalculateFrames(const Solutions & solutions, Frames
 
         if (poeTerms[i] == EXP_KNOWN)
         {
-            for (int j = 0; j < solutions.size(); j++)
+            for (int j = 0; j < size; j++)
+            {
+                workspace.thetas[j] = getTheta(solutions[j], i, reversed);
+            }
+
+            poe.exponentialAtJoint(i).asFrames(workspace.thetas.data(), size, workspace.termFrames.data());
+
+            for (int j = 0; j < size; j++)
             {
-                const MatrixExponential & exp = poe.exponentialAtJoint(i);
-                frames[j] = frames[j] * exp.asFrame(getTheta(solutions[j], i, reversed));
+                frames[j] = frames[j] * workspace.termFrames[j];
             }
 
             // Mark as 'computed' and include in right-hand side of PoE so that this
@@ -224,7 +518,7 @@ bool ScrewTheoryIkProblem::recalculateFrames(const Solutions & solutions, Frames
 
 // -----------------------------------------------------------------------------
 
-KDL::Frame ScrewTheoryIkProblem::transformPoint(const KDL::JntArray & jointValues, const PoeTerms & poeTerms)
+KDL::Frame ScrewTheoryIkProblem::transformPoint(const KDL::JntArray & jointValues, const PoeTerms & poeTerms) const
 {
     KDL::Frame H;
 
@@ -265,6 +559,166 @@ KDL::Frame ScrewTheoryIkProblem::transformPoint(const KDL::JntArray & jointValue
 
 // -----------------------------------------------------------------------------
 
+ScrewTheoryIkProblem::Workspace::Workspace(const ScrewTheoryIkProblem & problem)
+    : rhsFrames(problem.soln),
+      auxFrames(problem.soln),
+      termFrames(problem.soln),
+      thetas(problem.soln),
+      poeTerms(problem.poe.size(), EXP_UNKNOWN),
+      pruned(problem.soln, false)
+{}
+
+// -----------------------------------------------------------------------------
+
+int ScrewTheoryIkProblem::findSolution(const KDL::Frame & H_S_T, const SolutionPredicate & predicate, KDL::JntArray & solution) const
+{
+    SolutionIterator it(*this, H_S_T);
+    KDL::JntArray q;
+
+    while (it.next(q))
+    {
+        if (predicate(q, it.isReachable()))
+        {
+            solution = q;
+            return it.index();
+        }
+    }
+
+    return -1;
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryIkProblem::SolutionIterator::SolutionIterator(const ScrewTheoryIkProblem & _problem, const KDL::Frame & H_S_T)
+    : problem(_problem),
+      workspace(_problem),
+      nodes(_problem.steps.size() + 1),
+      depth(-1),
+      currentIndex(-1),
+      currentReachable(false),
+      solved(0)
+{
+    if (problem.steps.empty())
+    {
+        return;
+    }
+
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        nodes[i].q.resize(problem.poe.size());
+        nodes[i].poeTerms.resize(problem.poe.size());
+        nodes[i].rhsFrames.resize(1);
+    }
+
+    Node & root = nodes[0];
+
+    KDL::SetToZero(root.q);
+    root.poeTerms.assign(problem.poe.size(), EXP_UNKNOWN);
+    root.rhsFrames[0] = (problem.reversed ? H_S_T.Inverse() : H_S_T) * problem.poe.getTransform().Inverse();
+    root.index = 0;
+    root.size = 1;
+    root.reachable = true;
+
+    depth = 0;
+    expand(depth);
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryIkProblem::SolutionIterator::next(KDL::JntArray & solution)
+{
+    const int steps = problem.steps.size();
+
+    while (depth >= 0)
+    {
+        Node & node = nodes[depth];
+
+        if (node.next >= node.partialSolutions.size())
+        {
+            // All children visited, backtrack.
+            depth--;
+            continue;
+        }
+
+        int k = node.next++;
+
+        Node & child = nodes[depth + 1];
+
+        child.q = node.q;
+        child.poeTerms = node.poeTerms;
+        child.rhsFrames[0] = node.rhsFrames[0];
+        child.index = node.index + node.size * k;
+        child.size = node.size * problem.steps[depth]->solutions();
+        child.reachable = node.reachable;
+
+        const ScrewTheoryIkSubproblem::JointIdsToSolutions & jointIdsToSolutions = node.partialSolutions[k];
+
+        for (int l = 0; l < jointIdsToSolutions.size(); l++)
+        {
+            int id = jointIdsToSolutions[l].first;
+            double theta = jointIdsToSolutions[l].second;
+
+            child.poeTerms[id] = EXP_KNOWN;
+
+            if (problem.reversed)
+            {
+                id = problem.poe.size() - 1 - id;
+                theta = -theta;
+            }
+
+            child.q(id) = theta;
+        }
+
+        if (depth + 1 == steps)
+        {
+            // Leaf node, stay at this depth so that siblings are visited next.
+            solution = child.q;
+            currentIndex = child.index;
+            currentReachable = child.reachable;
+            return true;
+        }
+
+        expand(++depth);
+    }
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+void ScrewTheoryIkProblem::SolutionIterator::expand(int level)
+{
+    Node & node = nodes[level];
+
+    if (level != 0)
+    {
+        // Re-compute right-hand side of PoE equation, see ScrewTheoryIkProblem::solve.
+        workspace.poeTerms = node.poeTerms;
+        problem.recalculateFrames(&node.q, 1, node.rhsFrames, workspace);
+        node.poeTerms = workspace.poeTerms;
+    }
+
+    if (node.index != 0)
+    {
+        // Same bookkeeping as in ScrewTheoryIkProblem::solveBranch.
+        const ScrewTheoryIkSubproblem::JointIdsToSolutions & jointIds = problem.stepJointIds[level];
+
+        for (int l = 0; l < jointIds.size(); l++)
+        {
+            node.poeTerms[jointIds[l].first] = EXP_KNOWN;
+        }
+    }
+
+    const KDL::Frame & H = problem.transformPoint(node.q, node.poeTerms);
+
+    node.reachable = node.reachable & problem.steps[level]->solve(node.rhsFrames[0], H, node.partialSolutions);
+    node.next = 0;
+
+    solved++;
+}
+
+// -----------------------------------------------------------------------------
+
 ScrewTheoryIkProblem * ScrewTheoryIkProblem::create(const PoeExpression & poe, const Steps & steps, bool reversed)
 {
     // TODO: validate
@@ -3,6 +3,8 @@
 #ifndef __SCREW_THEORY_IK_PROBLEM_HPP__
 #define __SCREW_THEORY_IK_PROBLEM_HPP__
 
+#include <cassert>
+#include <functional>
 #include <utility>
 #include <vector>
 
@@ -14,6 +16,84 @@
 namespace roboticslab
 {
 
+class ThreadPool;
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Vector-like container of bounded size with in-place storage
+ *
+ * Elements live inside the object itself, hence no heap allocations are ever
+ * performed. Resizing beyond @p N elements is not allowed.
+ *
+ * @tparam T Default-constructible element type.
+ * @tparam N Maximum number of elements.
+ */
+template <typename T, int N>
+class FixedCapacityVector
+{
+public:
+
+    typedef T value_type;
+    typedef T * iterator;
+    typedef const T * const_iterator;
+
+    //! Constructs an empty container
+    FixedCapacityVector() : count(0)
+    {}
+
+    //! Constructs a container of @p size default-constructed elements
+    explicit FixedCapacityVector(int size) : count(size)
+    { assert(size >= 0 && size <= N); }
+
+    //! Number of elements
+    int size() const
+    { return count; }
+
+    //! Maximum number of elements
+    static int capacity()
+    { return N; }
+
+    //! Whether the container holds no elements
+    bool empty() const
+    { return count == 0; }
+
+    //! Changes the number of elements, surviving ones are left untouched
+    void resize(int size)
+    { assert(size >= 0 && size <= N); count = size; }
+
+    //! Removes all elements
+    void clear()
+    { count = 0; }
+
+    //! Appends an element
+    void push_back(const T & value)
+    { assert(count < N); elements[count++] = value; }
+
+    T & operator[](int i)
+    { return elements[i]; }
+
+    const T & operator[](int i) const
+    { return elements[i]; }
+
+    iterator begin()
+    { return elements; }
+
+    iterator end()
+    { return elements + count; }
+
+    const_iterator begin() const
+    { return elements; }
+
+    const_iterator end() const
+    { return elements + count; }
+
+private:
+
+    T elements[N];
+    int count;
+};
+
 /**
  * @ingroup ScrewTheoryLib
  *
@@ -29,11 +109,17 @@ public:
     //! Maps a joint id to a screw magnitude
     typedef std::pair<int, double> JointIdToSolution;
 
+    //! Maximum number of joints solved by a single subproblem
+    static const int MAX_JOINTS = 2;
+
+    //! Maximum number of local solutions, i.e. upper bound of solutions()
+    static const int MAX_SOLUTIONS = 2;
+
     //! At least one joint-id+value pair per solution
-    typedef std::vector<JointIdToSolution> JointIdsToSolutions;
+    typedef FixedCapacityVector<JointIdToSolution, MAX_JOINTS> JointIdsToSolutions;
 
     //! Collection of local IK solutions
-    typedef std::vector<JointIdsToSolutions> Solutions;
+    typedef FixedCapacityVector<JointIdsToSolutions, MAX_SOLUTIONS> Solutions;
 
     //! Destructor
     virtual ~ScrewTheoryIkSubproblem() {}
@@ -76,6 +162,25 @@ public:
      */
     virtual bool solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const = 0;
 
+    /**
+     * @brief Finds closed geometric solutions for a batch of independent inputs
+     *
+     * Equivalent to calling @ref solve on each pair of right-hand side and point
+     * transform. Derived classes may process several inputs at once by means of
+     * vectorized kernels, results might then differ in the last bits.
+     *
+     * @param rhs Array of @p count right-hand sides.
+     * @param pointTransforms Array of @p count point transforms.
+     * @param count Number of inputs.
+     * @param solutions Output array of @p count collections of local solutions.
+     * @param reachable Optional output array of @p count flags, each one set to
+     * the return value of @ref solve for the corresponding input.
+     *
+     * @return Number of inputs whose solutions are reachable.
+     */
+    virtual int solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count,
+            Solutions * solutions, bool * reachable) const;
+
     //! Number of local IK solutions
     virtual int solutions() const = 0;
 };
@@ -99,6 +204,31 @@ public:
     //! Collection of global IK solutions
     typedef std::vector<KDL::JntArray> Solutions;
 
+    class Workspace;
+    class SolutionIterator;
+
+    /**
+     * @brief Acceptance criterion for @ref findSolution
+     *
+     * Takes a candidate solution and whether it is reachable, returns true to stop
+     * the search.
+     */
+    typedef std::function<bool(const KDL::JntArray & solution, bool reachable)> SolutionPredicate;
+
+    //! Counters of the work saved by pruning branches out of joint limits, see solve()
+    struct PruningStats
+    {
+        PruningStats()
+            : solvedSubproblems(0),
+              skippedSubproblems(0),
+              prunedSolutions(0)
+        {}
+
+        int solvedSubproblems;  ///< Subproblem invocations actually performed
+        int skippedSubproblems; ///< Subproblem invocations avoided on pruned branches
+        int prunedSolutions;    ///< Global solutions discarded due to joint limits
+    };
+
     //! Destructor
     ~ScrewTheoryIkProblem();
 
@@ -110,12 +240,114 @@ public:
      *
      * @return True if all solutions are reachable, false otherwise.
      */
-    bool solve(const KDL::Frame & H_S_T, Solutions & solutions);
+    bool solve(const KDL::Frame & H_S_T, Solutions & solutions) const;
+
+    /**
+     * @brief Find all available solutions using caller-owned scratch memory
+     *
+     * No heap allocations are performed once both \p solutions and \p workspace
+     * have been used in a previous call. Concurrent calls on the same instance are
+     * allowed as long as each thread provides its own workspace.
+     *
+     * @param H_S_T Target pose in cartesian space.
+     * @param solutions Output vector of solutions stored as joint arrays.
+     * @param workspace Scratch memory created for this IK problem.
+     *
+     * @return True if all solutions are reachable, false otherwise.
+     */
+    bool solve(const KDL::Frame & H_S_T, Solutions & solutions, Workspace & workspace) const;
+
+    /**
+     * @brief Find all available solutions within joint limits
+     *
+     * A branch of the solution tree is dropped as soon as any joint solved so far
+     * falls out of range, and subsequent subproblems are skipped for it. The output
+     * vector is always fully populated, pruned solutions keep the offending joint
+     * value so that ConfigurationSelector::configure will reject them as well.
+     * Other joints of pruned solutions are left unsolved.
+     *
+     * @param H_S_T Target pose in cartesian space.
+     * @param solutions Output vector of solutions stored as joint arrays.
+     * @param qMin Joint array of minimum joint limits, ignored along with \p qMax
+     * if its size doesn't match the number of joints.
+     * @param qMax Joint array of maximum joint limits.
+     * @param workspace Scratch memory created for this IK problem.
+     * @param stats Optional counters, incremented (not reset) on each call.
+     *
+     * @return True if all solutions that have not been pruned are reachable,
+     * false otherwise.
+     */
+    bool solve(const KDL::Frame & H_S_T, Solutions & solutions, const KDL::JntArray & qMin, const KDL::JntArray & qMax,
+               Workspace & workspace, PruningStats * stats = NULL) const;
+
+    /**
+     * @brief Find a single solution following one path through the subproblem tree
+     *
+     * Only the local solution that leads to the requested global solution is kept
+     * at each step, thus each subproblem is solved once. The result is identical
+     * to the element at index \p branch of the output of @ref solve, hence this is
+     * well suited for tracking a previously selected configuration at a high rate.
+     *
+     * @param H_S_T Target pose in cartesian space.
+     * @param branch Index of the requested solution, in [0, solutions()).
+     * @param solution Output joint array.
+     * @param workspace Scratch memory created for this IK problem.
+     *
+     * @return True if this solution is reachable, false otherwise (or if the
+     * index is out of range).
+     */
+    bool solveBranch(const KDL::Frame & H_S_T, int branch, KDL::JntArray & solution, Workspace & workspace) const;
+
+    /**
+     * @brief Find the first solution that satisfies a predicate
+     *
+     * Solutions are produced lazily in depth-first order by a @ref SolutionIterator,
+     * the search stops as soon as the predicate accepts one of them.
+     *
+     * @param H_S_T Target pose in cartesian space.
+     * @param predicate Acceptance criterion.
+     * @param solution Output joint array, the accepted solution if found.
+     *
+     * @return Index of the accepted solution as laid out by @ref solve, -1 if
+     * none was accepted.
+     */
+    int findSolution(const KDL::Frame & H_S_T, const SolutionPredicate & predicate, KDL::JntArray & solution) const;
+
+    /**
+     * @brief Find all available solutions for a batch of target poses
+     *
+     * Solutions for the i-th target pose are stored in the output buffer at
+     * [i * solutions(), (i + 1) * solutions()).
+     *
+     * @param targets Contiguous array of target poses in cartesian space.
+     * @param count Number of target poses.
+     * @param solutions Preallocated output buffer of count * solutions() joint arrays.
+     * @param reachable Optional output array of \p count flags, each one set to true if
+     * all solutions for the corresponding target pose are reachable.
+     * @param pool Optional thread pool the batch is split across, all target poses are
+     * solved in the calling thread if NULL.
+     *
+     * @return Number of target poses for which all solutions are reachable.
+     */
+    int solveBatch(const KDL::Frame * targets, int count, KDL::JntArray * solutions,
+                   bool * reachable = NULL, ThreadPool * pool = NULL) const;
 
     //! Number of global IK solutions
     int solutions() const
     { return soln; }
 
+    //! Product of exponentials (POE) formula this problem was built from
+    const PoeExpression & getPoe() const
+    { return poe; }
+
+    //! Ordered sequence of IK subproblems, owned by this instance
+    const Steps & getSteps() const
+    { return steps; }
+
+    //! Whether the POE has been reversed in order to find a valid solution
+    bool isReversed() const
+    { return reversed; }
+
     /**
      * @brief Creates an IK solver instance given a sequence of known subproblems
      *
@@ -146,10 +378,13 @@ private:
     ScrewTheoryIkProblem(const ScrewTheoryIkProblem &);
     ScrewTheoryIkProblem & operator=(const ScrewTheoryIkProblem &);
 
-    void recalculateFrames(const Solutions & solutions, Frames & frames, PoeTerms & poeTerms);
-    bool recalculateFrames(const Solutions & solutions, Frames & frames, PoeTerms & poeTerms, bool backwards);
+    bool solve(const KDL::Frame & H_S_T, KDL::JntArray * solutions, Workspace & workspace,
+               const KDL::JntArray * qMin = NULL, const KDL::JntArray * qMax = NULL, PruningStats * stats = NULL) const;
+
+    void recalculateFrames(const KDL::JntArray * solutions, int size, Frames & frames, Workspace & workspace) const;
+    bool recalculateFrames(const KDL::JntArray * solutions, int size, Workspace & workspace, bool backwards) const;
 
-    KDL::Frame transformPoint(const KDL::JntArray & jointValues, const PoeTerms & poeTerms);
+    KDL::Frame transformPoint(const KDL::JntArray & jointValues, const PoeTerms & poeTerms) const;
 
     const PoeExpression poe;
 
@@ -159,6 +394,112 @@ private:
     const bool reversed;
 
     const int soln;
+
+    // Joint ids solved at each step, regardless of the target pose.
+    const std::vector<ScrewTheoryIkSubproblem::JointIdsToSolutions> stepJointIds;
+};
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Caller-owned scratch memory for a \ref ScrewTheoryIkProblem
+ *
+ * Holds all intermediate results of an IK query. Storage is sized once upon
+ * construction given the number of solutions and POE terms of the problem.
+ * Each thread should keep its own instance.
+ */
+class ScrewTheoryIkProblem::Workspace
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param problem IK problem this workspace will be used with.
+     */
+    explicit Workspace(const ScrewTheoryIkProblem & problem);
+
+private:
+
+    friend class ScrewTheoryIkProblem;
+    friend class ScrewTheoryIkProblem::SolutionIterator;
+
+    Frames rhsFrames;
+    Frames auxFrames;
+    Frames termFrames;
+    std::vector<double> thetas;
+    PoeTerms poeTerms;
+    std::vector<char> pruned;
+};
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Lazy, depth-first enumeration of the solutions of a \ref ScrewTheoryIkProblem
+ *
+ * Each subproblem is solved once per node of the solution tree, and only when the
+ * enumeration reaches said node. Obtaining the first solution thus takes as many
+ * subproblem invocations as steps there are, the whole tree is never materialized.
+ * Solutions are identical to those returned by ScrewTheoryIkProblem::solve, albeit
+ * in a different order, see @ref index.
+ */
+class ScrewTheoryIkProblem::SolutionIterator
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param problem IK problem, must outlive this instance.
+     * @param H_S_T Target pose in cartesian space.
+     */
+    SolutionIterator(const ScrewTheoryIkProblem & problem, const KDL::Frame & H_S_T);
+
+    /**
+     * @brief Produces the next solution
+     *
+     * @param solution Output joint array.
+     *
+     * @return False if there are no more solutions, true otherwise.
+     */
+    bool next(KDL::JntArray & solution);
+
+    //! Index of the last solution in the output of ScrewTheoryIkProblem::solve
+    int index() const
+    { return currentIndex; }
+
+    //! Whether the last solution is reachable
+    bool isReachable() const
+    { return currentReachable; }
+
+    //! Number of subproblems solved so far
+    int solvedSubproblems() const
+    { return solved; }
+
+private:
+
+    struct Node
+    {
+        KDL::JntArray q;
+        PoeTerms poeTerms;
+        Frames rhsFrames;
+        ScrewTheoryIkSubproblem::Solutions partialSolutions;
+        int index; // partial index, i.e. modulo the number of partial solutions so far
+        int size;  // number of partial solutions so far
+        int next;  // next local solution to visit
+        bool reachable;
+    };
+
+    void expand(int level);
+
+    const ScrewTheoryIkProblem & problem;
+    Workspace workspace;
+
+    std::vector<Node> nodes;
+    int depth;
+    int currentIndex;
+    bool currentReachable;
+    int solved;
 };
 
 /**
@@ -182,6 +523,42 @@ public:
         bool known, simplified;
     };
 
+    //! Serializable description of a single subproblem
+    struct StepDescription
+    {
+        //! Lists available subproblems
+        enum subproblem_type
+        {
+            PADEN_KAHAN_ONE,    //!< @ref PadenKahanOne
+            PADEN_KAHAN_TWO,    //!< @ref PadenKahanTwo
+            PADEN_KAHAN_THREE,  //!< @ref PadenKahanThree
+            PARDOS_GOTOR_ONE,   //!< @ref PardosGotorOne
+            PARDOS_GOTOR_TWO,   //!< @ref PardosGotorTwo
+            PARDOS_GOTOR_THREE, //!< @ref PardosGotorThree
+            PARDOS_GOTOR_FOUR   //!< @ref PardosGotorFour
+        };
+
+        StepDescription() : type(PADEN_KAHAN_ONE) {}
+
+        subproblem_type type;
+        std::vector<int> ids;             //!< Joint ids, in constructor order
+        std::vector<KDL::Vector> points;  //!< Characteristic points, in constructor order
+    };
+
+    /**
+     * @brief Serializable description of a built IK problem
+     *
+     * Holds the outcome of the search performed by @ref build, which can be
+     * replayed with @ref rebuild on the same POE.
+     */
+    struct Description
+    {
+        Description() : reversed(false) {}
+
+        bool reversed;                       //!< Whether the POE needs to be reversed
+        std::vector<StepDescription> steps;  //!< Ordered sequence of subproblems
+    };
+
     /**
      * @brief Constructor
      *
@@ -196,11 +573,42 @@ public:
      */
     ScrewTheoryIkProblem * build();
 
+    /**
+     * @brief Finds a valid sequence of geometric subproblems that solve a global IK problem
+     *
+     * @param description Output description of the IK problem, untouched if not found.
+     *
+     * @return An instance of an IK problem solver if valid, NULL otherwise.
+     */
+    ScrewTheoryIkProblem * build(Description & description);
+
+    /**
+     * @brief Instantiates an IK problem from a previous search, skipping it
+     *
+     * @param poe Product of exponentials (POE) formula the description was found for.
+     * @param description Description of the IK problem as returned by @ref build.
+     *
+     * @return An instance of an IK problem solver if valid, NULL otherwise.
+     */
+    static ScrewTheoryIkProblem * rebuild(const PoeExpression & poe, const Description & description);
+
+    /**
+     * @brief Adapts a description to a new tool frame, joint geometry is left untouched
+     *
+     * Characteristic points are expressed in the base frame, unless the POE has been
+     * reversed, in which case they are referred to the tool frame.
+     *
+     * @param description Description of the IK problem, modified in place.
+     * @param H_new_old Transformation between the new and the old tool frame, as in
+     * @ref PoeExpression::changeToolFrame.
+     */
+    static void changeToolFrame(Description & description, const KDL::Frame & H_new_old);
+
 private:
 
     static std::vector<KDL::Vector> searchPoints(const PoeExpression & poe);
 
-    ScrewTheoryIkProblem::Steps searchSolutions();
+    std::vector<StepDescription> searchSolutions();
 
     void refreshSimplificationState();
 
@@ -209,7 +617,10 @@ private:
     void simplifyWithPadenKahanThree(const KDL::Vector & point);
     void simplifyWithPardosOne();
 
-    ScrewTheoryIkSubproblem * trySolve(int depth);
+    bool trySolve(int depth, StepDescription & step);
+
+    static ScrewTheoryIkProblem * createProblem(const PoeExpression & poe, const Description & description);
+    static ScrewTheoryIkSubproblem * createSubproblem(const PoeExpression & poe, const StepDescription & step);
 
     PoeExpression poe;
 
@@ -137,6 +137,43 @@ namespace
 
         steps.clear();
     }
+
+    typedef ScrewTheoryIkProblemBuilder::StepDescription StepDescription;
+
+    StepDescription makeStep(StepDescription::subproblem_type type, int id, const KDL::Vector & p)
+    {
+        StepDescription step;
+        step.type = type;
+        step.ids.push_back(id);
+        step.points.push_back(p);
+        return step;
+    }
+
+    StepDescription makeStep(StepDescription::subproblem_type type, int id, const KDL::Vector & p, const KDL::Vector & k)
+    {
+        StepDescription step = makeStep(type, id, p);
+        step.points.push_back(k);
+        return step;
+    }
+
+    StepDescription makeStep(StepDescription::subproblem_type type, int id1, int id2, const KDL::Vector & p)
+    {
+        StepDescription step = makeStep(type, id1, p);
+        step.ids.push_back(id2);
+        return step;
+    }
+
+    StepDescription makeStep(StepDescription::subproblem_type type, int id1, int id2, const KDL::Vector & p, const KDL::Vector & r)
+    {
+        StepDescription step = makeStep(type, id1, id2, p);
+        step.points.push_back(r);
+        return step;
+    }
+
+    inline bool hasShape(const StepDescription & step, int ids, int points)
+    {
+        return step.ids.size() == ids && step.points.size() == points;
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -229,6 +266,14 @@ std::vector<KDL::Vector> ScrewTheoryIkProblemBuilder::searchPoints(const PoeExpr
 // -----------------------------------------------------------------------------
 
 ScrewTheoryIkProblem * ScrewTheoryIkProblemBuilder::build()
+{
+    Description description;
+    return build(description);
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryIkProblem * ScrewTheoryIkProblemBuilder::build(Description & description)
 {
     // Reset state, mark all PoE terms as unknown.
     for (std::vector<PoeTerm>::iterator it = poeTerms.begin(); it != poeTerms.end(); ++it)
@@ -237,17 +282,22 @@ ScrewTheoryIkProblem * ScrewTheoryIkProblemBuilder::build()
     }
 
     // Find solutions, if available.
-    ScrewTheoryIkProblem::Steps steps = searchSolutions();
+    std::vector<StepDescription> steps = searchSolutions();
 
     if (std::count_if(poeTerms.begin(), poeTerms.end(), knownTerm) == poe.size())
     {
         // Instantiate solver class.
-        return ScrewTheoryIkProblem::create(poe, steps);
-    }
-    else
-    {
-        // Free memory allocations.
-        clearSteps(steps);
+        Description found;
+        found.steps = steps;
+
+        ScrewTheoryIkProblem * problem = createProblem(poe, found);
+
+        if (problem != NULL)
+        {
+            description = found;
+        }
+
+        return problem;
     }
 
     // No solution found, try with reversed PoE.
@@ -262,11 +312,156 @@ ScrewTheoryIkProblem * ScrewTheoryIkProblemBuilder::build()
 
     if (std::count_if(poeTerms.begin(), poeTerms.end(), knownTerm) == poe.size())
     {
-        return ScrewTheoryIkProblem::create(poe, steps, true);
+        Description found;
+        found.reversed = true;
+        found.steps = steps;
+
+        ScrewTheoryIkProblem * problem = createProblem(poe, found);
+
+        if (problem != NULL)
+        {
+            description = found;
+        }
+
+        return problem;
     }
-    else
+
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryIkProblem * ScrewTheoryIkProblemBuilder::rebuild(const PoeExpression & poe, const Description & description)
+{
+    if (!description.reversed)
+    {
+        return createProblem(poe, description);
+    }
+
+    // Same steps as in build(), results must match bit by bit.
+    PoeExpression reversedPoe = poe;
+    reversedPoe.reverseSelf();
+
+    return createProblem(reversedPoe, description);
+}
+
+// -----------------------------------------------------------------------------
+
+void ScrewTheoryIkProblemBuilder::changeToolFrame(Description & description, const KDL::Frame & H_new_old)
+{
+    if (!description.reversed)
+    {
+        // Subproblems act on the product of exponentials only, the tool frame is irrelevant.
+        return;
+    }
+
+    KDL::Frame H_old_new = H_new_old.Inverse();
+
+    for (int i = 0; i < description.steps.size(); i++)
+    {
+        std::vector<KDL::Vector> & points = description.steps[i].points;
+
+        for (int j = 0; j < points.size(); j++)
+        {
+            points[j] = H_old_new * points[j];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryIkProblem * ScrewTheoryIkProblemBuilder::createProblem(const PoeExpression & poe, const Description & description)
+{
+    ScrewTheoryIkProblem::Steps steps;
+    std::vector<bool> known(poe.size(), false);
+
+    for (int i = 0; i < description.steps.size(); i++)
+    {
+        ScrewTheoryIkSubproblem * subproblem = createSubproblem(poe, description.steps[i]);
+
+        if (subproblem == NULL)
+        {
+            // Free memory allocations.
+            clearSteps(steps);
+            return NULL;
+        }
+
+        steps.push_back(subproblem);
+
+        for (int j = 0; j < description.steps[i].ids.size(); j++)
+        {
+            known[description.steps[i].ids[j]] = true;
+        }
+    }
+
+    if (std::count(known.begin(), known.end(), true) != poe.size())
     {
         clearSteps(steps);
+        return NULL;
+    }
+
+    return ScrewTheoryIkProblem::create(poe, steps, description.reversed);
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryIkSubproblem * ScrewTheoryIkProblemBuilder::createSubproblem(const PoeExpression & poe, const StepDescription & step)
+{
+    for (int i = 0; i < step.ids.size(); i++)
+    {
+        if (step.ids[i] < 0 || step.ids[i] >= poe.size())
+        {
+            return NULL;
+        }
+    }
+
+    const std::vector<int> & ids = step.ids;
+    const std::vector<KDL::Vector> & points = step.points;
+
+    switch (step.type)
+    {
+    case StepDescription::PADEN_KAHAN_ONE:
+        if (hasShape(step, 1, 1))
+        {
+            return new PadenKahanOne(ids[0], poe.exponentialAtJoint(ids[0]), points[0]);
+        }
+        break;
+    case StepDescription::PADEN_KAHAN_TWO:
+        if (hasShape(step, 2, 2))
+        {
+            return new PadenKahanTwo(ids[0], ids[1], poe.exponentialAtJoint(ids[0]), poe.exponentialAtJoint(ids[1]), points[0], points[1]);
+        }
+        break;
+    case StepDescription::PADEN_KAHAN_THREE:
+        if (hasShape(step, 1, 2))
+        {
+            return new PadenKahanThree(ids[0], poe.exponentialAtJoint(ids[0]), points[0], points[1]);
+        }
+        break;
+    case StepDescription::PARDOS_GOTOR_ONE:
+        if (hasShape(step, 1, 1))
+        {
+            return new PardosGotorOne(ids[0], poe.exponentialAtJoint(ids[0]), points[0]);
+        }
+        break;
+    case StepDescription::PARDOS_GOTOR_TWO:
+        if (hasShape(step, 2, 1))
+        {
+            return new PardosGotorTwo(ids[0], ids[1], poe.exponentialAtJoint(ids[0]), poe.exponentialAtJoint(ids[1]), points[0]);
+        }
+        break;
+    case StepDescription::PARDOS_GOTOR_THREE:
+        if (hasShape(step, 1, 2))
+        {
+            return new PardosGotorThree(ids[0], poe.exponentialAtJoint(ids[0]), points[0], points[1]);
+        }
+        break;
+    case StepDescription::PARDOS_GOTOR_FOUR:
+        if (hasShape(step, 2, 1))
+        {
+            return new PardosGotorFour(ids[0], ids[1], poe.exponentialAtJoint(ids[0]), poe.exponentialAtJoint(ids[1]), points[0]);
+        }
+        break;
     }
 
     return NULL;
@@ -274,14 +469,14 @@ ScrewTheoryIkProblem * ScrewTheoryIkProblemBuilder::build()
 
 // -----------------------------------------------------------------------------
 
-ScrewTheoryIkProblem::Steps ScrewTheoryIkProblemBuilder::searchSolutions()
+std::vector<ScrewTheoryIkProblemBuilder::StepDescription> ScrewTheoryIkProblemBuilder::searchSolutions()
 {
     points = searchPoints(poe);
 
     // Shared collection of characteristic points to work with.
     testPoints.assign(MAX_SIMPLIFICATION_DEPTH, points[0]);
 
-    ScrewTheoryIkProblem::Steps steps;
+    std::vector<StepDescription> steps;
 
     // Vector of iterators (for iterating more than once over the same collection).
     // Size is number of characteristic points being considered at once.
@@ -299,13 +494,13 @@ ScrewTheoryIkProblem::Steps ScrewTheoryIkProblemBuilder::searchSolutions()
         simplify(depth);
 
         // Find a solution if available.
-        ScrewTheoryIkSubproblem * subproblem = trySolve(depth);
+        StepDescription step;
 
-        if (subproblem != NULL)
+        if (trySolve(depth, step))
         {
             // Solution found, reset and start again. We'll iterate over the same points, taking
             // into account that some terms are already known.
-            steps.push_back(subproblem);
+            steps.push_back(step);
             iterators.assign(iterators.size(), points.begin());
             testPoints[0] = points[0];
             depth = 0;
@@ -383,14 +578,14 @@ void ScrewTheoryIkProblemBuilder::refreshSimplificationState()
 
 // -----------------------------------------------------------------------------
 
-ScrewTheoryIkSubproblem * ScrewTheoryIkProblemBuilder::trySolve(int depth)
+bool ScrewTheoryIkProblemBuilder::trySolve(int depth, StepDescription & step)
 {
     int unknownsCount = std::count_if(poeTerms.begin(), poeTerms.end(), unknownNotSimplifiedTerm);
 
     if (unknownsCount == 0 || unknownsCount > 2) // TODO: hardcoded
     {
         // Can't solve yet, too many unknowns or oversimplified.
-        return NULL;
+        return false;
     }
 
     // Find rightmost unknown and not simplified PoE term.
@@ -407,13 +602,15 @@ ScrewTheoryIkSubproblem * ScrewTheoryIkProblemBuilder::trySolve(int depth)
                     && !liesOnAxis(lastExp, testPoints[0]))
             {
                 poeTerms[lastExpId].known = true;
-                return new PadenKahanOne(lastExpId, lastExp, testPoints[0]);
+                step = makeStep(StepDescription::PADEN_KAHAN_ONE, lastExpId, testPoints[0]);
+                return true;
             }
 
             if (lastExp.getMotionType() == MatrixExponential::TRANSLATION)
             {
                 poeTerms[lastExpId].known = true;
-                return new PardosGotorOne(lastExpId, lastExp, testPoints[0]);
+                step = makeStep(StepDescription::PARDOS_GOTOR_ONE, lastExpId, testPoints[0]);
+                return true;
             }
         }
 
@@ -422,7 +619,7 @@ ScrewTheoryIkSubproblem * ScrewTheoryIkProblemBuilder::trySolve(int depth)
             // There can be no other non-simplified terms to the left of our unknown.
             if (std::find_if(poeTerms.begin(), poeTerms.end(), knownNotSimplifiedTerm) != poeTerms.end())
             {
-                return NULL;
+                return false;
             }
 
             if (lastExp.getMotionType() == MatrixExponential::ROTATION
@@ -430,13 +627,15 @@ ScrewTheoryIkSubproblem * ScrewTheoryIkProblemBuilder::trySolve(int depth)
                     && !liesOnAxis(lastExp, testPoints[1]))
             {
                 poeTerms[lastExpId].known = true;
-                return new PadenKahanThree(lastExpId, lastExp, testPoints[0], testPoints[1]);
+                step = makeStep(StepDescription::PADEN_KAHAN_THREE, lastExpId, testPoints[0], testPoints[1]);
+                return true;
             }
 
             if (lastExp.getMotionType() == MatrixExponential::TRANSLATION)
             {
                 poeTerms[lastExpId].known = true;
-                return new PardosGotorThree(lastExpId, lastExp, testPoints[0], testPoints[1]);
+                step = makeStep(StepDescription::PARDOS_GOTOR_THREE, lastExpId, testPoints[0], testPoints[1]);
+                return true;
             }
         }
     }
@@ -448,7 +647,7 @@ ScrewTheoryIkSubproblem * ScrewTheoryIkProblemBuilder::trySolve(int depth)
 
         if (!unknownNotSimplifiedTerm(*nextToLastUnknown))
         {
-            return NULL;
+            return false;
         }
 
         int nextToLastExpId = lastExpId - 1;
@@ -464,7 +663,8 @@ ScrewTheoryIkSubproblem * ScrewTheoryIkProblemBuilder::trySolve(int depth)
                     && intersectingAxes(lastExp, nextToLastExp, r))
             {
                 poeTerms[lastExpId].known = poeTerms[nextToLastExpId].known = true;
-                return new PadenKahanTwo(nextToLastExpId, lastExpId, nextToLastExp, lastExp, testPoints[0], r);
+                step = makeStep(StepDescription::PADEN_KAHAN_TWO, nextToLastExpId, lastExpId, testPoints[0], r);
+                return true;
             }
 
             if (lastExp.getMotionType() == MatrixExponential::TRANSLATION
@@ -472,7 +672,8 @@ ScrewTheoryIkSubproblem * ScrewTheoryIkProblemBuilder::trySolve(int depth)
                     && !parallelAxes(lastExp, nextToLastExp))
             {
                 poeTerms[lastExpId].known = poeTerms[nextToLastExpId].known = true;
-                return new PardosGotorTwo(nextToLastExpId, lastExpId, nextToLastExp, lastExp, testPoints[0]);
+                step = makeStep(StepDescription::PARDOS_GOTOR_TWO, nextToLastExpId, lastExpId, testPoints[0]);
+                return true;
             }
 
             if (lastExp.getMotionType() == MatrixExponential::ROTATION
@@ -481,12 +682,13 @@ ScrewTheoryIkSubproblem * ScrewTheoryIkProblemBuilder::trySolve(int depth)
                     && !colinearAxes(lastExp, nextToLastExp))
             {
                 poeTerms[lastExpId].known = poeTerms[nextToLastExpId].known = true;
-                return new PardosGotorFour(nextToLastExpId, lastExpId, nextToLastExp, lastExp, testPoints[0]);
+                step = makeStep(StepDescription::PARDOS_GOTOR_FOUR, nextToLastExpId, lastExpId, testPoints[0]);
+                return true;
             }
         }
     }
 
-    return NULL;
+    return false;
 }
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,382 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "ScrewTheoryIkProblemCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include <ColorDebug.h>
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    typedef ScrewTheoryIkProblemBuilder::Description Description;
+    typedef ScrewTheoryIkProblemBuilder::StepDescription StepDescription;
+
+    // Bump this whenever the builder or the text format change.
+    const int FORMAT_VERSION = 1;
+
+    const char * const HEADER = "ScrewTheoryIkProblem";
+
+    const char * const SUBPROBLEM_NAMES[] = {
+        "PadenKahanOne",
+        "PadenKahanTwo",
+        "PadenKahanThree",
+        "PardosGotorOne",
+        "PardosGotorTwo",
+        "PardosGotorThree",
+        "PardosGotorFour"
+    };
+
+    const int SUBPROBLEM_COUNT = sizeof(SUBPROBLEM_NAMES) / sizeof(SUBPROBLEM_NAMES[0]);
+
+    // 64-bit FNV-1a
+    class Hasher
+    {
+    public:
+        Hasher() : hash(14695981039346656037ULL)
+        {}
+
+        void add(unsigned long long value)
+        {
+            for (int i = 0; i < 8; i++)
+            {
+                hash ^= (value >> (8 * i)) & 0xFF;
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        void add(double value)
+        {
+            // Treat -0.0 and 0.0 alike.
+            if (value == 0.0)
+            {
+                value = 0.0;
+            }
+
+            unsigned long long bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            add(bits);
+        }
+
+        void add(const KDL::Vector & v)
+        {
+            add(v.x());
+            add(v.y());
+            add(v.z());
+        }
+
+        unsigned long long get() const
+        { return hash; }
+
+    private:
+        unsigned long long hash;
+    };
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryIkProblemCache::ScrewTheoryIkProblemCache(const std::string & _directory)
+    : directory(_directory)
+{}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryIkProblem * ScrewTheoryIkProblemCache::build(const PoeExpression & poe)
+{
+    Description description;
+    return build(poe, description);
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryIkProblem * ScrewTheoryIkProblemCache::build(const PoeExpression & poe, Description & description)
+{
+    std::string key = makeKey(poe);
+    Description entry;
+    bool found = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::map<std::string, Description>::const_iterator it = entries.find(key);
+
+        if (it != entries.end())
+        {
+            entry = it->second;
+            found = true;
+        }
+    }
+
+    if (!found && load(key, entry))
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        entries[key] = entry;
+        found = true;
+    }
+
+    if (found)
+    {
+        ScrewTheoryIkProblem * problem = ScrewTheoryIkProblemBuilder::rebuild(poe, entry);
+
+        if (problem != NULL)
+        {
+            description = entry;
+            return problem;
+        }
+
+        CD_WARNING("Invalid cache entry %s, searching again.\n", key.c_str());
+    }
+
+    // Not cached (or stale), perform a full search.
+    ScrewTheoryIkProblemBuilder builder(poe);
+    ScrewTheoryIkProblem * problem = builder.build(entry);
+
+    if (problem == NULL)
+    {
+        return NULL;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        entries[key] = entry;
+    }
+
+    store(key, entry);
+
+    description = entry;
+    return problem;
+}
+
+// -----------------------------------------------------------------------------
+
+void ScrewTheoryIkProblemCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    entries.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+std::string ScrewTheoryIkProblemCache::makeKey(const PoeExpression & poe)
+{
+    Hasher hasher;
+
+    hasher.add(static_cast<unsigned long long>(FORMAT_VERSION));
+    hasher.add(static_cast<unsigned long long>(poe.size()));
+
+    for (int i = 0; i < poe.size(); i++)
+    {
+        const MatrixExponential & exp = poe.exponentialAtJoint(i);
+
+        hasher.add(static_cast<unsigned long long>(exp.getMotionType()));
+        hasher.add(exp.getAxis());
+        hasher.add(exp.getOrigin());
+    }
+
+    const KDL::Frame & H_S_T = poe.getTransform();
+
+    hasher.add(H_S_T.p);
+
+    for (int i = 0; i < 9; i++)
+    {
+        hasher.add(H_S_T.M.data[i]);
+    }
+
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << hasher.get();
+    return oss.str();
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryIkProblemCache::serialize(const Description & description, std::ostream & os)
+{
+    // Enough digits for a lossless round trip.
+    os << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+
+    os << HEADER << ' ' << FORMAT_VERSION << '\n';
+    os << "reversed " << description.reversed << '\n';
+    os << "steps " << description.steps.size() << '\n';
+
+    for (int i = 0; i < description.steps.size(); i++)
+    {
+        const StepDescription & step = description.steps[i];
+
+        if (step.type < 0 || step.type >= SUBPROBLEM_COUNT)
+        {
+            return false;
+        }
+
+        os << SUBPROBLEM_NAMES[step.type] << ' ' << step.ids.size();
+
+        for (int j = 0; j < step.ids.size(); j++)
+        {
+            os << ' ' << step.ids[j];
+        }
+
+        os << ' ' << step.points.size();
+
+        for (int j = 0; j < step.points.size(); j++)
+        {
+            os << ' ' << step.points[j].x() << ' ' << step.points[j].y() << ' ' << step.points[j].z();
+        }
+
+        os << '\n';
+    }
+
+    return os.good();
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryIkProblemCache::deserialize(std::istream & is, Description & description)
+{
+    std::string header, tag;
+    int version, steps;
+
+    if (!(is >> header >> version) || header != HEADER || version != FORMAT_VERSION)
+    {
+        return false;
+    }
+
+    Description temp;
+
+    if (!(is >> tag >> temp.reversed) || tag != "reversed")
+    {
+        return false;
+    }
+
+    if (!(is >> tag >> steps) || tag != "steps" || steps < 0)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < steps; i++)
+    {
+        StepDescription step;
+        std::string name;
+        int count;
+
+        if (!(is >> name))
+        {
+            return false;
+        }
+
+        int type = 0;
+
+        while (type < SUBPROBLEM_COUNT && name != SUBPROBLEM_NAMES[type])
+        {
+            type++;
+        }
+
+        if (type == SUBPROBLEM_COUNT)
+        {
+            return false;
+        }
+
+        step.type = static_cast<StepDescription::subproblem_type>(type);
+
+        if (!(is >> count) || count < 0 || count > ScrewTheoryIkSubproblem::MAX_JOINTS)
+        {
+            return false;
+        }
+
+        step.ids.resize(count);
+
+        for (int j = 0; j < count; j++)
+        {
+            if (!(is >> step.ids[j]))
+            {
+                return false;
+            }
+        }
+
+        if (!(is >> count) || count < 0 || count > 2)
+        {
+            return false;
+        }
+
+        for (int j = 0; j < count; j++)
+        {
+            double x, y, z;
+
+            if (!(is >> x >> y >> z))
+            {
+                return false;
+            }
+
+            step.points.push_back(KDL::Vector(x, y, z));
+        }
+
+        temp.steps.push_back(step);
+    }
+
+    description = temp;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryIkProblemCache::load(const std::string & key, Description & description) const
+{
+    if (directory.empty())
+    {
+        return false;
+    }
+
+    std::ifstream ifs(makePath(key).c_str());
+    return ifs.is_open() && deserialize(ifs, description);
+}
+
+// -----------------------------------------------------------------------------
+
+void ScrewTheoryIkProblemCache::store(const std::string & key, const Description & description) const
+{
+    if (directory.empty())
+    {
+        return;
+    }
+
+    std::string path = makePath(key);
+
+    // Write to a temporary file first so that readers never see partial contents.
+    std::string tempPath = path + ".tmp";
+
+    {
+        std::ofstream ofs(tempPath.c_str());
+
+        if (!ofs.is_open() || !serialize(description, ofs))
+        {
+            CD_WARNING("Unable to write cache file %s.\n", tempPath.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0)
+    {
+        CD_WARNING("Unable to rename cache file %s.\n", tempPath.c_str());
+        std::remove(tempPath.c_str());
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+std::string ScrewTheoryIkProblemCache::makePath(const std::string & key) const
+{
+    if (directory[directory.size() - 1] == '/')
+    {
+        return directory + key + ".txt";
+    }
+
+    return directory + "/" + key + ".txt";
+}
+
+// -----------------------------------------------------------------------------
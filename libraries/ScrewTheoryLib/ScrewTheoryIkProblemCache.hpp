@@ -0,0 +1,105 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __SCREW_THEORY_IK_PROBLEM_CACHE_HPP__
+#define __SCREW_THEORY_IK_PROBLEM_CACHE_HPP__
+
+#include <iosfwd>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "ProductOfExponentials.hpp"
+#include "ScrewTheoryIkProblem.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Persistent cache of @ref ScrewTheoryIkProblemBuilder results
+ *
+ * Looking for a valid sequence of subproblems is expensive. This class stores the
+ * outcome of said search, keyed by a hash of the POE geometry, both in memory and
+ * (optionally) in a directory on disk, one text file per POE. Subsequent builds of
+ * the same POE, even across processes, replay the stored description instead.
+ * Instances are thread-safe.
+ */
+class ScrewTheoryIkProblemCache
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param directory Path to an existing directory, leave empty for an
+     * in-memory cache only.
+     */
+    explicit ScrewTheoryIkProblemCache(const std::string & directory = "");
+
+    /**
+     * @brief Looks up or finds a valid IK problem for the given POE
+     *
+     * @param poe Product of exponentials (POE) formula.
+     *
+     * @return An instance of an IK problem solver if valid, NULL otherwise.
+     */
+    ScrewTheoryIkProblem * build(const PoeExpression & poe);
+
+    /**
+     * @brief Looks up or finds a valid IK problem for the given POE
+     *
+     * @param poe Product of exponentials (POE) formula.
+     * @param description Output description of the IK problem, untouched if not found.
+     *
+     * @return An instance of an IK problem solver if valid, NULL otherwise.
+     */
+    ScrewTheoryIkProblem * build(const PoeExpression & poe, ScrewTheoryIkProblemBuilder::Description & description);
+
+    //! Removes all in-memory entries, files on disk are preserved
+    void clear();
+
+    /**
+     * @brief Computes the cache key of a POE
+     *
+     * @param poe Product of exponentials (POE) formula.
+     *
+     * @return Hexadecimal hash of the POE geometry.
+     */
+    static std::string makeKey(const PoeExpression & poe);
+
+    /**
+     * @brief Writes a description in text form
+     *
+     * @param description Description of the IK problem.
+     * @param os Output stream.
+     *
+     * @return True on success, false otherwise.
+     */
+    static bool serialize(const ScrewTheoryIkProblemBuilder::Description & description, std::ostream & os);
+
+    /**
+     * @brief Reads a description in text form
+     *
+     * @param is Input stream.
+     * @param description Output description of the IK problem.
+     *
+     * @return True on success, false if malformed.
+     */
+    static bool deserialize(std::istream & is, ScrewTheoryIkProblemBuilder::Description & description);
+
+private:
+
+    bool load(const std::string & key, ScrewTheoryIkProblemBuilder::Description & description) const;
+    void store(const std::string & key, const ScrewTheoryIkProblemBuilder::Description & description) const;
+
+    std::string makePath(const std::string & key) const;
+
+    std::string directory;
+    std::map<std::string, ScrewTheoryIkProblemBuilder::Description> entries;
+    mutable std::mutex mtx;
+};
+
+}  // namespace roboticslab
+
+#endif  // __SCREW_THEORY_IK_PROBLEM_CACHE_HPP__
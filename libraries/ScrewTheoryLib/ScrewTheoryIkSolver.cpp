@@ -0,0 +1,73 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "ScrewTheoryIkSolver.hpp"
+
+#include <sstream>
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    const char * getSubproblemName(const ScrewTheoryIkSubproblem * subproblem)
+    {
+        if (dynamic_cast<const PadenKahanOne *>(subproblem) != NULL)
+        {
+            return "PadenKahanOne";
+        }
+        else if (dynamic_cast<const PadenKahanTwo *>(subproblem) != NULL)
+        {
+            return "PadenKahanTwo";
+        }
+        else if (dynamic_cast<const PadenKahanThree *>(subproblem) != NULL)
+        {
+            return "PadenKahanThree";
+        }
+        else if (dynamic_cast<const PardosGotorOne *>(subproblem) != NULL)
+        {
+            return "PardosGotorOne";
+        }
+        else if (dynamic_cast<const PardosGotorTwo *>(subproblem) != NULL)
+        {
+            return "PardosGotorTwo";
+        }
+        else if (dynamic_cast<const PardosGotorThree *>(subproblem) != NULL)
+        {
+            return "PardosGotorThree";
+        }
+        else if (dynamic_cast<const PardosGotorFour *>(subproblem) != NULL)
+        {
+            return "PardosGotorFour";
+        }
+        else
+        {
+            return NULL;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+std::string roboticslab::describeIkSolverType(const ScrewTheoryIkProblem & problem)
+{
+    std::ostringstream oss;
+    oss << "ScrewTheoryIkSolver<" << problem.getPoe().size();
+
+    for (int i = 0; i < problem.getSteps().size(); i++)
+    {
+        const char * name = getSubproblemName(problem.getSteps()[i]);
+
+        if (name == NULL)
+        {
+            return "";
+        }
+
+        oss << ", " << name;
+    }
+
+    oss << ">";
+    return oss.str();
+}
+
+// -----------------------------------------------------------------------------
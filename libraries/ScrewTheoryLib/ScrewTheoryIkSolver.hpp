@@ -0,0 +1,404 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __SCREW_THEORY_IK_SOLVER_HPP__
+#define __SCREW_THEORY_IK_SOLVER_HPP__
+
+#include <array>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include <kdl/frames.hpp>
+
+#include "ProductOfExponentials.hpp"
+#include "ScrewTheoryIkProblem.hpp"
+#include "ScrewTheoryIkSubproblems.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Spells out the @ref ScrewTheoryIkSolver type that matches an IK problem
+ *
+ * Meant to be called once offline in order to paste the result in client code,
+ * e.g. <tt>ScrewTheoryIkSolver<6, PadenKahanThree, PadenKahanTwo, PadenKahanOne, PadenKahanTwo></tt>.
+ *
+ * @param problem A built IK problem.
+ *
+ * @return Type name, empty if any step is not a known subproblem.
+ */
+std::string describeIkSolverType(const ScrewTheoryIkProblem & problem);
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Product of the number of local solutions of a sequence of subproblems
+ */
+template <typename... Steps>
+struct IkStepSolutions;
+
+template <>
+struct IkStepSolutions<>
+{
+    static const int value = 1;
+};
+
+template <typename Step, typename... Rest>
+struct IkStepSolutions<Step, Rest...>
+{
+    static const int value = Step::SOLUTIONS * IkStepSolutions<Rest...>::value;
+};
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief IK solver specialized at compile time for a fixed robot geometry
+ *
+ * Counterpart of @ref ScrewTheoryIkProblem for a known number of joints and a known
+ * sequence of subproblem types, see @ref describeIkSolverType. Subproblems are
+ * invoked without virtual dispatch, all storage has fixed size and lives on the
+ * stack, and the order in which POE terms are evaluated at each step is computed
+ * once upon construction. Results are identical to those of the source problem.
+ *
+ * @tparam DOF Number of joints.
+ * @tparam Steps Types of the subproblems, in the same order as the source problem.
+ */
+template <int DOF, typename... Steps>
+class ScrewTheoryIkSolver
+{
+public:
+
+    //! Number of steps (subproblems)
+    static const int STEPS = sizeof...(Steps);
+
+    //! Number of global IK solutions
+    static const int SOLUTIONS = IkStepSolutions<Steps...>::value;
+
+    //! Joint values of a single solution
+    typedef std::array<double, DOF> JointValues;
+
+    //! Collection of global IK solutions
+    typedef std::array<JointValues, SOLUTIONS> Solutions;
+
+    /**
+     * @brief Constructor
+     *
+     * @param problem A built IK problem, must outlive this instance since its
+     * subproblems are referenced (not copied).
+     */
+    explicit ScrewTheoryIkSolver(const ScrewTheoryIkProblem & problem);
+
+    //! Whether the source problem matches the template arguments
+    bool isValid() const
+    { return valid; }
+
+    /**
+     * @brief Find all available solutions
+     *
+     * @param H_S_T Target pose in cartesian space.
+     * @param solutions Output array of solutions.
+     *
+     * @return True if all solutions are reachable, false otherwise (or if not valid).
+     */
+    bool solve(const KDL::Frame & H_S_T, Solutions & solutions) const;
+
+private:
+
+    typedef std::array<KDL::Frame, SOLUTIONS> Frames;
+
+    // POE term ids to be multiplied, in order.
+    struct Terms
+    {
+        Terms() : count(0)
+        {}
+
+        void push(int id)
+        { ids[count++] = id; }
+
+        std::array<int, DOF> ids;
+        int count;
+    };
+
+    struct Plan
+    {
+        Terms left;       // leftmost known terms, moved to the right-hand side
+        Terms right;      // rightmost known terms, moved to the right-hand side
+        Terms pointFirst; // terms applied to the characteristic point, first partial solution
+        Terms pointRest;  // terms applied to the characteristic point, remaining partial solutions
+    };
+
+    template <int I>
+    bool bindSteps(const ScrewTheoryIkProblem::Steps & problemSteps, std::true_type);
+
+    template <int I>
+    bool bindSteps(const ScrewTheoryIkProblem::Steps &, std::false_type)
+    { return true; }
+
+    void makePlans(const ScrewTheoryIkProblem::Steps & problemSteps);
+
+    template <int I, int SIZE>
+    bool solveSteps(JointValues * solutions, Frames & rhsFrames, std::true_type) const;
+
+    template <int I, int SIZE>
+    bool solveSteps(JointValues *, Frames &, std::false_type) const
+    { return true; }
+
+    double getTheta(const JointValues & q, int id) const
+    { return reversed ? -q[DOF - 1 - id] : q[id]; }
+
+    KDL::Frame multiply(const JointValues & q, const Terms & terms) const;
+
+    const PoeExpression poe;
+    const KDL::Frame H_S_T_0_inv;
+    const bool reversed;
+
+    std::tuple<const Steps *...> steps;
+    std::array<Plan, STEPS> plans;
+    bool valid;
+};
+
+// -----------------------------------------------------------------------------
+
+template <int DOF, typename... Steps>
+const int ScrewTheoryIkSolver<DOF, Steps...>::STEPS;
+
+template <int DOF, typename... Steps>
+const int ScrewTheoryIkSolver<DOF, Steps...>::SOLUTIONS;
+
+// -----------------------------------------------------------------------------
+
+template <int DOF, typename... Steps>
+ScrewTheoryIkSolver<DOF, Steps...>::ScrewTheoryIkSolver(const ScrewTheoryIkProblem & problem)
+    : poe(problem.getPoe()),
+      H_S_T_0_inv(problem.getPoe().getTransform().Inverse()),
+      reversed(problem.isReversed()),
+      valid(false)
+{
+    if (poe.size() != DOF || problem.getSteps().size() != STEPS || problem.solutions() != SOLUTIONS)
+    {
+        return;
+    }
+
+    if (bindSteps<0>(problem.getSteps(), std::integral_constant<bool, (0 < STEPS)>()))
+    {
+        makePlans(problem.getSteps());
+        valid = true;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+template <int DOF, typename... Steps>
+template <int I>
+bool ScrewTheoryIkSolver<DOF, Steps...>::bindSteps(const ScrewTheoryIkProblem::Steps & problemSteps, std::true_type)
+{
+    typedef typename std::tuple_element<I, std::tuple<Steps...> >::type Step;
+
+    const Step * step = dynamic_cast<const Step *>(problemSteps[I]);
+
+    if (step == NULL)
+    {
+        return false;
+    }
+
+    std::get<I>(steps) = step;
+    return bindSteps<I + 1>(problemSteps, std::integral_constant<bool, (I + 1 < STEPS)>());
+}
+
+// -----------------------------------------------------------------------------
+
+template <int DOF, typename... Steps>
+void ScrewTheoryIkSolver<DOF, Steps...>::makePlans(const ScrewTheoryIkProblem::Steps & problemSteps)
+{
+    // Replays the bookkeeping of ScrewTheoryIkProblem::solve(), which only depends
+    // on the joint ids solved at each step, never on the target pose.
+
+    enum { KNOWN, COMPUTED, UNKNOWN };
+
+    std::array<int, DOF> terms;
+    terms.fill(UNKNOWN);
+
+    for (int i = 0; i < STEPS; i++)
+    {
+        Plan & plan = plans[i];
+
+        if (i != 0)
+        {
+            // Leftmost known terms of the PoE.
+            for (int id = 0; id < DOF && terms[id] != UNKNOWN; id++)
+            {
+                if (terms[id] == KNOWN)
+                {
+                    plan.left.push(id);
+                    terms[id] = COMPUTED;
+                }
+            }
+
+            // Rightmost known terms of the PoE, only the last one is ever visited.
+            if (terms[DOF - 1] == KNOWN)
+            {
+                plan.right.push(DOF - 1);
+                terms[DOF - 1] = COMPUTED;
+            }
+        }
+
+        // Joint ids are reported along with the solutions, probe them.
+        ScrewTheoryIkSubproblem::Solutions probe;
+        problemSteps[i]->solve(KDL::Frame::Identity(), KDL::Frame::Identity(), probe);
+
+        for (int pass = 0; pass < 2; pass++)
+        {
+            Terms & point = pass == 0 ? plan.pointFirst : plan.pointRest;
+
+            bool foundKnown = false;
+            bool foundUnknown = false;
+
+            for (int id = DOF - 1; id >= 0; id--)
+            {
+                if (terms[id] == KNOWN)
+                {
+                    point.push(id);
+                    foundKnown = true;
+                }
+                else if (terms[id] == UNKNOWN)
+                {
+                    foundUnknown = true;
+
+                    if (foundKnown)
+                    {
+                        break;
+                    }
+                }
+                else if (foundKnown || foundUnknown)
+                {
+                    break;
+                }
+            }
+
+            // The remaining partial solutions already see the terms solved by this step.
+            for (int l = 0; l < probe[0].size(); l++)
+            {
+                terms[probe[0][l].first] = KNOWN;
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+template <int DOF, typename... Steps>
+bool ScrewTheoryIkSolver<DOF, Steps...>::solve(const KDL::Frame & H_S_T, Solutions & solutions) const
+{
+    if (!valid)
+    {
+        return false;
+    }
+
+    Frames rhsFrames;
+
+    solutions[0].fill(0.0);
+    rhsFrames[0] = (reversed ? H_S_T.Inverse() : H_S_T) * H_S_T_0_inv;
+
+    return solveSteps<0, 1>(solutions.data(), rhsFrames, std::integral_constant<bool, (0 < STEPS)>());
+}
+
+// -----------------------------------------------------------------------------
+
+template <int DOF, typename... Steps>
+template <int I, int SIZE>
+bool ScrewTheoryIkSolver<DOF, Steps...>::solveSteps(JointValues * solutions, Frames & rhsFrames, std::true_type) const
+{
+    typedef typename std::tuple_element<I, std::tuple<Steps...> >::type Step;
+
+    const Step * step = std::get<I>(steps);
+    const Plan & plan = plans[I];
+
+    if (plan.left.count != 0)
+    {
+        for (int j = 0; j < SIZE; j++)
+        {
+            rhsFrames[j] = multiply(solutions[j], plan.left).Inverse() * rhsFrames[j];
+        }
+    }
+
+    if (plan.right.count != 0)
+    {
+        for (int j = 0; j < SIZE; j++)
+        {
+            rhsFrames[j] = rhsFrames[j] * multiply(solutions[j], plan.right).Inverse();
+        }
+    }
+
+    bool reachable = true;
+
+    for (int j = 0; j < SIZE; j++)
+    {
+        const Terms & pointTerms = j == 0 ? plan.pointFirst : plan.pointRest;
+        KDL::Frame H;
+
+        for (int t = 0; t < pointTerms.count; t++)
+        {
+            int id = pointTerms.ids[t];
+            H = poe.exponentialAtJoint(id).asFrame(getTheta(solutions[j], id)) * H;
+        }
+
+        ScrewTheoryIkSubproblem::Solutions partialSolutions;
+
+        // Qualified call, no virtual dispatch.
+        reachable = reachable & step->Step::solve(rhsFrames[j], H, partialSolutions);
+
+        for (int k = 1; k < Step::SOLUTIONS; k++)
+        {
+            solutions[j + SIZE * k] = solutions[j];
+            rhsFrames[j + SIZE * k] = rhsFrames[j];
+        }
+
+        for (int k = 0; k < Step::SOLUTIONS; k++)
+        {
+            const ScrewTheoryIkSubproblem::JointIdsToSolutions & jointIdsToSolutions = partialSolutions[k];
+
+            for (int l = 0; l < jointIdsToSolutions.size(); l++)
+            {
+                int id = jointIdsToSolutions[l].first;
+                double theta = jointIdsToSolutions[l].second;
+
+                if (reversed)
+                {
+                    id = DOF - 1 - id;
+                    theta = -theta;
+                }
+
+                solutions[j + SIZE * k][id] = theta;
+            }
+        }
+    }
+
+    const int NEXT = SIZE * Step::SOLUTIONS;
+    bool next = solveSteps<I + 1, NEXT>(solutions, rhsFrames, std::integral_constant<bool, (I + 1 < STEPS)>());
+
+    return reachable && next;
+}
+
+// -----------------------------------------------------------------------------
+
+template <int DOF, typename... Steps>
+KDL::Frame ScrewTheoryIkSolver<DOF, Steps...>::multiply(const JointValues & q, const Terms & terms) const
+{
+    KDL::Frame H = KDL::Frame::Identity();
+
+    for (int t = 0; t < terms.count; t++)
+    {
+        int id = terms.ids[t];
+        H = H * poe.exponentialAtJoint(id).asFrame(getTheta(q, id));
+    }
+
+    return H;
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace roboticslab
+
+#endif  // __SCREW_THEORY_IK_SOLVER_HPP__
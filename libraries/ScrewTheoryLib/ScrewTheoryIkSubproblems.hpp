@@ -7,6 +7,7 @@
 
 #include "ScrewTheoryIkProblem.hpp"
 #include "MatrixExponential.hpp"
+#include "SubproblemKernels.hpp"
 
 namespace roboticslab
 {
@@ -35,8 +36,14 @@ public:
 
     virtual bool solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const;
 
+    virtual int solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count,
+            Solutions * solutions, bool * reachable) const;
+
     virtual int solutions() const
-    { return 1; }
+    { return SOLUTIONS; }
+
+    //! Number of local IK solutions, known at compile time
+    static const int SOLUTIONS = 1;
 
 private:
 
@@ -73,8 +80,14 @@ public:
 
     virtual bool solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const;
 
+    virtual int solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count,
+            Solutions * solutions, bool * reachable) const;
+
     virtual int solutions() const
-    { return 2; }
+    { return SOLUTIONS; }
+
+    //! Number of local IK solutions, known at compile time
+    static const int SOLUTIONS = 2;
 
 private:
 
@@ -110,8 +123,14 @@ public:
 
     virtual bool solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const;
 
+    virtual int solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count,
+            Solutions * solutions, bool * reachable) const;
+
     virtual int solutions() const
-    { return 2; }
+    { return SOLUTIONS; }
+
+    //! Number of local IK solutions, known at compile time
+    static const int SOLUTIONS = 2;
 
 private:
 
@@ -145,8 +164,14 @@ public:
 
     virtual bool solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const;
 
+    virtual int solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count,
+            Solutions * solutions, bool * reachable) const;
+
     virtual int solutions() const
-    { return 1; }
+    { return SOLUTIONS; }
+
+    //! Number of local IK solutions, known at compile time
+    static const int SOLUTIONS = 1;
 
 private:
 
@@ -181,8 +206,14 @@ public:
 
     virtual bool solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const;
 
+    virtual int solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count,
+            Solutions * solutions, bool * reachable) const;
+
     virtual int solutions() const
-    { return 1; }
+    { return SOLUTIONS; }
+
+    //! Number of local IK solutions, known at compile time
+    static const int SOLUTIONS = 1;
 
 private:
 
@@ -218,8 +249,14 @@ public:
 
     virtual bool solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const;
 
+    virtual int solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count,
+            Solutions * solutions, bool * reachable) const;
+
     virtual int solutions() const
-    { return 2; }
+    { return SOLUTIONS; }
+
+    //! Number of local IK solutions, known at compile time
+    static const int SOLUTIONS = 2;
 
 private:
 
@@ -255,8 +292,14 @@ public:
 
     virtual bool solve(const KDL::Frame & rhs, const KDL::Frame & pointTransform, Solutions & solutions) const;
 
+    virtual int solveBatch(const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count,
+            Solutions * solutions, bool * reachable) const;
+
     virtual int solutions() const
-    { return 2; }
+    { return SOLUTIONS; }
+
+    //! Number of local IK solutions, known at compile time
+    static const int SOLUTIONS = 2;
 
 private:
 
@@ -266,6 +309,48 @@ private:
     const KDL::Rotation axisPow;
 };
 
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Copies a vector into a plain array, see @ref SubproblemParams
+ *
+ * @param v Input vector.
+ * @param out Output array of three elements.
+ */
+inline void toArray(const KDL::Vector & v, double * out)
+{
+    out[0] = v.x();
+    out[1] = v.y();
+    out[2] = v.z();
+}
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Drives a subproblem kernel over a batch of inputs
+ *
+ * Inputs are transposed into structure-of-arrays form in small blocks, padded to
+ * the lane width of the kernel, and results are scattered back.
+ *
+ * @param kernel Kernel that solves the subproblem.
+ * @param lanes Lane width of @p kernel.
+ * @param params Geometric invariants of the subproblem.
+ * @param p Characteristic point.
+ * @param ids Zero-based joint ids, one per solved joint.
+ * @param solutions Number of local solutions.
+ * @param joints Number of solved joints.
+ * @param rhs See @ref ScrewTheoryIkSubproblem::solveBatch.
+ * @param pointTransforms See @ref ScrewTheoryIkSubproblem::solveBatch.
+ * @param count See @ref ScrewTheoryIkSubproblem::solveBatch.
+ * @param out See @ref ScrewTheoryIkSubproblem::solveBatch.
+ * @param reachable See @ref ScrewTheoryIkSubproblem::solveBatch.
+ *
+ * @return Number of inputs whose solutions are reachable.
+ */
+int solveSubproblemBatch(SubproblemKernel kernel, int lanes, const SubproblemParams & params, const KDL::Vector & p,
+        const int * ids, int solutions, int joints, const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count,
+        ScrewTheoryIkSubproblem::Solutions * out, bool * reachable);
+
 }  // namespace roboticslab
 
 #endif  // __SCREW_THEORY_IK_SUBPROBLEMS_HPP__
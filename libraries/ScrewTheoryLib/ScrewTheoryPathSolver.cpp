@@ -0,0 +1,204 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "ScrewTheoryPathSolver.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include <kdl/utilities/utility.h>
+
+#include <ColorDebug.h>
+
+#include "ThreadPool.hpp"
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    const int NO_PREDECESSOR = -1;
+
+    // Same metric as in ConfigurationSelectorLeastOverallAngularDisplacement.
+    inline double getDisplacement(const KDL::JntArray & q1, const KDL::JntArray & q2)
+    {
+        double sum = 0.0;
+
+        for (int i = 0; i < q1.rows(); i++)
+        {
+            sum += std::abs(q1(i) - q2(i));
+        }
+
+        return sum;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryPathSolver::ScrewTheoryPathSolver(const ScrewTheoryIkProblem & _problem, const KDL::JntArray & _qMin,
+        const KDL::JntArray & _qMax)
+    : problem(_problem),
+      poe(_problem.isReversed() ? _problem.getPoe().makeReverse() : _problem.getPoe()),
+      qMin(_qMin),
+      qMax(_qMax)
+{}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryPathSolver::solve(const std::vector<KDL::Frame> & waypoints, const KDL::JntArray & qInit,
+        std::vector<KDL::JntArray> & path, ThreadPool * pool, double * cost) const
+{
+    const int count = waypoints.size();
+    const int soln = problem.solutions();
+    const int size = poe.size();
+
+    if (qInit.rows() != 0 && qInit.rows() != size)
+    {
+        CD_WARNING("Size mismatch: %d (initial joint array) != %d (terms of PoE).\n", qInit.rows(), size);
+        return false;
+    }
+
+    // Nodes of the trellis, the k-th solution for the i-th waypoint is stored at i * soln + k.
+    std::vector<KDL::JntArray> nodes(count * soln, KDL::JntArray(size));
+    std::vector<char> valid(count * soln, false);
+
+    ThreadPool::Task task = [&](int start, int end)
+    {
+        ScrewTheoryIkProblem::Workspace workspace(problem);
+        ScrewTheoryIkProblem::Solutions solutions;
+
+        for (int i = start; i < end; i++)
+        {
+            bool reachable = problem.solve(waypoints[i], solutions, qMin, qMax, workspace);
+
+            for (int k = 0; k < soln; k++)
+            {
+                nodes[i * soln + k] = solutions[k];
+                valid[i * soln + k] = isValid(solutions[k], waypoints[i], reachable);
+            }
+        }
+    };
+
+    if (pool != NULL)
+    {
+        pool->parallelFor(count, task);
+    }
+    else
+    {
+        task(0, count);
+    }
+
+    // Accumulated cost of the best path that ends at each node, and its predecessor.
+    std::vector<double> costs(count * soln, std::numeric_limits<double>::infinity());
+    std::vector<int> predecessors(count * soln, NO_PREDECESSOR);
+
+    for (int i = 0; i < count; i++)
+    {
+        bool anyValid = false;
+
+        for (int k = 0; k < soln; k++)
+        {
+            const int current = i * soln + k;
+
+            if (!valid[current])
+            {
+                continue;
+            }
+
+            if (i == 0)
+            {
+                costs[current] = qInit.rows() != 0 ? getDisplacement(qInit, nodes[current]) : 0.0;
+                anyValid = true;
+                continue;
+            }
+
+            for (int j = 0; j < soln; j++)
+            {
+                const int previous = (i - 1) * soln + j;
+
+                if (!valid[previous] || costs[previous] == std::numeric_limits<double>::infinity())
+                {
+                    continue;
+                }
+
+                double candidate = costs[previous] + getDisplacement(nodes[previous], nodes[current]);
+
+                if (candidate < costs[current])
+                {
+                    costs[current] = candidate;
+                    predecessors[current] = previous;
+                }
+            }
+
+            anyValid = anyValid || predecessors[current] != NO_PREDECESSOR;
+        }
+
+        if (!anyValid)
+        {
+            CD_WARNING("No valid IK solution found for waypoint %d.\n", i);
+            return false;
+        }
+    }
+
+    path.resize(count);
+
+    if (count == 0)
+    {
+        if (cost != NULL)
+        {
+            *cost = 0.0;
+        }
+
+        return true;
+    }
+
+    int best = (count - 1) * soln;
+
+    for (int k = 1; k < soln; k++)
+    {
+        if (costs[(count - 1) * soln + k] < costs[best])
+        {
+            best = (count - 1) * soln + k;
+        }
+    }
+
+    if (cost != NULL)
+    {
+        *cost = costs[best];
+    }
+
+    // Backtrack from the cheapest node of the last waypoint.
+    for (int i = count - 1, current = best; i >= 0; i--, current = predecessors[current])
+    {
+        path[i] = nodes[current];
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryPathSolver::isValid(const KDL::JntArray & q, const KDL::Frame & H_S_T, bool reachable) const
+{
+    if (qMin.rows() == q.rows() && qMax.rows() == q.rows())
+    {
+        for (int i = 0; i < q.rows(); i++)
+        {
+            if (q(i) < qMin(i) - KDL::epsilon || q(i) > qMax(i) + KDL::epsilon)
+            {
+                return false;
+            }
+        }
+    }
+
+    if (reachable)
+    {
+        return true;
+    }
+
+    // Not known which ones failed, hence check this one.
+    KDL::Frame H;
+    return poe.evaluate(q, H) && KDL::Equal(H, H_S_T);
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,71 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __SCREW_THEORY_PATH_SOLVER_HPP__
+#define __SCREW_THEORY_PATH_SOLVER_HPP__
+
+#include <vector>
+
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+
+#include "ScrewTheoryIkProblem.hpp"
+
+namespace roboticslab
+{
+
+class ThreadPool;
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Offline IK for a sampled cartesian path with globally consistent branch selection
+ *
+ * All IK solutions are computed for each waypoint (in parallel, if a thread pool is
+ * given), then a dynamic programming pass (Viterbi algorithm) looks for the sequence
+ * of solutions that minimizes the overall joint displacement along the whole path,
+ * i.e. the sum of absolute differences between consecutive joint arrays. As opposed
+ * to a greedy choice at each waypoint, unnecessary branch flips are avoided.
+ *
+ * Solutions out of joint limits or not reachable are discarded.
+ */
+class ScrewTheoryPathSolver
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param problem IK problem, must outlive this instance.
+     * @param qMin Joint array of minimum joint limits.
+     * @param qMax Joint array of maximum joint limits.
+     */
+    ScrewTheoryPathSolver(const ScrewTheoryIkProblem & problem, const KDL::JntArray & qMin, const KDL::JntArray & qMax);
+
+    /**
+     * @brief Find the joint-space path of least overall displacement
+     *
+     * @param waypoints Sequence of target poses in cartesian space.
+     * @param qInit Joint array of values for current robot position, the displacement
+     * towards the first waypoint is accounted for. Ignored if empty.
+     * @param path Output sequence of joint arrays, one per waypoint.
+     * @param pool Optional thread pool waypoints are split across, all of them are
+     * solved in the calling thread if NULL.
+     * @param cost Optional output overall joint displacement of the path.
+     *
+     * @return True on success, false if any waypoint has no valid solution.
+     */
+    bool solve(const std::vector<KDL::Frame> & waypoints, const KDL::JntArray & qInit, std::vector<KDL::JntArray> & path,
+               ThreadPool * pool = NULL, double * cost = NULL) const;
+
+private:
+
+    bool isValid(const KDL::JntArray & q, const KDL::Frame & H_S_T, bool reachable) const;
+
+    const ScrewTheoryIkProblem & problem;
+    const PoeExpression poe;
+    const KDL::JntArray qMin, qMax;
+};
+
+}  // namespace roboticslab
+
+#endif  // __SCREW_THEORY_PATH_SOLVER_HPP__
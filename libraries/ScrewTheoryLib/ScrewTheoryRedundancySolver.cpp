@@ -0,0 +1,249 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "ScrewTheoryRedundancySolver.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include <kdl/utilities/utility.h>
+
+#include <ColorDebug.h>
+
+#include "ScrewTheoryIkProblemCache.hpp"
+#include "ThreadPool.hpp"
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    ScrewTheoryIkProblem * buildProblem(const PoeExpression & poe, ScrewTheoryIkProblemCache * cache)
+    {
+        if (cache != NULL)
+        {
+            return cache->build(poe);
+        }
+
+        ScrewTheoryIkProblemBuilder builder(poe);
+        return builder.build();
+    }
+
+    // Fold the redundant joint at the given value into the POE, i.e. e1...eN*H = e1...(g*e(r+1)*g^-1)...(g*H).
+    PoeExpression makeReducedPoe(const PoeExpression & poe, int redundantJoint, double theta)
+    {
+        KDL::Frame g = poe.exponentialAtJoint(redundantJoint).asFrame(theta);
+        PoeExpression reducedPoe(g * poe.getTransform());
+
+        for (int i = 0; i < poe.size(); i++)
+        {
+            if (i < redundantJoint)
+            {
+                reducedPoe.append(poe.exponentialAtJoint(i));
+            }
+            else if (i > redundantJoint)
+            {
+                reducedPoe.append(poe.exponentialAtJoint(i), g);
+            }
+        }
+
+        return reducedPoe;
+    }
+
+    // Rejected by ConfigurationSelector::configure since comparisons against NaN are always false.
+    void invalidate(KDL::JntArray & q)
+    {
+        for (int i = 0; i < q.rows(); i++)
+        {
+            q(i) = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryRedundancySolver::ScrewTheoryRedundancySolver(const PoeExpression & _poe, int _redundantJoint,
+        const std::vector<Sample> & _samples)
+    : poe(_poe),
+      redundantJoint(_redundantJoint),
+      samples(_samples),
+      stride(0)
+{
+    for (int i = 0; i < samples.size(); i++)
+    {
+        stride = std::max(stride, samples[i].problem->solutions());
+    }
+
+    candidates.resize(samples.size() * stride, KDL::JntArray(poe.size()));
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryRedundancySolver::~ScrewTheoryRedundancySolver()
+{
+    for (int i = 0; i < samples.size(); i++)
+    {
+        delete samples[i].workspace;
+        delete samples[i].problem;
+    }
+
+    samples.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryRedundancySolver::solve(const KDL::Frame & H_S_T, ConfigurationSelector & selector,
+        const KDL::JntArray & qGuess, KDL::JntArray & q, ThreadPool * pool)
+{
+    const KDL::JntArray & qMin = selector.getMinLimits();
+    const KDL::JntArray & qMax = selector.getMaxLimits();
+
+    const bool limits = qMin.rows() == poe.size() && qMax.rows() == poe.size();
+
+    if (limits)
+    {
+        // Sized once, noop on subsequent calls.
+        reducedMin.resize(poe.size() - 1);
+        reducedMax.resize(poe.size() - 1);
+
+        for (int i = 0, j = 0; i < poe.size(); i++)
+        {
+            if (i != redundantJoint)
+            {
+                reducedMin(j) = qMin(i);
+                reducedMax(j) = qMax(i);
+                j++;
+            }
+        }
+    }
+
+    ThreadPool::Task task = [&](int start, int end)
+    {
+        for (int i = start; i < end; i++)
+        {
+            solveSample(i, H_S_T, limits);
+        }
+    };
+
+    if (pool != NULL)
+    {
+        pool->parallelFor(samples.size(), task);
+    }
+    else
+    {
+        task(0, samples.size());
+    }
+
+    if (!selector.configure(candidates))
+    {
+        return false;
+    }
+
+    if (!selector.findOptimalConfiguration(qGuess))
+    {
+        return false;
+    }
+
+    selector.retrievePose(q);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void ScrewTheoryRedundancySolver::solveSample(int i, const KDL::Frame & H_S_T, bool limits)
+{
+    Sample & sample = samples[i];
+    KDL::JntArray * out = &candidates[i * stride];
+
+    bool reachable;
+
+    if (limits)
+    {
+        reachable = sample.problem->solve(H_S_T, sample.solutions, reducedMin, reducedMax, *sample.workspace);
+    }
+    else
+    {
+        reachable = sample.problem->solve(H_S_T, sample.solutions, *sample.workspace);
+    }
+
+    for (int k = 0; k < stride; k++)
+    {
+        if (k >= sample.solutions.size())
+        {
+            invalidate(out[k]);
+            continue;
+        }
+
+        expandSolution(sample.solutions[k], redundantJoint, sample.theta, out[k]);
+
+        if (!reachable)
+        {
+            // Not known which ones failed, hence check each one of them.
+            KDL::Frame H;
+
+            if (!poe.evaluate(out[k], H) || !KDL::Equal(H, H_S_T))
+            {
+                invalidate(out[k]);
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void ScrewTheoryRedundancySolver::expandSolution(const KDL::JntArray & reduced, int redundantJoint, double theta,
+        KDL::JntArray & q)
+{
+    for (int i = 0, j = 0; i < q.rows(); i++)
+    {
+        q(i) = (i == redundantJoint) ? theta : reduced(j++);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryRedundancySolver * ScrewTheoryRedundancySolver::create(const PoeExpression & poe, int redundantJoint,
+        double qMin, double qMax, int samples, ScrewTheoryIkProblemCache * cache)
+{
+    if (redundantJoint < 0 || redundantJoint >= poe.size())
+    {
+        CD_WARNING("Invalid redundant joint: %d (PoE has %d terms).\n", redundantJoint, poe.size());
+        return NULL;
+    }
+
+    if (samples < 1 || qMin > qMax)
+    {
+        CD_WARNING("Invalid sampling: %d samples in [%f, %f].\n", samples, qMin, qMax);
+        return NULL;
+    }
+
+    std::vector<Sample> validSamples;
+
+    for (int i = 0; i < samples; i++)
+    {
+        Sample sample;
+        sample.theta = samples == 1 ? (qMin + qMax) / 2 : qMin + (qMax - qMin) * i / (samples - 1);
+
+        PoeExpression reducedPoe = makeReducedPoe(poe, redundantJoint, sample.theta);
+        sample.problem = buildProblem(reducedPoe, cache);
+
+        if (sample.problem == NULL)
+        {
+            CD_WARNING("Unable to build IK problem for sample %d (q[%d] = %f), skipping.\n", i, redundantJoint, sample.theta);
+            continue;
+        }
+
+        sample.workspace = new ScrewTheoryIkProblem::Workspace(*sample.problem);
+        sample.solutions.resize(sample.problem->solutions(), KDL::JntArray(reducedPoe.size()));
+        validSamples.push_back(sample);
+    }
+
+    if (validSamples.empty())
+    {
+        return NULL;
+    }
+
+    return new ScrewTheoryRedundancySolver(poe, redundantJoint, validSamples);
+}
+
+// -----------------------------------------------------------------------------
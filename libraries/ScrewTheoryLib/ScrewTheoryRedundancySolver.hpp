@@ -0,0 +1,130 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __SCREW_THEORY_REDUNDANCY_SOLVER_HPP__
+#define __SCREW_THEORY_REDUNDANCY_SOLVER_HPP__
+
+#include <vector>
+
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+
+#include "ConfigurationSelector.hpp"
+#include "ProductOfExponentials.hpp"
+#include "ScrewTheoryIkProblem.hpp"
+
+namespace roboticslab
+{
+
+class ScrewTheoryIkProblemCache;
+class ThreadPool;
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Closed-form IK for chains with one redundant joint
+ *
+ * The redundant joint is swept over a fixed grid of samples spanning its range of
+ * motion. Each sample is folded into the POE as a constant transformation, and a
+ * \ref ScrewTheoryIkProblem is built upon construction for the remaining joints.
+ * On each query, all samples are solved (in parallel, if a thread pool is given)
+ * and a ConfigurationSelector picks the best candidate among all of them.
+ *
+ * Candidates are laid out in a fixed fashion, i.e. index <tt>s * stride + k</tt>
+ * for the k-th solution of the s-th sample, thus stateful selectors such as
+ * ConfigurationSelectorLeastOverallAngularDisplacement keep tracking the same
+ * sample and branch across queries. Instances are not meant to be shared
+ * between threads.
+ */
+class ScrewTheoryRedundancySolver
+{
+public:
+
+    //! Destructor
+    ~ScrewTheoryRedundancySolver();
+
+    /**
+     * @brief Find the best solution among all samples of the redundant joint
+     *
+     * Unreachable solutions are discarded, out-of-limits branches are pruned early
+     * as in ScrewTheoryIkProblem::solve.
+     *
+     * @param H_S_T Target pose in cartesian space.
+     * @param selector Configuration selector (and joint limits) of the whole chain.
+     * @param qGuess Joint array of values for current robot position.
+     * @param q Output joint array.
+     * @param pool Optional thread pool samples are split across, all of them are
+     * solved in the calling thread if NULL.
+     *
+     * @return True if a valid solution has been found, false otherwise.
+     */
+    bool solve(const KDL::Frame & H_S_T, ConfigurationSelector & selector, const KDL::JntArray & qGuess,
+               KDL::JntArray & q, ThreadPool * pool = NULL);
+
+    //! Index of the redundant joint
+    int getRedundantJoint() const
+    { return redundantJoint; }
+
+    //! Number of samples of the redundant joint
+    int getSamples() const
+    { return samples.size(); }
+
+    //! Value of the redundant joint at the given sample
+    double getSample(int i) const
+    { return samples[i].theta; }
+
+    //! Product of exponentials (POE) formula of the whole chain
+    const PoeExpression & getPoe() const
+    { return poe; }
+
+    /**
+     * @brief Creates a solver instance
+     *
+     * Samples of the redundant joint are evenly distributed in [\p qMin, \p qMax],
+     * both included. Samples for which no IK problem can be built are skipped.
+     *
+     * @param poe Product of exponentials (POE) formula of the whole chain.
+     * @param redundantJoint Index of the redundant joint.
+     * @param qMin Lower bound of the redundant joint.
+     * @param qMax Upper bound of the redundant joint.
+     * @param samples Number of samples, at least one.
+     * @param cache Optional cache of IK problem descriptions, must outlive the
+     * solver. Useful for skipping the search on subsequent runs.
+     *
+     * @return An instance of this solver, NULL if no sample leads to a valid IK problem.
+     */
+    static ScrewTheoryRedundancySolver * create(const PoeExpression & poe, int redundantJoint, double qMin, double qMax,
+                                                int samples, ScrewTheoryIkProblemCache * cache = NULL);
+
+private:
+
+    struct Sample
+    {
+        double theta;
+        ScrewTheoryIkProblem * problem;
+        ScrewTheoryIkProblem::Workspace * workspace;
+        ScrewTheoryIkProblem::Solutions solutions;
+    };
+
+    ScrewTheoryRedundancySolver(const PoeExpression & poe, int redundantJoint, const std::vector<Sample> & samples);
+
+    // disable these, we own the IK problems
+    ScrewTheoryRedundancySolver(const ScrewTheoryRedundancySolver &);
+    ScrewTheoryRedundancySolver & operator=(const ScrewTheoryRedundancySolver &);
+
+    void solveSample(int i, const KDL::Frame & H_S_T, bool limits);
+
+    static void expandSolution(const KDL::JntArray & reduced, int redundantJoint, double theta, KDL::JntArray & q);
+
+    const PoeExpression poe;
+    const int redundantJoint;
+
+    std::vector<Sample> samples;
+    int stride;
+
+    KDL::JntArray reducedMin, reducedMax;
+    std::vector<KDL::JntArray> candidates;
+};
+
+}  // namespace roboticslab
+
+#endif  // __SCREW_THEORY_REDUNDANCY_SOLVER_HPP__
@@ -0,0 +1,228 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "SubproblemKernels.hpp"
+
+#include <cmath>
+
+#include <algorithm>
+#include <atomic>
+
+#include <kdl/utilities/utility.h>
+
+#include "ScrewTheoryIkSubproblems.hpp"
+#include "SubproblemKernelsImpl.hpp"
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    struct ScalarMask
+    {
+        ScalarMask(bool _m) : m(_m)
+        {}
+
+        void store(bool * p) const
+        { *p = m; }
+
+        bool m;
+    };
+
+    inline ScalarMask operator&(ScalarMask a, ScalarMask b)
+    { return a.m && b.m; }
+
+    inline ScalarMask operator|(ScalarMask a, ScalarMask b)
+    { return a.m || b.m; }
+
+    inline ScalarMask operator!(ScalarMask a)
+    { return !a.m; }
+
+    struct ScalarPack
+    {
+        typedef ScalarMask Mask;
+        static const int LANES = 1;
+
+        ScalarPack()
+        {}
+
+        ScalarPack(double _v) : v(_v)
+        {}
+
+        static ScalarPack load(const double * p)
+        { return *p; }
+
+        void store(double * p) const
+        { *p = v; }
+
+        double v;
+    };
+
+    inline ScalarPack operator+(ScalarPack a, ScalarPack b)
+    { return a.v + b.v; }
+
+    inline ScalarPack operator-(ScalarPack a, ScalarPack b)
+    { return a.v - b.v; }
+
+    inline ScalarPack operator-(ScalarPack a)
+    { return -a.v; }
+
+    inline ScalarPack operator*(ScalarPack a, ScalarPack b)
+    { return a.v * b.v; }
+
+    inline ScalarPack operator/(ScalarPack a, ScalarPack b)
+    { return a.v / b.v; }
+
+    inline ScalarMask operator<(ScalarPack a, ScalarPack b)
+    { return a.v < b.v; }
+
+    inline ScalarMask operator<=(ScalarPack a, ScalarPack b)
+    { return a.v <= b.v; }
+
+    inline ScalarMask operator>(ScalarPack a, ScalarPack b)
+    { return a.v > b.v; }
+
+    inline ScalarMask operator>=(ScalarPack a, ScalarPack b)
+    { return a.v >= b.v; }
+
+    inline ScalarPack sqrt(ScalarPack a)
+    { return std::sqrt(a.v); }
+
+    inline ScalarPack abs(ScalarPack a)
+    { return std::abs(a.v); }
+
+    inline ScalarPack atan2(ScalarPack y, ScalarPack x)
+    { return std::atan2(y.v, x.v); }
+
+    inline ScalarPack select(ScalarMask m, ScalarPack a, ScalarPack b)
+    { return m.m ? a : b; }
+
+    bool cpuSupportsAvx2()
+    {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+        return false;
+#endif
+    }
+
+    std::atomic<bool> useSimd(true);
+}
+
+// -----------------------------------------------------------------------------
+
+const SubproblemKernels & roboticslab::getScalarSubproblemKernels()
+{
+    static const SubproblemKernels scalarKernels = kernels::makeSubproblemKernels<ScalarPack>("scalar");
+    return scalarKernels;
+}
+
+// -----------------------------------------------------------------------------
+
+const SubproblemKernels * roboticslab::getSimdSubproblemKernels()
+{
+    static const SubproblemKernels * simdKernels = cpuSupportsAvx2() ? getAvx2SubproblemKernels() : NULL;
+    return simdKernels;
+}
+
+// -----------------------------------------------------------------------------
+
+const SubproblemKernels & roboticslab::getSubproblemKernels()
+{
+    const SubproblemKernels * simdKernels = getSimdSubproblemKernels();
+    return simdKernels != NULL && useSimd ? *simdKernels : getScalarSubproblemKernels();
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::setUseSimdSubproblemKernels(bool enable)
+{
+    useSimd = enable;
+}
+
+// -----------------------------------------------------------------------------
+
+int roboticslab::solveSubproblemBatch(SubproblemKernel kernel, int lanes, const SubproblemParams & params, const KDL::Vector & p,
+        const int * ids, int solutions, int joints, const KDL::Frame * rhs, const KDL::Frame * pointTransforms, int count,
+        ScrewTheoryIkSubproblem::Solutions * out, bool * reachable)
+{
+    // Small enough to live on the stack, must be a multiple of any lane width.
+    const int BLOCK = 32;
+
+    double f[3][BLOCK], k[3][BLOCK], theta[4][BLOCK];
+    bool blockReachable[BLOCK];
+
+    SubproblemParams blockParams = params;
+    blockParams.epsilon = KDL::epsilon;
+
+    SubproblemBatch batch;
+
+    for (int i = 0; i < 3; i++)
+    {
+        batch.f[i] = f[i];
+        batch.k[i] = k[i];
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        batch.theta[i] = theta[i];
+    }
+
+    batch.reachable = blockReachable;
+
+    int reachableCount = 0;
+
+    for (int start = 0; start < count; start += BLOCK)
+    {
+        int size = std::min(BLOCK, count - start);
+
+        // Pad the last block with copies of its last input.
+        batch.count = (size + lanes - 1) / lanes * lanes;
+
+        for (int i = 0; i < batch.count; i++)
+        {
+            int index = start + std::min(i, size - 1);
+
+            KDL::Vector fi = pointTransforms[index] * p;
+            KDL::Vector ki = rhs[index] * p;
+
+            f[0][i] = fi.x();
+            f[1][i] = fi.y();
+            f[2][i] = fi.z();
+
+            k[0][i] = ki.x();
+            k[1][i] = ki.y();
+            k[2][i] = ki.z();
+        }
+
+        kernel(blockParams, batch);
+
+        for (int i = 0; i < size; i++)
+        {
+            ScrewTheoryIkSubproblem::Solutions & solution = out[start + i];
+            solution.resize(solutions);
+
+            for (int j = 0; j < solutions; j++)
+            {
+                ScrewTheoryIkSubproblem::JointIdsToSolutions & jointIdsToSolutions = solution[j];
+                jointIdsToSolutions.resize(joints);
+
+                for (int l = 0; l < joints; l++)
+                {
+                    jointIdsToSolutions[l] = std::make_pair(ids[l], theta[j * ScrewTheoryIkSubproblem::MAX_JOINTS + l][i]);
+                }
+            }
+
+            if (reachable != NULL)
+            {
+                reachable[start + i] = blockReachable[i];
+            }
+
+            reachableCount += blockReachable[i];
+        }
+    }
+
+    return reachableCount;
+}
+
+// -----------------------------------------------------------------------------
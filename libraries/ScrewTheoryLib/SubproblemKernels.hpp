@@ -0,0 +1,116 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __SUBPROBLEM_KERNELS_HPP__
+#define __SUBPROBLEM_KERNELS_HPP__
+
+// Keep this header free of KDL includes: it is shared with translation units
+// compiled with extended instruction sets, where instantiating inline code from
+// third-party headers would break the one definition rule.
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Geometric invariants of an IK subproblem, as consumed by its kernel
+ *
+ * Each kernel picks the members it needs, see the corresponding subproblem
+ * class for their meaning.
+ */
+struct SubproblemParams
+{
+    double axis1[3];   //!< Axis of the first screw.
+    double axis2[3];   //!< Axis of the second screw, if any.
+    double origin1[3]; //!< Point on the first screw axis.
+    double origin2[3]; //!< Point on the second screw axis, if any.
+    double point[3];   //!< Auxiliary point or vector.
+    double cross[3];   //!< Precomputed cross product of axes, if any.
+    double scalar;     //!< Precomputed scalar invariant, if any.
+    double epsilon;    //!< Tolerance used in comparisons.
+};
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Structure-of-arrays view of a batch of subproblem inputs and outputs
+ *
+ * All arrays hold @ref count elements, which must be a multiple of the lane
+ * width of the kernel set in use.
+ */
+struct SubproblemBatch
+{
+    int count;              //!< Number of inputs.
+    const double * f[3];    //!< Transformed characteristic point, per coordinate.
+    const double * k[3];    //!< Right-hand side applied to the characteristic point, per coordinate.
+    double * theta[4];      //!< Output joint values, indexed by solution * 2 + joint.
+    bool * reachable;       //!< Output reachability flags.
+};
+
+//! Solves a subproblem for a whole batch of inputs
+typedef void (*SubproblemKernel)(const SubproblemParams & params, const SubproblemBatch & batch);
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Set of kernels that target a particular instruction set
+ */
+struct SubproblemKernels
+{
+    const char * name;                 //!< Human-readable name of the instruction set.
+    int lanes;                         //!< Number of inputs processed at once.
+    SubproblemKernel padenKahanOne;    //!< Kernel for @ref PadenKahanOne.
+    SubproblemKernel padenKahanTwo;    //!< Kernel for @ref PadenKahanTwo.
+    SubproblemKernel padenKahanThree;  //!< Kernel for @ref PadenKahanThree.
+    SubproblemKernel pardosGotorOne;   //!< Kernel for @ref PardosGotorOne.
+    SubproblemKernel pardosGotorTwo;   //!< Kernel for @ref PardosGotorTwo.
+    SubproblemKernel pardosGotorThree; //!< Kernel for @ref PardosGotorThree.
+    SubproblemKernel pardosGotorFour;  //!< Kernel for @ref PardosGotorFour.
+};
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Portable kernels, one input at a time
+ */
+const SubproblemKernels & getScalarSubproblemKernels();
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Vectorized kernels, if both compiled in and supported by this CPU
+ *
+ * @return NULL if not available.
+ */
+const SubproblemKernels * getSimdSubproblemKernels();
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Kernels in use by @ref ScrewTheoryIkSubproblem::solveBatch
+ *
+ * Vectorized kernels are preferred unless not available or disabled.
+ */
+const SubproblemKernels & getSubproblemKernels();
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Enables or disables vectorized kernels process-wide
+ *
+ * Meant for testing and benchmarking purposes, they are enabled by default.
+ */
+void setUseSimdSubproblemKernels(bool enable);
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief AVX2+FMA kernels, without checking CPU support
+ *
+ * @return NULL if not compiled in.
+ */
+const SubproblemKernels * getAvx2SubproblemKernels();
+
+}  // namespace roboticslab
+
+#endif  // __SUBPROBLEM_KERNELS_HPP__
@@ -0,0 +1,187 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+// Compiled with AVX2 and FMA enabled, if supported by the compiler. Nothing in
+// here may be called before checking for CPU support, see SubproblemKernels.cpp.
+
+#include "SubproblemKernels.hpp"
+
+#include <cstddef>
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+#include <immintrin.h>
+
+#include "SubproblemKernelsImpl.hpp"
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    struct Avx2Mask
+    {
+        Avx2Mask(__m256d _m) : m(_m)
+        {}
+
+        void store(bool * p) const
+        {
+            int bits = _mm256_movemask_pd(m);
+            p[0] = (bits & 1) != 0;
+            p[1] = (bits & 2) != 0;
+            p[2] = (bits & 4) != 0;
+            p[3] = (bits & 8) != 0;
+        }
+
+        __m256d m;
+    };
+
+    inline Avx2Mask operator&(Avx2Mask a, Avx2Mask b)
+    { return _mm256_and_pd(a.m, b.m); }
+
+    inline Avx2Mask operator|(Avx2Mask a, Avx2Mask b)
+    { return _mm256_or_pd(a.m, b.m); }
+
+    inline Avx2Mask operator!(Avx2Mask a)
+    { return _mm256_xor_pd(a.m, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))); }
+
+    struct Avx2Pack
+    {
+        typedef Avx2Mask Mask;
+        static const int LANES = 4;
+
+        Avx2Pack()
+        {}
+
+        Avx2Pack(double d) : v(_mm256_set1_pd(d))
+        {}
+
+        Avx2Pack(__m256d _v) : v(_v)
+        {}
+
+        static Avx2Pack load(const double * p)
+        { return _mm256_loadu_pd(p); }
+
+        void store(double * p) const
+        { _mm256_storeu_pd(p, v); }
+
+        __m256d v;
+    };
+
+    inline Avx2Pack operator+(Avx2Pack a, Avx2Pack b)
+    { return _mm256_add_pd(a.v, b.v); }
+
+    inline Avx2Pack operator-(Avx2Pack a, Avx2Pack b)
+    { return _mm256_sub_pd(a.v, b.v); }
+
+    inline Avx2Pack operator-(Avx2Pack a)
+    { return _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)); }
+
+    inline Avx2Pack operator*(Avx2Pack a, Avx2Pack b)
+    { return _mm256_mul_pd(a.v, b.v); }
+
+    inline Avx2Pack operator/(Avx2Pack a, Avx2Pack b)
+    { return _mm256_div_pd(a.v, b.v); }
+
+    inline Avx2Mask operator<(Avx2Pack a, Avx2Pack b)
+    { return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ); }
+
+    inline Avx2Mask operator<=(Avx2Pack a, Avx2Pack b)
+    { return _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ); }
+
+    inline Avx2Mask operator>(Avx2Pack a, Avx2Pack b)
+    { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+
+    inline Avx2Mask operator>=(Avx2Pack a, Avx2Pack b)
+    { return _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ); }
+
+    inline Avx2Pack sqrt(Avx2Pack a)
+    { return _mm256_sqrt_pd(a.v); }
+
+    inline Avx2Pack abs(Avx2Pack a)
+    { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v); }
+
+    inline Avx2Pack select(Avx2Mask m, Avx2Pack a, Avx2Pack b)
+    { return _mm256_blendv_pd(b.v, a.v, m.m); }
+
+    inline __m256d polynomial(__m256d x, double c0, double c1, double c2, double c3, double c4)
+    {
+        __m256d y = _mm256_fmadd_pd(_mm256_set1_pd(c0), x, _mm256_set1_pd(c1));
+        y = _mm256_fmadd_pd(y, x, _mm256_set1_pd(c2));
+        y = _mm256_fmadd_pd(y, x, _mm256_set1_pd(c3));
+        return _mm256_fmadd_pd(y, x, _mm256_set1_pd(c4));
+    }
+
+    // Rational approximation of atan(x) on [0, 1] borrowed from the Cephes
+    // library, inputs above 0.66 are reduced via atan(x) = pi/4 + atan((x-1)/(x+1)).
+    inline __m256d atanUnit(__m256d x)
+    {
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d moreBits = _mm256_set1_pd(6.123233995736765886130e-17);
+
+        __m256d big = _mm256_cmp_pd(x, _mm256_set1_pd(0.66), _CMP_GT_OQ);
+        __m256d xr = _mm256_blendv_pd(x, _mm256_div_pd(_mm256_sub_pd(x, one), _mm256_add_pd(x, one)), big);
+        __m256d base = _mm256_and_pd(big, _mm256_set1_pd(kernels::PI / 4));
+        __m256d extra = _mm256_and_pd(big, _mm256_mul_pd(_mm256_set1_pd(0.5), moreBits));
+
+        __m256d z = _mm256_mul_pd(xr, xr);
+
+        __m256d p = polynomial(z, -8.750608600031904122785e-1, -1.615753718733365076637e1,
+                -7.500855792314704667340e1, -1.228866684490136173410e2, -6.485021904942025371773e1);
+
+        __m256d q = polynomial(z, 1.0, 2.485846490142306297962e1, 1.650270098316988542046e2,
+                4.328810604912902668951e2, 4.853903996359136964868e2);
+        q = _mm256_fmadd_pd(q, z, _mm256_set1_pd(1.945506571482613964425e2));
+
+        __m256d t = _mm256_fmadd_pd(xr, _mm256_div_pd(_mm256_mul_pd(z, p), q), xr);
+        return _mm256_add_pd(base, _mm256_add_pd(t, extra));
+    }
+
+    // Same as std::atan2 for finite inputs, including signed zeros.
+    inline Avx2Pack atan2(Avx2Pack y, Avx2Pack x)
+    {
+        const __m256d signMask = _mm256_set1_pd(-0.0);
+        const __m256d zero = _mm256_setzero_pd();
+
+        __m256d ax = _mm256_andnot_pd(signMask, x.v);
+        __m256d ay = _mm256_andnot_pd(signMask, y.v);
+
+        __m256d num = _mm256_min_pd(ax, ay);
+        __m256d den = _mm256_max_pd(ax, ay);
+
+        // atan2(0, 0) is zero (before octant corrections), avoid 0/0
+        __m256d denZero = _mm256_cmp_pd(den, zero, _CMP_EQ_OQ);
+        __m256d ratio = _mm256_div_pd(num, _mm256_blendv_pd(den, _mm256_set1_pd(1.0), denZero));
+
+        __m256d t = atanUnit(ratio);
+
+        // |y| > |x|: atan(|y|/|x|) = pi/2 - atan(|x|/|y|)
+        __m256d swapped = _mm256_cmp_pd(ay, ax, _CMP_GT_OQ);
+        t = _mm256_blendv_pd(t, _mm256_sub_pd(_mm256_set1_pd(kernels::PI / 2), t), swapped);
+
+        // x < 0 (sign bit set): pi - t
+        t = _mm256_blendv_pd(t, _mm256_sub_pd(_mm256_set1_pd(kernels::PI), t), x.v);
+
+        // copy sign of y
+        return _mm256_or_pd(t, _mm256_and_pd(signMask, y.v));
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+const SubproblemKernels * roboticslab::getAvx2SubproblemKernels()
+{
+    static const SubproblemKernels avx2Kernels = kernels::makeSubproblemKernels<Avx2Pack>("AVX2");
+    return &avx2Kernels;
+}
+
+// -----------------------------------------------------------------------------
+
+#else
+
+const roboticslab::SubproblemKernels * roboticslab::getAvx2SubproblemKernels()
+{
+    return NULL;
+}
+
+#endif  // defined(__AVX2__) && defined(__FMA__)
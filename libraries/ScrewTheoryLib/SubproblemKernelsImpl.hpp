@@ -0,0 +1,441 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __SUBPROBLEM_KERNELS_IMPL_HPP__
+#define __SUBPROBLEM_KERNELS_IMPL_HPP__
+
+#include "SubproblemKernels.hpp"
+
+// Generic implementation of subproblem kernels, instantiated once per instruction set.
+//
+// A pack type P stands for a number of double-precision lanes (P::LANES) and must provide:
+//  - broadcast construction from double, P::load(const double *), store(double *);
+//  - arithmetic operators, comparison operators that return P::Mask;
+//  - free functions sqrt(P), abs(P), atan2(P, P) and select(P::Mask, P, P);
+//  - P::Mask must provide operators &, | and !, and store(bool *).
+//
+// Only templates may live here, see the note on SubproblemKernels.hpp.
+
+namespace roboticslab
+{
+
+namespace kernels
+{
+
+const double PI = 3.14159265358979323846;
+
+template <typename P>
+struct PackVector
+{
+    PackVector()
+    {}
+
+    PackVector(const P & _x, const P & _y, const P & _z)
+        : x(_x), y(_y), z(_z)
+    {}
+
+    // broadcast
+    explicit PackVector(const double * v)
+        : x(v[0]), y(v[1]), z(v[2])
+    {}
+
+    static PackVector load(const double * const * soa, int i)
+    { return PackVector(P::load(soa[0] + i), P::load(soa[1] + i), P::load(soa[2] + i)); }
+
+    P x, y, z;
+};
+
+template <typename P>
+inline PackVector<P> operator+(const PackVector<P> & a, const PackVector<P> & b)
+{ return PackVector<P>(a.x + b.x, a.y + b.y, a.z + b.z); }
+
+template <typename P>
+inline PackVector<P> operator-(const PackVector<P> & a, const PackVector<P> & b)
+{ return PackVector<P>(a.x - b.x, a.y - b.y, a.z - b.z); }
+
+template <typename P>
+inline PackVector<P> operator-(const PackVector<P> & a)
+{ return PackVector<P>(-a.x, -a.y, -a.z); }
+
+template <typename P>
+inline PackVector<P> operator*(const P & s, const PackVector<P> & a)
+{ return PackVector<P>(s * a.x, s * a.y, s * a.z); }
+
+template <typename P>
+inline PackVector<P> operator/(const PackVector<P> & a, const P & s)
+{ return PackVector<P>(a.x / s, a.y / s, a.z / s); }
+
+template <typename P>
+inline P dot(const PackVector<P> & a, const PackVector<P> & b)
+{ return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+template <typename P>
+inline PackVector<P> cross(const PackVector<P> & a, const PackVector<P> & b)
+{ return PackVector<P>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x); }
+
+template <typename P>
+inline P norm(const PackVector<P> & a)
+{ return sqrt(dot(a, a)); }
+
+// Component of `a` orthogonal to unit vector `axis`, i.e. (I - axis*axis') * a.
+template <typename P>
+inline PackVector<P> reject(const PackVector<P> & axis, const PackVector<P> & a)
+{ return a - dot(axis, a) * axis; }
+
+template <typename P>
+inline PackVector<P> select(const typename P::Mask & m, const PackVector<P> & a, const PackVector<P> & b)
+{ return PackVector<P>(select(m, a.x, b.x), select(m, a.y, b.y), select(m, a.z, b.z)); }
+
+// Same as KDL::Equal.
+template <typename P>
+inline typename P::Mask equal(const P & a, const P & b, const P & eps)
+{
+    P tmp = a - b;
+    return (eps > tmp) & (tmp > -eps);
+}
+
+template <typename P>
+inline typename P::Mask equal(const PackVector<P> & a, const PackVector<P> & b, const P & eps)
+{ return equal(a.x, b.x, eps) & equal(a.y, b.y, eps) & equal(a.z, b.z, eps); }
+
+// Same as roboticslab::normalizeAngle.
+template <typename P>
+inline P normalizeAngle(const P & angle, const P & eps)
+{
+    P out = select(angle > P(PI), angle - P(2 * PI), angle);
+    out = select(angle < P(-PI), angle + P(2 * PI), out);
+    return select(equal(abs(angle), P(PI), eps), P(PI), out);
+}
+
+// Same as std::acos, input is assumed to lie within [-1, 1].
+template <typename P>
+inline P acos(const P & x)
+{ return atan2(sqrt((P(1.0) - x) * (P(1.0) + x)), x); }
+
+// -----------------------------------------------------------------------------
+
+template <typename P>
+void padenKahanOne(const SubproblemParams & params, const SubproblemBatch & batch)
+{
+    const PackVector<P> axis(params.axis1);
+    const PackVector<P> origin(params.origin1);
+    const P eps(params.epsilon);
+
+    for (int i = 0; i < batch.count; i += P::LANES)
+    {
+        PackVector<P> f = PackVector<P>::load(batch.f, i);
+        PackVector<P> k = PackVector<P>::load(batch.k, i);
+
+        PackVector<P> u = f - origin;
+        PackVector<P> v = k - origin;
+
+        PackVector<P> u_p = reject(axis, u);
+        PackVector<P> v_p = reject(axis, v);
+
+        PackVector<P> u_w = u - u_p;
+        PackVector<P> v_w = v - v_p;
+
+        P theta = atan2(dot(axis, cross(u_p, v_p)), dot(u_p, v_p));
+
+        normalizeAngle(theta, eps).store(batch.theta[0] + i);
+        (equal(u_w, v_w, eps) & equal(norm(u_p), norm(v_p), eps)).store(batch.reachable + i);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+template <typename P>
+void padenKahanTwo(const SubproblemParams & params, const SubproblemBatch & batch)
+{
+    const PackVector<P> axis1(params.axis1);
+    const PackVector<P> axis2(params.axis2);
+    const PackVector<P> r(params.point);
+    const PackVector<P> axesCross(params.cross);
+    const P axesDot(params.scalar);
+    const P eps(params.epsilon);
+
+    const P den = axesDot * axesDot - P(1.0);
+    const P axesCrossPow = dot(axesCross, axesCross);
+
+    for (int i = 0; i < batch.count; i += P::LANES)
+    {
+        PackVector<P> f = PackVector<P>::load(batch.f, i);
+        PackVector<P> k = PackVector<P>::load(batch.k, i);
+
+        PackVector<P> u = f - r;
+        PackVector<P> v = k - r;
+
+        PackVector<P> u_p = reject(axis2, u);
+        PackVector<P> v_p = reject(axis1, v);
+
+        P axis1dot = dot(axis1, v);
+        P axis2dot = dot(axis2, u);
+
+        P alpha = (axesDot * axis2dot - axis1dot) / den;
+        P beta = (axesDot * axis1dot - axis2dot) / den;
+
+        PackVector<P> term1 = r + alpha * axis1 + beta * axis2;
+
+        P gamma2 = (dot(u, u) - alpha * alpha - beta * beta - P(2.0) * alpha * beta * axesDot) / axesCrossPow;
+        typename P::Mask gamma2_zero = equal(gamma2, P(0.0), eps);
+        typename P::Mask twoSolutions = (!gamma2_zero) & (gamma2 > P(0.0));
+
+        // Both solutions collapse into a single one (term1) otherwise.
+        P gamma = sqrt(select(twoSolutions, gamma2, P(0.0)));
+        PackVector<P> term2 = gamma * axesCross;
+
+        PackVector<P> m = term1 - term2 - r;
+        PackVector<P> n = term1 + term2 - r;
+
+        PackVector<P> m1_p = reject(axis1, m);
+        PackVector<P> m2_p = reject(axis2, m);
+
+        PackVector<P> n1_p = reject(axis1, n);
+        PackVector<P> n2_p = reject(axis2, n);
+
+        P theta1_1 = atan2(dot(axis1, cross(m1_p, v_p)), dot(m1_p, v_p));
+        P theta2_1 = atan2(dot(axis2, cross(u_p, m2_p)), dot(u_p, m2_p));
+
+        P theta1_2 = atan2(dot(axis1, cross(n1_p, v_p)), dot(n1_p, v_p));
+        P theta2_2 = atan2(dot(axis2, cross(u_p, n2_p)), dot(u_p, n2_p));
+
+        normalizeAngle(theta1_1, eps).store(batch.theta[0] + i);
+        normalizeAngle(theta2_1, eps).store(batch.theta[1] + i);
+        normalizeAngle(theta1_2, eps).store(batch.theta[2] + i);
+        normalizeAngle(theta2_2, eps).store(batch.theta[3] + i);
+
+        typename P::Mask ret = (twoSolutions | gamma2_zero) & equal(norm(m1_p), norm(v_p), eps);
+        ret.store(batch.reachable + i);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+template <typename P>
+void padenKahanThree(const SubproblemParams & params, const SubproblemBatch & batch)
+{
+    const PackVector<P> axis(params.axis1);
+    const PackVector<P> origin(params.origin1);
+    const PackVector<P> kc(params.point);
+    const P eps(params.epsilon);
+
+    const PackVector<P> v_p = reject(axis, kc - origin);
+    const P v_p_norm = norm(v_p);
+
+    for (int i = 0; i < batch.count; i += P::LANES)
+    {
+        PackVector<P> f = PackVector<P>::load(batch.f, i);
+        PackVector<P> k = PackVector<P>::load(batch.k, i);
+
+        PackVector<P> rhsAsVector = k - kc;
+        P delta = norm(rhsAsVector);
+
+        PackVector<P> u_p = reject(axis, f - origin);
+
+        P alpha = atan2(dot(axis, cross(u_p, v_p)), dot(u_p, v_p));
+        P axisDot = dot(axis, f - kc);
+        P delta_p_2 = delta * delta - axisDot * axisDot;
+
+        P u_p_norm = norm(u_p);
+
+        P betaCos = (u_p_norm * u_p_norm + v_p_norm * v_p_norm - delta_p_2) / (P(2.0) * u_p_norm * v_p_norm);
+        P betaCosAbs = abs(betaCos);
+        typename P::Mask beta_zero = equal(betaCosAbs, P(1.0), eps);
+        typename P::Mask twoSolutions = (!beta_zero) & (betaCosAbs < P(1.0));
+
+        P beta = acos(select(twoSolutions, betaCos, P(1.0)));
+
+        normalizeAngle(alpha + beta, eps).store(batch.theta[0] + i);
+        normalizeAngle(alpha - beta, eps).store(batch.theta[2] + i);
+
+        (twoSolutions | beta_zero).store(batch.reachable + i);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+template <typename P>
+void pardosGotorOne(const SubproblemParams & params, const SubproblemBatch & batch)
+{
+    const PackVector<P> axis(params.axis1);
+    const P zero(0.0);
+
+    for (int i = 0; i < batch.count; i += P::LANES)
+    {
+        PackVector<P> f = PackVector<P>::load(batch.f, i);
+        PackVector<P> k = PackVector<P>::load(batch.k, i);
+
+        dot(axis, k - f).store(batch.theta[0] + i);
+        (zero <= zero).store(batch.reachable + i);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+template <typename P>
+void pardosGotorTwo(const SubproblemParams & params, const SubproblemBatch & batch)
+{
+    const PackVector<P> axis1(params.axis1);
+    const PackVector<P> axis2(params.axis2);
+    const PackVector<P> crossPr2(params.cross);
+    const P crossPr2Norm(params.scalar);
+    const P zero(0.0);
+
+    for (int i = 0; i < batch.count; i += P::LANES)
+    {
+        PackVector<P> f = PackVector<P>::load(batch.f, i);
+        PackVector<P> k = PackVector<P>::load(batch.k, i);
+
+        PackVector<P> crossPr1 = cross(axis2, f - k);
+        P crossPr1Norm = norm(crossPr1);
+        P ratio = crossPr1Norm / crossPr2Norm;
+
+        P scale = select(dot(crossPr1, crossPr2) >= crossPr1Norm * crossPr2Norm, ratio, -ratio);
+        PackVector<P> c = k + scale * axis1;
+
+        dot(axis1, k - c).store(batch.theta[0] + i);
+        dot(axis2, c - f).store(batch.theta[1] + i);
+        (zero <= zero).store(batch.reachable + i);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+template <typename P>
+void pardosGotorThree(const SubproblemParams & params, const SubproblemBatch & batch)
+{
+    const PackVector<P> axis(params.axis1);
+    const PackVector<P> kc(params.point);
+    const P eps(params.epsilon);
+
+    for (int i = 0; i < batch.count; i += P::LANES)
+    {
+        PackVector<P> f = PackVector<P>::load(batch.f, i);
+        PackVector<P> k = PackVector<P>::load(batch.k, i);
+
+        PackVector<P> rhsAsVector = k - kc;
+        PackVector<P> diff = kc - f;
+
+        P dotPr = dot(axis, diff);
+        P sq2 = dotPr * dotPr - dot(diff, diff) + dot(rhsAsVector, rhsAsVector);
+        typename P::Mask sq2_zero = equal(sq2, P(0.0), eps);
+        typename P::Mask twoSolutions = (!sq2_zero) & (sq2 > P(0.0));
+
+        P sq = sqrt(abs(sq2));
+        P proy = norm(dotPr * axis);
+
+        select(twoSolutions, dotPr + sq, proy).store(batch.theta[0] + i);
+        select(twoSolutions, dotPr - sq, proy).store(batch.theta[2] + i);
+
+        (twoSolutions | sq2_zero).store(batch.reachable + i);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+template <typename P>
+void pardosGotorFour(const SubproblemParams & params, const SubproblemBatch & batch)
+{
+    const PackVector<P> axis1(params.axis1);
+    const PackVector<P> axis2(params.axis2);
+    const PackVector<P> origin1(params.origin1);
+    const PackVector<P> origin2(params.origin2);
+    const PackVector<P> n(params.point);
+    const P eps(params.epsilon);
+
+    for (int i = 0; i < batch.count; i += P::LANES)
+    {
+        PackVector<P> f = PackVector<P>::load(batch.f, i);
+        PackVector<P> k = PackVector<P>::load(batch.k, i);
+
+        PackVector<P> u = f - origin2;
+        PackVector<P> v = k - origin1;
+
+        // both axes are parallel
+        PackVector<P> u_p = reject(axis1, u);
+        PackVector<P> v_p = reject(axis1, v);
+
+        PackVector<P> c1 = origin1 + v - v_p;
+        PackVector<P> c2 = origin2 + u - u_p;
+
+        PackVector<P> c_diff = c2 - c1;
+        typename P::Mask samePlane = equal(c_diff, n, eps);
+
+        // proyection of c_diff onto the perpendicular plane, c1 on the intersection
+        // of axis 1 and the normal plane to both axes
+        c_diff = select(samePlane, c_diff, n);
+        c1 = c2 - c_diff;
+
+        P c_norm = norm(c_diff);
+        P u_p_norm = norm(u_p);
+        P v_p_norm = norm(v_p);
+
+        P c_test = u_p_norm + v_p_norm - c_norm;
+        typename P::Mask c_zero = equal(c_test, P(0.0), eps);
+        typename P::Mask twoSolutions = (!c_zero) & (c_test > P(0.0));
+
+        // two solutions
+
+        PackVector<P> omega_a = c_diff / c_norm;
+        PackVector<P> omega_h = cross(axis1, omega_a);
+
+        P a = (c_norm * c_norm - u_p_norm * u_p_norm + v_p_norm * v_p_norm) / (P(2.0) * c_norm);
+        P h = sqrt(abs(v_p_norm * v_p_norm - a * a));
+
+        PackVector<P> term1 = c1 + a * omega_a;
+        PackVector<P> term2 = h * omega_h;
+
+        PackVector<P> c = term1 + term2;
+        PackVector<P> d = term1 - term2;
+
+        PackVector<P> m1_p = reject(axis1, c - origin1);
+        PackVector<P> m2_p = reject(axis1, c - origin2);
+
+        PackVector<P> n1_p = reject(axis1, d - origin1);
+        PackVector<P> n2_p = reject(axis1, d - origin2);
+
+        P theta1_1 = atan2(dot(axis1, cross(m1_p, v_p)), dot(m1_p, v_p));
+        P theta2_1 = atan2(dot(axis2, cross(u_p, m2_p)), dot(u_p, m2_p));
+
+        P theta1_2 = atan2(dot(axis1, cross(n1_p, v_p)), dot(n1_p, v_p));
+        P theta2_2 = atan2(dot(axis2, cross(u_p, n2_p)), dot(u_p, n2_p));
+
+        // single solution
+
+        P theta1 = atan2(dot(axis1, cross(c_diff, v_p)), dot(c_diff, v_p));
+        P theta2 = atan2(dot(axis2, cross(u_p, c_diff)), dot(-c_diff, u_p));
+
+        normalizeAngle(select(twoSolutions, theta1_1, theta1), eps).store(batch.theta[0] + i);
+        normalizeAngle(select(twoSolutions, theta2_1, theta2), eps).store(batch.theta[1] + i);
+        normalizeAngle(select(twoSolutions, theta1_2, theta1), eps).store(batch.theta[2] + i);
+        normalizeAngle(select(twoSolutions, theta2_2, theta2), eps).store(batch.theta[3] + i);
+
+        typename P::Mask ret = (twoSolutions & samePlane & equal(norm(m1_p), v_p_norm, eps)) | ((!twoSolutions) & c_zero);
+        ret.store(batch.reachable + i);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+template <typename P>
+SubproblemKernels makeSubproblemKernels(const char * name)
+{
+    SubproblemKernels out = {
+        name,
+        P::LANES,
+        padenKahanOne<P>,
+        padenKahanTwo<P>,
+        padenKahanThree<P>,
+        pardosGotorOne<P>,
+        pardosGotorTwo<P>,
+        pardosGotorThree<P>,
+        pardosGotorFour<P>
+    };
+
+    return out;
+}
+
+}  // namespace kernels
+
+}  // namespace roboticslab
+
+#endif  // __SUBPROBLEM_KERNELS_IMPL_HPP__
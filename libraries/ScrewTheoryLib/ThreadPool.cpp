@@ -0,0 +1,167 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    // Number of chunks per thread, balances scheduling overhead and load imbalance.
+    const int CHUNKS_PER_THREAD = 4;
+}
+
+// -----------------------------------------------------------------------------
+
+ThreadPool::ThreadPool(int threads)
+    : task(NULL),
+      count(0),
+      chunkSize(0),
+      next(0),
+      done(0),
+      job(0),
+      stopping(false)
+{
+    if (threads <= 0)
+    {
+        threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+    }
+
+    // The calling thread takes part in the computation, too.
+    workers.reserve(threads - 1);
+
+    for (int i = 0; i < threads - 1; i++)
+    {
+        workers.push_back(std::thread(&ThreadPool::run, this));
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+
+    startCondition.notify_all();
+
+    for (int i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void ThreadPool::parallelFor(int count, const Task & task)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    if (workers.empty() || count == 1)
+    {
+        task(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> callerLock(callerMtx);
+    unsigned long currentJob;
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        this->task = &task;
+        this->count = count;
+        chunkSize = std::max(1, count / (size() * CHUNKS_PER_THREAD));
+        next = done = 0;
+        currentJob = ++job;
+    }
+
+    startCondition.notify_all();
+
+    work(currentJob);
+
+    std::unique_lock<std::mutex> lock(mtx);
+
+    while (done != this->count)
+    {
+        doneCondition.wait(lock);
+    }
+
+    this->task = NULL;
+}
+
+// -----------------------------------------------------------------------------
+
+void ThreadPool::run()
+{
+    unsigned long lastJob = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+
+            while (!stopping && job == lastJob)
+            {
+                startCondition.wait(lock);
+            }
+
+            if (stopping)
+            {
+                return;
+            }
+
+            lastJob = job;
+        }
+
+        work(lastJob);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void ThreadPool::work(unsigned long currentJob)
+{
+    while (true)
+    {
+        const Task * currentTask;
+        int start, end;
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+
+            // Don't pick chunks from a different (newer) job, nor past the end of this one.
+            if (job != currentJob || next >= count)
+            {
+                return;
+            }
+
+            start = next;
+            end = std::min(start + chunkSize, count);
+            next = end;
+            currentTask = task;
+        }
+
+        (*currentTask)(start, end);
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            done += end - start;
+
+            if (done == count)
+            {
+                doneCondition.notify_all();
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,84 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __THREAD_POOL_HPP__
+#define __THREAD_POOL_HPP__
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Fixed-size pool of worker threads for data-parallel workloads
+ *
+ * Splits a range of independent work items into contiguous chunks that are
+ * processed by the worker threads, as well as by the calling thread itself.
+ * Threads are spawned once on construction and joined on destruction.
+ */
+class ThreadPool
+{
+public:
+
+    //! Callback invoked on a half-open range [start, end) of work items
+    typedef std::function<void(int start, int end)> Task;
+
+    /**
+     * @brief Constructor
+     *
+     * @param threads Total number of threads, including the calling one. Defaults
+     * to the number of concurrent threads supported by the hardware if zero or less.
+     */
+    explicit ThreadPool(int threads = 0);
+
+    //! Destructor
+    ~ThreadPool();
+
+    //! Total number of threads, including the calling one
+    int size() const
+    { return workers.size() + 1; }
+
+    /**
+     * @brief Processes a range of work items in parallel
+     *
+     * Blocks until all items have been processed. Concurrent calls from different
+     * threads are serialized.
+     *
+     * @param count Number of work items.
+     * @param task Callback that processes a chunk of work items.
+     */
+    void parallelFor(int count, const Task & task);
+
+private:
+
+    // disable these, worker threads are bound to this instance
+    ThreadPool(const ThreadPool &);
+    ThreadPool & operator=(const ThreadPool &);
+
+    void run();
+    void work(unsigned long job);
+
+    std::vector<std::thread> workers;
+
+    std::mutex mtx;
+    std::mutex callerMtx;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+
+    const Task * task;
+    int count;
+    int chunkSize;
+    int next;
+    int done;
+    unsigned long job;
+    bool stopping;
+};
+
+}  // namespace roboticslab
+
+#endif  // __THREAD_POOL_HPP__
@@ -50,7 +50,8 @@ bool roboticslab::KdlTrajectory::getPosition(double movementTime, std::vector<do
     try
     {
         const KDL::Frame & xFrame = currentTrajectory->Pos(movementTime);
-        position = KdlVectorConverter::frameToVector(xFrame);
+        position.resize(6);
+        KdlVectorConverter::frameToArray(xFrame, position.data());
         return true;
     }
     catch (const KDL::Error_MotionPlanning &e)
@@ -67,7 +68,8 @@ bool roboticslab::KdlTrajectory::getVelocity(double movementTime, std::vector<do
     try
     {
         const KDL::Twist & xdotFrame = currentTrajectory->Vel(movementTime);
-        velocity = KdlVectorConverter::twistToVector(xdotFrame);
+        velocity.resize(6);
+        KdlVectorConverter::twistToArray(xdotFrame, velocity.data());
         return true;
     }
     catch (const KDL::Error_MotionPlanning &e)
@@ -84,7 +86,8 @@ bool roboticslab::KdlTrajectory::getAcceleration(double movementTime, std::vecto
     try
     {
         const KDL::Twist & xdotdotFrame = currentTrajectory->Acc(movementTime);
-        acceleration = KdlVectorConverter::twistToVector(xdotdotFrame);
+        acceleration.resize(6);
+        KdlVectorConverter::twistToArray(xdotdotFrame, acceleration.data());
         return true;
     }
     catch (const KDL::Error_MotionPlanning &e)
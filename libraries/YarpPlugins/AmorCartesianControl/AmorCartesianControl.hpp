@@ -56,6 +56,10 @@ public:
 
     virtual bool inv(const std::vector<double> &xd, std::vector<double> &q);
 
+    virtual bool fwdBatch(const std::vector<double> &qs, std::vector<double> &xs);
+
+    virtual bool invBatch(const std::vector<double> &xds, std::vector<double> &qs);
+
     virtual bool movj(const std::vector<double> &xd);
 
     virtual bool relj(const std::vector<double> &xd);
@@ -78,6 +78,47 @@ bool roboticslab::AmorCartesianControl::inv(const std::vector<double> &xd, std::
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::AmorCartesianControl::fwdBatch(const std::vector<double> &qs, std::vector<double> &xs)
+{
+    if (!iCartesianSolver->fwdKinBatch(qs, xs))
+    {
+        CD_ERROR("fwdKinBatch failed.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::AmorCartesianControl::invBatch(const std::vector<double> &xds, std::vector<double> &qs)
+{
+    AMOR_VECTOR7 positions;
+
+    if (amor_get_actual_positions(handle, &positions) != AMOR_SUCCESS)
+    {
+        CD_ERROR("%s\n", amor_error());
+        return false;
+    }
+
+    std::vector<double> currentQ(AMOR_NUM_JOINTS);
+
+    for (int i = 0; i < AMOR_NUM_JOINTS; i++)
+    {
+        currentQ[i] = KinRepresentation::radToDeg(positions[i]);
+    }
+
+    if (!iCartesianSolver->invKinBatch(xds, currentQ, qs, referenceFrame))
+    {
+        CD_ERROR("invKinBatch failed.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::AmorCartesianControl::movj(const std::vector<double> &xd)
 {
     std::vector<double> qd;
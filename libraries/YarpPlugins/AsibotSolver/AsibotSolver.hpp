@@ -22,6 +22,7 @@
 #define DEFAULT_A3 0.3
 
 #define DEFAULT_STRATEGY "leastOverallAngularDisplacement"
+#define DEFAULT_BATCH_THREADS 0  // hardware concurrency
 
 namespace roboticslab
 {
@@ -44,7 +45,8 @@ public:
 
     AsibotSolver()
         : A0(DEFAULT_A0), A1(DEFAULT_A1), A2(DEFAULT_A2), A3(DEFAULT_A3),
-          confFactory(NULL)
+          confFactory(NULL),
+          batchThreads(1)
     {}
 
 // -------- ICartesianSolver declarations. Implementation in ICartesianSolverImpl.cpp --------
@@ -72,6 +74,9 @@ public:
     // Perform inverse kinematics.
     virtual bool invKin(const std::vector<double> &xd, const std::vector<double> &qGuess, std::vector<double> &q, const reference_frame frame);
 
+    // Perform inverse kinematics within a time budget.
+    virtual bool invKinBudget(const std::vector<double> &xd, const std::vector<double> &qGuess, double budget, std::vector<double> &q, double &residual, const reference_frame frame);
+
     // Perform differential inverse kinematics.
     virtual bool diffInvKin(const std::vector<double> &q, const std::vector<double> &xdot, std::vector<double> &qdot, const reference_frame frame);
 
@@ -81,6 +86,15 @@ public:
     // Perform inverse dynamics.
     virtual bool invDyn(const std::vector<double> &q,const std::vector<double> &qdot,const std::vector<double> &qdotdot, const std::vector< std::vector<double> > &fexts, std::vector<double> &t);
 
+    // Perform forward kinematics on a batch of joint positions.
+    virtual bool fwdKinBatch(const std::vector<double> &qs, std::vector<double> &xs);
+
+    // Perform inverse kinematics on a batch of poses.
+    virtual bool invKinBatch(const std::vector<double> &xds, const std::vector<double> &qGuess, std::vector<double> &qs, const reference_frame frame);
+
+    // Perform differential inverse kinematics on a batch of joint positions.
+    virtual bool diffInvKinBatch(const std::vector<double> &qs, const std::vector<double> &xdots, std::vector<double> &qdots, const reference_frame frame);
+
 // -------- DeviceDriver declarations. Implementation in IDeviceImpl.cpp --------
 
     /**
@@ -127,6 +141,8 @@ private:
 
     AsibotTcpFrame tcpFrameStruct;
 
+    int batchThreads;  // threads spawned per batch query, including the caller
+
     mutable std::mutex mtx;
 };
 
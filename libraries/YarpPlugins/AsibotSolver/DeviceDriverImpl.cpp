@@ -2,9 +2,11 @@
 
 #include "AsibotSolver.hpp"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
+#include <thread>
 
 #include <yarp/os/ResourceFinder.h>
 #include <yarp/os/Value.h>
@@ -79,6 +81,13 @@ bool roboticslab::AsibotSolver::open(yarp::os::Searchable& config)
     tcpFrameStruct.hasFrame = false;
     tcpFrameStruct.frameTcp = yarp::math::eye(4);
 
+    batchThreads = config.check("batchThreads", yarp::os::Value(DEFAULT_BATCH_THREADS), "number of threads for batch queries (0: hardware concurrency)").asInt32();
+
+    if (batchThreads <= 0)
+    {
+        batchThreads = std::max<int>(std::thread::hardware_concurrency(), 1);
+    }
+
     return true;
 }
 
@@ -2,8 +2,12 @@
 
 #include "AsibotSolver.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <limits>
 #include <memory>
+#include <thread>
 
 #include <yarp/math/Math.h>
 #include <yarp/math/SVD.h>
@@ -181,6 +185,51 @@ namespace
         Ja(5, 3) = 0;
         Ja(5, 4) = 1;
     }
+
+    void fillNaN(std::vector<double>::iterator out, int size)
+    {
+        std::fill(out, out + size, std::numeric_limits<double>::quiet_NaN());
+    }
+
+    bool checkBatchSize(int size, int stride, int * count)
+    {
+        if (size % stride != 0)
+        {
+            CD_ERROR("Batch size mismatch: %d is not a multiple of %d.\n", size, stride);
+            return false;
+        }
+
+        *count = size / stride;
+        return true;
+    }
+
+    // Splits [0, count) into contiguous chunks, the calling thread processes the first one.
+    template <typename Task>
+    void parallelFor(int count, int threads, const Task & task)
+    {
+        int chunks = std::min(threads, count);
+
+        if (chunks <= 1)
+        {
+            task(0, count);
+            return;
+        }
+
+        int chunkSize = (count + chunks - 1) / chunks;
+        std::vector<std::thread> workers;
+
+        for (int start = chunkSize; start < count; start += chunkSize)
+        {
+            workers.push_back(std::thread(task, start, std::min(start + chunkSize, count)));
+        }
+
+        task(0, chunkSize);
+
+        for (int i = 0; i < workers.size(); i++)
+        {
+            workers[i].join();
+        }
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -414,6 +463,51 @@ bool AsibotSolver::invKin(const std::vector<double> &xd, const std::vector<doubl
 
 // -----------------------------------------------------------------------------
 
+bool AsibotSolver::invKinBudget(const std::vector<double> &xd, const std::vector<double> &qGuess, double budget,
+        std::vector<double> &q, double &residual, const reference_frame frame)
+{
+    // Closed-form solution, the time budget is irrelevant.
+    std::vector<double> xd_base_obj;
+
+    if (frame == TCP_FRAME)
+    {
+        std::vector<double> x_base_tcp;
+        fwdKin(qGuess, x_base_tcp);
+        changeOrigin(xd, x_base_tcp, xd_base_obj);
+    }
+    else if (frame == BASE_FRAME)
+    {
+        xd_base_obj = xd;
+    }
+    else
+    {
+        CD_ERROR("Unsupported reference frame");
+        return false;
+    }
+
+    if (!invKin(xd_base_obj, qGuess, q, BASE_FRAME))
+    {
+        return false;
+    }
+
+    std::vector<double> x, xOut;
+    fwdKin(q, x);
+    poseDiff(xd_base_obj, x, xOut);
+
+    residual = 0.0;
+
+    for (int i = 0; i < 6; i++)
+    {
+        residual += xOut[i] * xOut[i];
+    }
+
+    residual = std::sqrt(residual);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 bool AsibotSolver::diffInvKin(const std::vector<double> &q, const std::vector<double> &xdot, std::vector<double> &qdot,
         const reference_frame frame)
 {
@@ -496,3 +590,151 @@ bool AsibotSolver::invDyn(const std::vector<double> &q,const std::vector<double>
 }
 
 // -----------------------------------------------------------------------------
+
+bool AsibotSolver::fwdKinBatch(const std::vector<double> &qs, std::vector<double> &xs)
+{
+    int count;
+
+    if (!checkBatchSize(qs.size(), NUM_MOTORS, &count))
+    {
+        return false;
+    }
+
+    xs.resize(6 * count);
+
+    std::atomic<int> failures(0);
+
+    parallelFor(count, batchThreads, [&](int start, int end)
+    {
+        std::vector<double> x;
+
+        for (int i = start; i < end; i++)
+        {
+            std::vector<double> q(qs.begin() + NUM_MOTORS * i, qs.begin() + NUM_MOTORS * (i + 1));
+
+            if (!fwdKin(q, x) || x.size() != 6)
+            {
+                fillNaN(xs.begin() + 6 * i, 6);
+                failures++;
+                continue;
+            }
+
+            std::copy(x.begin(), x.end(), xs.begin() + 6 * i);
+        }
+    });
+
+    if (failures > 0)
+    {
+        CD_WARNING("%d out of %d batch entries failed.\n", failures.load(), count);
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool AsibotSolver::invKinBatch(const std::vector<double> &xds, const std::vector<double> &qGuess, std::vector<double> &qs,
+        const reference_frame frame)
+{
+    int count;
+
+    if (!checkBatchSize(xds.size(), 6, &count))
+    {
+        return false;
+    }
+
+    // Either a single initial guess shared by all entries, or one per entry.
+    bool sharedGuess = qGuess.size() == NUM_MOTORS;
+
+    if (!sharedGuess && qGuess.size() != NUM_MOTORS * count)
+    {
+        CD_ERROR("Size mismatch; expected: %d or %d, was: %d\n", NUM_MOTORS, NUM_MOTORS * count, (int)qGuess.size());
+        return false;
+    }
+
+    qs.resize(NUM_MOTORS * count);
+
+    std::atomic<int> failures(0);
+
+    parallelFor(count, batchThreads, [&](int start, int end)
+    {
+        std::vector<double> q;
+
+        for (int i = start; i < end; i++)
+        {
+            std::vector<double> xd(xds.begin() + 6 * i, xds.begin() + 6 * (i + 1));
+            std::vector<double>::const_iterator guess = qGuess.begin() + (sharedGuess ? 0 : NUM_MOTORS * i);
+
+            if (!invKin(xd, std::vector<double>(guess, guess + NUM_MOTORS), q, frame))
+            {
+                fillNaN(qs.begin() + NUM_MOTORS * i, NUM_MOTORS);
+                failures++;
+                continue;
+            }
+
+            std::copy(q.begin(), q.end(), qs.begin() + NUM_MOTORS * i);
+        }
+    });
+
+    if (failures > 0)
+    {
+        CD_WARNING("%d out of %d batch entries failed.\n", failures.load(), count);
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool AsibotSolver::diffInvKinBatch(const std::vector<double> &qs, const std::vector<double> &xdots, std::vector<double> &qdots,
+        const reference_frame frame)
+{
+    int count;
+
+    if (!checkBatchSize(qs.size(), NUM_MOTORS, &count))
+    {
+        return false;
+    }
+
+    if (xdots.size() != 6 * count)
+    {
+        CD_ERROR("Size mismatch; expected: %d, was: %d\n", 6 * count, (int)xdots.size());
+        return false;
+    }
+
+    qdots.resize(NUM_MOTORS * count);
+
+    std::atomic<int> failures(0);
+
+    parallelFor(count, batchThreads, [&](int start, int end)
+    {
+        std::vector<double> qdot;
+
+        for (int i = start; i < end; i++)
+        {
+            std::vector<double> q(qs.begin() + NUM_MOTORS * i, qs.begin() + NUM_MOTORS * (i + 1));
+            std::vector<double> xdot(xdots.begin() + 6 * i, xdots.begin() + 6 * (i + 1));
+
+            if (!diffInvKin(q, xdot, qdot, frame))
+            {
+                fillNaN(qdots.begin() + NUM_MOTORS * i, NUM_MOTORS);
+                failures++;
+                continue;
+            }
+
+            std::copy(qdot.begin(), qdot.end(), qdots.begin() + NUM_MOTORS * i);
+        }
+    });
+
+    if (failures > 0)
+    {
+        CD_WARNING("%d out of %d batch entries failed.\n", failures.load(), count);
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
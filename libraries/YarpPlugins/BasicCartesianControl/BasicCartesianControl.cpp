@@ -115,7 +115,13 @@ bool BasicCartesianControl::checkJointVelocities(const std::vector<double> &qdot
 bool BasicCartesianControl::checkControlModes(int mode)
 {
     std::vector<int> modes(numRobotJoints);
+    return checkControlModes(mode, modes);
+}
+
+// -----------------------------------------------------------------------------
 
+bool BasicCartesianControl::checkControlModes(int mode, std::vector<int> &modes)
+{
     if (!iControlMode->getControlModes(modes.data()))
     {
         CD_WARNING("getControlModes failed.\n");
@@ -19,6 +19,7 @@
 #endif
 
 #include "ICartesianSolver.h"
+#include "ICartesianSolverInPlace.h"
 #include "ICartesianControl.h"
 
 #include "ICartesianTrajectory.hpp"
@@ -121,6 +122,7 @@ public:
 
     BasicCartesianControl() : yarp::os::PeriodicThread(DEFAULT_CMC_PERIOD_MS * 0.001),
                               iCartesianSolver(NULL),
+                              iCartesianSolverInPlace(NULL),
                               iControlLimits(NULL),
                               iControlMode(NULL),
                               iEncoders(NULL),
@@ -149,6 +151,10 @@ public:
 
     virtual bool inv(const std::vector<double> &xd, std::vector<double> &q);
 
+    virtual bool fwdBatch(const std::vector<double> &qs, std::vector<double> &xs);
+
+    virtual bool invBatch(const std::vector<double> &xds, std::vector<double> &qs);
+
     virtual bool movj(const std::vector<double> &xd);
 
     virtual bool relj(const std::vector<double> &xd);
@@ -221,6 +227,7 @@ protected:
     bool checkJointVelocities(const std::vector<double> &qdot);
 
     bool checkControlModes(int mode);
+    bool checkControlModes(int mode, std::vector<int> &modes);
     bool setControlModes(int mode);
     bool presetStreamingCommand(int command);
     void computeIsocronousSpeeds(const std::vector<double> & q, const std::vector<double> & qd, std::vector<double> & qdot);
@@ -231,9 +238,21 @@ protected:
     void handleGcmp(const std::vector<double> &q);
     void handleForc(const std::vector<double> &q);
 
+    //-- Also stores the Jacobian at 'q', to be reused by the next call to loopDiffInvKin.
+    bool loopFwdKin(const std::vector<double> &q, std::vector<double> &x);
+    bool loopPoseDiff(const std::vector<double> &xLhs, const std::vector<double> &xRhs, std::vector<double> &xOut);
+    //-- Expects 'x' as obtained from loopFwdKin on the same 'q'.
+    bool loopDiffInvKin(const std::vector<double> &q, const std::vector<double> &x, const std::vector<double> &xdot,
+            std::vector<double> &qdot, ICartesianSolver::reference_frame frame);
+    bool loopInvDyn(const std::vector<double> &q, std::vector<double> &t);
+    bool loopInvDyn(const std::vector<double> &q, const std::vector<double> &fext, std::vector<double> &t);
+
     yarp::dev::PolyDriver solverDevice;
     ICartesianSolver *iCartesianSolver;
 
+    /** Allocation-free solver queries, NULL if not supported by the solver device */
+    ICartesianSolverInPlace *iCartesianSolverInPlace;
+
     yarp::dev::PolyDriver robotDevice;
     yarp::dev::IControlLimits *iControlLimits;
     yarp::dev::IControlMode *iControlMode;
@@ -275,6 +294,12 @@ protected:
     std::vector<double> qMin, qMax;
     std::vector<double> qdotMin, qdotMax;
     std::vector<double> qRefSpeeds;
+
+    /** Control loop storage, sized once in open() so that run() does not allocate */
+    std::vector<double> loopQ, loopQRad, loopQdotRad, loopQdotdotRad;
+    std::vector<double> loopX, loopXd, loopXdotd, loopCommandXdot, loopCommandQdot;
+    std::vector<double> loopT, loopFexts, loopJ;
+    std::vector<int> loopModes;
 };
 
 }  // namespace roboticslab
@@ -2,6 +2,8 @@
 
 #include "BasicCartesianControl.hpp"
 
+#include <algorithm>
+
 #include <ColorDebug.h>
 
 // ------------------- DeviceDriver Related ------------------------------------
@@ -171,6 +173,12 @@ bool roboticslab::BasicCartesianControl::open(yarp::os::Searchable& config)
         return false;
     }
 
+    if (!solverDevice.view(iCartesianSolverInPlace))
+    {
+        CD_INFO("Solver device %s does not implement ICartesianSolverInPlace.\n", solverStr.c_str());
+        iCartesianSolverInPlace = NULL;
+    }
+
     iCartesianSolver->getNumJoints(&numSolverJoints);
     CD_INFO("numSolverJoints: %d.\n", numSolverJoints);
 
@@ -179,6 +187,23 @@ bool roboticslab::BasicCartesianControl::open(yarp::os::Searchable& config)
         CD_WARNING("numRobotJoints(%d) != numSolverJoints(%d) !!!\n", numRobotJoints, numSolverJoints);
     }
 
+    //-- Solver queries iterate over solver joints, robot commands over robot joints.
+    int loopJoints = std::max(numRobotJoints, numSolverJoints);
+
+    loopQ.resize(loopJoints);
+    loopQRad.resize(loopJoints);
+    loopQdotRad.resize(loopJoints);
+    loopQdotdotRad.assign(loopJoints, 0.0);
+    loopX.resize(6);
+    loopXd.resize(6);
+    loopXdotd.resize(6);
+    loopCommandXdot.resize(6);
+    loopCommandQdot.resize(loopJoints);
+    loopT.resize(loopJoints);
+    loopFexts.assign(6 * numRobotJoints, 0.0);
+    loopJ.resize(6 * numSolverJoints);
+    loopModes.resize(numRobotJoints);
+
     if (cmcPeriodMs != DEFAULT_CMC_PERIOD_MS)
     {
         yarp::os::PeriodicThread::setPeriod(cmcPeriodMs * 0.001);
@@ -78,6 +78,40 @@ bool roboticslab::BasicCartesianControl::inv(const std::vector<double> &xd, std:
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::BasicCartesianControl::fwdBatch(const std::vector<double> &qs, std::vector<double> &xs)
+{
+    if (!iCartesianSolver->fwdKinBatch(qs, xs))
+    {
+        CD_ERROR("fwdKinBatch failed.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::BasicCartesianControl::invBatch(const std::vector<double> &xds, std::vector<double> &qs)
+{
+    std::vector<double> currentQ(numRobotJoints);
+
+    if (!iEncoders->getEncoders(currentQ.data()))
+    {
+        CD_ERROR("getEncoders failed.\n");
+        return false;
+    }
+
+    if (!iCartesianSolver->invKinBatch(xds, currentQ, qs, referenceFrame))
+    {
+        CD_ERROR("invKinBatch failed.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::BasicCartesianControl::movj(const std::vector<double> &xd)
 {
     std::vector<double> currentQ(numRobotJoints), qd;
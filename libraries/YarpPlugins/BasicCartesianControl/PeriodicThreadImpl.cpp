@@ -2,10 +2,14 @@
 
 #include "BasicCartesianControl.hpp"
 
+#include <algorithm>
+
 #include <yarp/os/Time.h>
 
 #include <ColorDebug.h>
 
+#include "KinematicRepresentation.hpp"
+
 // ------------------- PeriodicThread Related ------------------------------------
 
 void roboticslab::BasicCartesianControl::run()
@@ -17,7 +21,7 @@ void roboticslab::BasicCartesianControl::run()
         return;
     }
 
-    std::vector<double> q(numRobotJoints);
+    std::vector<double> & q = loopQ;
 
     if (!iEncoders->getEncoders(q.data()))
     {
@@ -59,7 +63,7 @@ void roboticslab::BasicCartesianControl::run()
 
 void roboticslab::BasicCartesianControl::handleMovj(const std::vector<double> &q)
 {
-    if (!checkControlModes(VOCAB_CM_POSITION))
+    if (!checkControlModes(VOCAB_CM_POSITION, loopModes))
     {
         CD_ERROR("Not in position control mode.\n");
         cmcSuccess = false;
@@ -92,7 +96,7 @@ void roboticslab::BasicCartesianControl::handleMovj(const std::vector<double> &q
 
 void roboticslab::BasicCartesianControl::handleMovl(const std::vector<double> &q)
 {
-    if (!checkControlModes(VOCAB_CM_VELOCITY))
+    if (!checkControlModes(VOCAB_CM_VELOCITY, loopModes))
     {
         CD_ERROR("Not in velocity control mode.\n");
         cmcSuccess = false;
@@ -111,22 +115,23 @@ void roboticslab::BasicCartesianControl::handleMovl(const std::vector<double> &q
         return;
     }
 
-    std::vector<double> currentX;
+    std::vector<double> & currentX = loopX;
 
-    if (!iCartesianSolver->fwdKin(q, currentX))
+    if (!loopFwdKin(q, currentX))
     {
         CD_WARNING("fwdKin failed, not updating control this iteration.\n");
         return;
     }
 
     //-- Obtain desired Cartesian position and velocity.
-    std::vector<double> desiredX, desiredXdot;
+    std::vector<double> & desiredX = loopXd;
+    std::vector<double> & desiredXdot = loopXdotd;
     iCartesianTrajectory->getPosition(movementTime, desiredX);
     iCartesianTrajectory->getVelocity(movementTime, desiredXdot);
 
     //-- Apply control law to compute robot Cartesian velocity commands.
-    std::vector<double> commandXdot;
-    iCartesianSolver->poseDiff(desiredX, currentX, commandXdot);
+    std::vector<double> & commandXdot = loopCommandXdot;
+    loopPoseDiff(desiredX, currentX, commandXdot);
 
     for (int i = 0; i < 6; i++)
     {
@@ -135,9 +140,9 @@ void roboticslab::BasicCartesianControl::handleMovl(const std::vector<double> &q
     }
 
     //-- Compute joint velocity commands and send to robot.
-    std::vector<double> commandQdot;
+    std::vector<double> & commandQdot = loopCommandQdot;
 
-    if (!iCartesianSolver->diffInvKin(q, commandXdot, commandQdot))
+    if (!loopDiffInvKin(q, currentX, commandXdot, commandQdot, ICartesianSolver::BASE_FRAME))
     {
         CD_WARNING("diffInvKin failed, not updating control this iteration.\n");
         return;
@@ -177,7 +182,7 @@ void roboticslab::BasicCartesianControl::handleMovl(const std::vector<double> &q
 
 void roboticslab::BasicCartesianControl::handleMovv(const std::vector<double> &q)
 {
-    if (!checkControlModes(VOCAB_CM_VELOCITY))
+    if (!checkControlModes(VOCAB_CM_VELOCITY, loopModes))
     {
         CD_ERROR("Not in velocity control mode.\n");
         cmcSuccess = false;
@@ -187,16 +192,17 @@ void roboticslab::BasicCartesianControl::handleMovv(const std::vector<double> &q
 
     double movementTime = yarp::os::Time::now() - movementStartTime;
 
-    std::vector<double> currentX;
+    std::vector<double> & currentX = loopX;
 
-    if (!iCartesianSolver->fwdKin(q, currentX))
+    if (!loopFwdKin(q, currentX))
     {
         CD_WARNING("fwdKin failed, not updating control this iteration.\n");
         return;
     }
 
     //-- Obtain desired Cartesian position and velocity.
-    std::vector<double> desiredX, desiredXdot;
+    std::vector<double> & desiredX = loopXd;
+    std::vector<double> & desiredXdot = loopXdotd;
 
     trajectoryMutex.lock();
     iCartesianTrajectory->getPosition(movementTime, desiredX);
@@ -204,8 +210,8 @@ void roboticslab::BasicCartesianControl::handleMovv(const std::vector<double> &q
     trajectoryMutex.unlock();
 
     //-- Apply control law to compute robot Cartesian velocity commands.
-    std::vector<double> commandXdot;
-    iCartesianSolver->poseDiff(desiredX, currentX, commandXdot);
+    std::vector<double> & commandXdot = loopCommandXdot;
+    loopPoseDiff(desiredX, currentX, commandXdot);
 
     for (int i = 0; i < 6; i++)
     {
@@ -214,9 +220,9 @@ void roboticslab::BasicCartesianControl::handleMovv(const std::vector<double> &q
     }
 
     //-- Compute joint velocity commands and send to robot.
-    std::vector<double> commandQdot;
+    std::vector<double> & commandQdot = loopCommandQdot;
 
-    if (!iCartesianSolver->diffInvKin(q, commandXdot, commandQdot, referenceFrame))
+    if (!loopDiffInvKin(q, currentX, commandXdot, commandQdot, referenceFrame))
     {
         CD_WARNING("diffInvKin failed, not updating control this iteration.\n");
         return;
@@ -256,22 +262,20 @@ void roboticslab::BasicCartesianControl::handleMovv(const std::vector<double> &q
 
 void roboticslab::BasicCartesianControl::handleGcmp(const std::vector<double> &q)
 {
-    if (!checkControlModes(VOCAB_CM_TORQUE))
+    if (!checkControlModes(VOCAB_CM_TORQUE, loopModes))
     {
         CD_ERROR("Not in torque control mode.\n");
         stopControl();
         return;
     }
 
-    std::vector<double> t(numRobotJoints);
-
-    if (!iCartesianSolver->invDyn(q, t))
+    if (!loopInvDyn(q, loopT))
     {
         CD_WARNING("invDyn failed, not updating control this iteration.\n");
         return;
     }
 
-    if (!iTorqueControl->setRefTorques(t.data()))
+    if (!iTorqueControl->setRefTorques(loopT.data()))
     {
         CD_WARNING("setRefTorques failed, not updating control this iteration.\n");
     }
@@ -281,36 +285,126 @@ void roboticslab::BasicCartesianControl::handleGcmp(const std::vector<double> &q
 
 void roboticslab::BasicCartesianControl::handleForc(const std::vector<double> &q)
 {
-    if (!checkControlModes(VOCAB_CM_TORQUE))
+    if (!checkControlModes(VOCAB_CM_TORQUE, loopModes))
     {
         CD_ERROR("Not in torque control mode.\n");
         stopControl();
         return;
     }
 
-    std::vector<double> qdot(numRobotJoints, 0), qdotdot(numRobotJoints, 0);
-    std::vector< std::vector<double> > fexts;
+    if (!loopInvDyn(q, td, loopT))
+    {
+        CD_WARNING("invDyn failed, not updating control this iteration.\n");
+        return;
+    }
 
-    for (int i = 0; i < numRobotJoints - 1; i++)  //-- "numRobotJoints-1" is important
+    if (!iTorqueControl->setRefTorques(loopT.data()))
     {
-        std::vector<double> fext(6, 0);
-        fexts.push_back(fext);
+        CD_WARNING("setRefTorques failed, not updating control this iteration.\n");
     }
+}
 
-    fexts.push_back(td);
+// -----------------------------------------------------------------------------
 
-    std::vector<double> t(numRobotJoints);
+bool roboticslab::BasicCartesianControl::loopFwdKin(const std::vector<double> &q, std::vector<double> &x)
+{
+    if (iCartesianSolverInPlace == NULL)
+    {
+        return iCartesianSolver->fwdKin(q, x);
+    }
 
-    if (!iCartesianSolver->invDyn(q, qdot, qdotdot, fexts, t))
+    for (int i = 0; i < numSolverJoints; i++)
     {
-        CD_WARNING("invDyn failed, not updating control this iteration.\n");
-        return;
+        loopQRad[i] = KinRepresentation::degToRad(q[i]);
     }
 
-    if (!iTorqueControl->setRefTorques(t.data()))
+    return iCartesianSolverInPlace->fwdKinJacInto(loopQRad.data(), x.data(), loopJ.data());
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::BasicCartesianControl::loopPoseDiff(const std::vector<double> &xLhs, const std::vector<double> &xRhs,
+        std::vector<double> &xOut)
+{
+    if (iCartesianSolverInPlace == NULL)
     {
-        CD_WARNING("setRefTorques failed, not updating control this iteration.\n");
+        return iCartesianSolver->poseDiff(xLhs, xRhs, xOut);
+    }
+
+    return iCartesianSolverInPlace->poseDiffInto(xLhs.data(), xRhs.data(), xOut.data());
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::BasicCartesianControl::loopDiffInvKin(const std::vector<double> &q, const std::vector<double> &x,
+        const std::vector<double> &xdot, std::vector<double> &qdot, ICartesianSolver::reference_frame frame)
+{
+    if (iCartesianSolverInPlace == NULL)
+    {
+        return iCartesianSolver->diffInvKin(q, xdot, qdot, frame);
+    }
+
+    //-- Neither FK nor the Jacobian are computed again, see loopFwdKin.
+    if (!iCartesianSolverInPlace->diffInvKinJacInto(x.data(), loopJ.data(), xdot.data(), loopQdotRad.data(), frame))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < numSolverJoints; i++)
+    {
+        qdot[i] = KinRepresentation::radToDeg(loopQdotRad[i]);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::BasicCartesianControl::loopInvDyn(const std::vector<double> &q, std::vector<double> &t)
+{
+    if (iCartesianSolverInPlace == NULL)
+    {
+        return iCartesianSolver->invDyn(q, t);
+    }
+
+    for (int i = 0; i < numSolverJoints; i++)
+    {
+        loopQRad[i] = KinRepresentation::degToRad(q[i]);
+    }
+
+    return iCartesianSolverInPlace->invDynInto(loopQRad.data(), t.data());
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::BasicCartesianControl::loopInvDyn(const std::vector<double> &q, const std::vector<double> &fext,
+        std::vector<double> &t)
+{
+    //-- External force applied on the last segment only, "numRobotJoints-1" is important
+    if (iCartesianSolverInPlace == NULL)
+    {
+        std::vector<double> qdot(numRobotJoints, 0), qdotdot(numRobotJoints, 0);
+        std::vector< std::vector<double> > fexts(numRobotJoints - 1, std::vector<double>(6, 0));
+        fexts.push_back(fext);
+        return iCartesianSolver->invDyn(q, qdot, qdotdot, fexts, t);
     }
+
+    if (fext.size() != 6)
+    {
+        CD_WARNING("Size mismatch; expected: 6, was: %d\n", (int)fext.size());
+        return false;
+    }
+
+    for (int i = 0; i < numSolverJoints; i++)
+    {
+        loopQRad[i] = KinRepresentation::degToRad(q[i]);
+    }
+
+    std::copy(fext.begin(), fext.end(), loopFexts.end() - 6);
+
+    // Null joint velocities and accelerations, this array is never written to.
+    return iCartesianSolverInPlace->invDynInto(loopQRad.data(), loopQdotdotRad.data(), loopQdotdotRad.data(),
+            loopFexts.data(), numRobotJoints, t.data());
 }
 
 // -----------------------------------------------------------------------------
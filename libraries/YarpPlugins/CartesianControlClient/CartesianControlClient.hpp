@@ -66,6 +66,10 @@ public:
 
     virtual bool inv(const std::vector<double> &xd, std::vector<double> &q);
 
+    virtual bool fwdBatch(const std::vector<double> &qs, std::vector<double> &xs);
+
+    virtual bool invBatch(const std::vector<double> &xds, std::vector<double> &qs);
+
     virtual bool movj(const std::vector<double> &xd);
 
     virtual bool relj(const std::vector<double> &xd);
@@ -128,6 +132,7 @@ protected:
     bool handleRpcRunnableCmd(int vocab);
     bool handleRpcConsumerCmd(int vocab, const std::vector<double>& in);
     bool handleRpcFunctionCmd(int vocab, const std::vector<double>& in, std::vector<double>& out);
+    bool handleRpcBatchCmd(yarp::os::Bottle& cmd, const std::vector<double>& in, std::vector<double>& out);
 
     void handleStreamingConsumerCmd(int vocab, const std::vector<double>& in);
     void handleStreamingBiConsumerCmd(int vocab, const std::vector<double>& in1, double in2);
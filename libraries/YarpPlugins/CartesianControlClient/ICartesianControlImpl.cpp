@@ -2,6 +2,8 @@
 
 #include "CartesianControlClient.hpp"
 
+#include <cmath>
+
 #include <yarp/os/Time.h>
 
 #include <ColorDebug.h>
@@ -101,6 +103,38 @@ bool roboticslab::CartesianControlClient::handleRpcFunctionCmd(int vocab, const
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::CartesianControlClient::handleRpcBatchCmd(yarp::os::Bottle& cmd, const std::vector<double>& in, std::vector<double>& out)
+{
+    yarp::os::Bottle response;
+
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        cmd.addFloat64(in[i]);
+    }
+
+    rpcClient.write(cmd, response);
+
+    if (!checkSuccess(response))
+    {
+        return false;
+    }
+
+    // Entries that failed on the remote side are filled with NaN.
+    bool allValid = true;
+
+    out.resize(response.size());
+
+    for (size_t i = 0; i < response.size(); i++)
+    {
+        out[i] = response.get(i).asFloat64();
+        allValid = allValid && !std::isnan(out[i]);
+    }
+
+    return allValid;
+}
+
+// -----------------------------------------------------------------------------
+
 void roboticslab::CartesianControlClient::handleStreamingConsumerCmd(int vocab, const std::vector<double>& in)
 {
     yarp::os::Bottle& cmd = commandPort.prepare();
@@ -190,6 +224,32 @@ bool roboticslab::CartesianControlClient::inv(const std::vector<double> &xd, std
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::CartesianControlClient::fwdBatch(const std::vector<double> &qs, std::vector<double> &xs)
+{
+    yarp::os::Bottle cmd;
+    cmd.addVocab(VOCAB_CC_FWD_BATCH);
+    return handleRpcBatchCmd(cmd, qs, xs);
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::CartesianControlClient::invBatch(const std::vector<double> &xds, std::vector<double> &qs)
+{
+    // The server splits the poses by count, a trailing partial pose would be silently dropped.
+    if (xds.size() % 6 != 0)
+    {
+        CD_ERROR("Batch size mismatch: %d is not a multiple of %d.\n", (int)xds.size(), 6);
+        return false;
+    }
+
+    yarp::os::Bottle cmd;
+    cmd.addVocab(VOCAB_CC_INV_BATCH);
+    cmd.addInt32(xds.size() / 6);
+    return handleRpcBatchCmd(cmd, xds, qs);
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::CartesianControlClient::movj(const std::vector<double> &xd)
 {
     return handleRpcConsumerCmd(VOCAB_CC_MOVJ, xd);
@@ -131,6 +131,8 @@ protected:
     bool handleStatMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out);
     bool handleWaitMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out);
     bool handleActMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out);
+    bool handleFwdBatchMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out);
+    bool handleInvBatchMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out);
 
     bool handleRunnableCmdMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out, RunnableFun cmd);
     bool handleConsumerCmdMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out, ConsumerFun cmd);
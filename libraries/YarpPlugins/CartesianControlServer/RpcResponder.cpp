@@ -56,6 +56,10 @@ bool roboticslab::RpcResponder::respond(const yarp::os::Bottle& in, yarp::os::Bo
         return handleStatMsg(in, out);
     case VOCAB_CC_INV:
         return handleFunctionCmdMsg(in, out, &ICartesianControl::inv);
+    case VOCAB_CC_FWD_BATCH:
+        return handleFwdBatchMsg(in, out);
+    case VOCAB_CC_INV_BATCH:
+        return handleInvBatchMsg(in, out);
     case VOCAB_CC_MOVJ:
         return handleConsumerCmdMsg(in, out, &ICartesianControl::movj);
     case VOCAB_CC_RELJ:
@@ -99,6 +103,14 @@ void roboticslab::RpcResponder::makeUsage()
     addUsage(ss.str().c_str(), "accept desired position in cartesian space, return result in joint space");
     ss.str("");
 
+    ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_FWD_BATCH) << "] q1_1 q1_2 ... qN_1 qN_2 ...";
+    addUsage(ss.str().c_str(), "accept N concatenated positions in joint space, return results in cartesian space (NaN on failure)");
+    ss.str("");
+
+    ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_INV_BATCH) << "] N coord1_1 coord1_2 ... coordN_1 coordN_2 ...";
+    addUsage(ss.str().c_str(), "accept N concatenated positions in cartesian space, return results in joint space (NaN on failure)");
+    ss.str("");
+
     ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_MOVJ) << "] coord1 coord2 ...";
     addUsage(ss.str().c_str(), "joint move to desired position (absolute coordinates in cartesian space)");
     ss.str("");
@@ -283,6 +295,109 @@ bool roboticslab::RpcResponder::handleActMsg(const yarp::os::Bottle& in, yarp::o
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::RpcResponder::handleFwdBatchMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out)
+{
+    if (in.size() > 1)
+    {
+        std::vector<double> qs, xs;
+
+        for (size_t i = 1; i < in.size(); i++)
+        {
+            qs.push_back(in.get(i).asFloat64());
+        }
+
+        // Partial failures are still replied to, failed entries are NaN.
+        bool res = iCartesianControl->fwdBatch(qs, xs);
+
+        if ((!res && xs.empty()) || xs.size() % 6 != 0)
+        {
+            out.addVocab(VOCAB_CC_FAILED);
+            return false;
+        }
+
+        for (size_t i = 0; i < xs.size(); i += 6)
+        {
+            std::vector<double> x(xs.begin() + i, xs.begin() + i + 6);
+
+            if (!transformOutgoingData(x))
+            {
+                out.clear();
+                out.addVocab(VOCAB_CC_FAILED);
+                return false;
+            }
+
+            for (size_t j = 0; j < x.size(); j++)
+            {
+                out.addFloat64(x[j]);
+            }
+        }
+
+        return res;
+    }
+    else
+    {
+        CD_ERROR("size error\n");
+        out.addVocab(VOCAB_CC_FAILED);
+        return false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RpcResponder::handleInvBatchMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out)
+{
+    int count = in.size() > 2 ? in.get(1).asInt32() : 0;
+
+    if (count > 0 && (in.size() - 2) % count == 0)
+    {
+        // Each pose may take any number of coordinates, as long as all of them are alike.
+        int width = (in.size() - 2) / count;
+        std::vector<double> xds, qs;
+
+        for (int i = 0; i < count; i++)
+        {
+            std::vector<double> xd;
+
+            for (int j = 0; j < width; j++)
+            {
+                xd.push_back(in.get(2 + i * width + j).asFloat64());
+            }
+
+            if (!transformIncomingData(xd))
+            {
+                out.addVocab(VOCAB_CC_FAILED);
+                return false;
+            }
+
+            xds.insert(xds.end(), xd.begin(), xd.end());
+        }
+
+        // Partial failures are still replied to, failed entries are NaN.
+        bool res = iCartesianControl->invBatch(xds, qs);
+
+        if (!res && qs.empty())
+        {
+            out.addVocab(VOCAB_CC_FAILED);
+            return false;
+        }
+
+        for (size_t i = 0; i < qs.size(); i++)
+        {
+            out.addFloat64(qs[i]);
+        }
+
+        return res;
+    }
+    else
+    {
+        CD_ERROR("size error\n");
+        out.addVocab(VOCAB_CC_FAILED);
+        return false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::RpcResponder::handleRunnableCmdMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out, RunnableFun cmd)
 {
     if ((iCartesianControl->*cmd)())
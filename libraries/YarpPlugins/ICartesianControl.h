@@ -52,6 +52,8 @@
 // RPC commands
 #define VOCAB_CC_STAT ROBOTICSLAB_VOCAB('s','t','a','t') ///< Current state and position
 #define VOCAB_CC_INV ROBOTICSLAB_VOCAB('i','n','v',0)    ///< Inverse kinematics
+#define VOCAB_CC_FWD_BATCH ROBOTICSLAB_VOCAB('f','w','d','b') ///< Forward kinematics, batch of joint positions
+#define VOCAB_CC_INV_BATCH ROBOTICSLAB_VOCAB('i','n','v','b') ///< Inverse kinematics, batch of poses
 #define VOCAB_CC_MOVJ ROBOTICSLAB_VOCAB('m','o','v','j') ///< Move in joint space, absolute coordinates
 #define VOCAB_CC_RELJ ROBOTICSLAB_VOCAB('r','e','l','j') ///< Move in joint space, relative coordinates
 #define VOCAB_CC_MOVL ROBOTICSLAB_VOCAB('m','o','v','l') ///< Linear move to target position
@@ -186,6 +188,37 @@ class ICartesianControl
          */
         virtual bool inv(const std::vector<double> &xd, std::vector<double> &q) = 0;
 
+        /**
+         * @brief Forward kinematics, batch of joint positions
+         *
+         * Perform forward kinematics on several joint positions at once, but do not move.
+         * Entries that could not be solved are filled with NaN.
+         *
+         * @param qs Concatenation of N vectors describing positions in joint space (meters or degrees).
+         * @param xs Concatenation of N 6-element vectors describing same positions in cartesian
+         * space; first three elements denote translation (meters), last three denote rotation
+         * in scaled axis-angle representation (radians).
+         *
+         * @return true if all entries succeeded, false otherwise
+         */
+        virtual bool fwdBatch(const std::vector<double> &qs, std::vector<double> &xs) = 0;
+
+        /**
+         * @brief Inverse kinematics, batch of poses
+         *
+         * Perform inverse kinematics on several poses at once (using robot position as initial
+         * guess for all of them), but do not move. Entries that could not be solved are filled
+         * with NaN.
+         *
+         * @param xds Concatenation of N 6-element vectors describing desired positions in cartesian
+         * space; first three elements denote translation (meters), last three denote rotation in
+         * scaled axis-angle representation (radians).
+         * @param qs Concatenation of N vectors describing target positions in joint space (meters or degrees).
+         *
+         * @return true if all entries succeeded, false otherwise
+         */
+        virtual bool invBatch(const std::vector<double> &xds, std::vector<double> &qs) = 0;
+
         /**
          * @brief Move in joint space, absolute coordinates
          *
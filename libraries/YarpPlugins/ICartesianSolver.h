@@ -129,6 +129,29 @@ class ICartesianSolver
         virtual bool invKin(const std::vector<double> &xd, const std::vector<double> &qGuess, std::vector<double> &q,
                 const reference_frame frame = BASE_FRAME) = 0;
 
+        /**
+         * @brief Perform inverse kinematics within a time budget
+         *
+         * Iterative solvers stop as soon as the budget is exhausted and return the best
+         * solution found so far, which is not necessarily exact; check @p residual.
+         * Closed-form solvers ignore the budget.
+         *
+         * @param xd 6-element vector describing desired position in cartesian space, as
+         * in @ref invKin.
+         * @param qGuess Vector describing current position in joint space (meters or degrees).
+         * @param budget Time budget (seconds), non-positive values mean no limit.
+         * @param q Vector describing the best target position found in joint space (meters
+         * or degrees).
+         * @param residual Norm of the displacement twist between @p xd and the pose achieved
+         * by @p q (meters and radians).
+         * @param frame Points at the @ref reference_frame the desired position is expressed in.
+         *
+         * @return true on success, false otherwise (i.e. the solver gave up before the
+         * budget was exhausted)
+         */
+        virtual bool invKinBudget(const std::vector<double> &xd, const std::vector<double> &qGuess, double budget,
+                std::vector<double> &q, double &residual, const reference_frame frame = BASE_FRAME) = 0;
+
         /**
          * @brief Perform differential inverse kinematics
          *
@@ -175,6 +198,59 @@ class ICartesianSolver
          */
         virtual bool invDyn(const std::vector<double> &q,const std::vector<double> &qdot, const std::vector<double> &qdotdot, const std::vector< std::vector<double> > &fexts, std::vector<double> &t) = 0;
 
+        /**
+         * @brief Perform forward kinematics on a batch of joint positions
+         *
+         * Entries that could not be solved are filled with NaN, the remaining ones
+         * are still computed.
+         *
+         * @param qs Concatenation of N vectors describing positions in joint space
+         * (meters or degrees), see @ref getNumJoints.
+         * @param xs Concatenation of N 6-element vectors describing same positions in
+         * cartesian space, as in @ref fwdKin.
+         *
+         * @return true if all entries succeeded, false otherwise
+         */
+        virtual bool fwdKinBatch(const std::vector<double> &qs, std::vector<double> &xs) = 0;
+
+        /**
+         * @brief Perform inverse kinematics on a batch of poses
+         *
+         * Entries that could not be solved are filled with NaN, the remaining ones
+         * are still computed.
+         *
+         * @param xds Concatenation of N 6-element vectors describing desired positions in
+         * cartesian space, as in @ref invKin.
+         * @param qGuess Vector describing an initial guess in joint space (meters or degrees),
+         * either shared by all entries or the concatenation of N such vectors.
+         * @param qs Concatenation of N vectors describing target positions in joint space
+         * (meters or degrees).
+         * @param frame Points at the @ref reference_frame the desired positions are expressed in.
+         *
+         * @return true if all entries succeeded, false otherwise
+         */
+        virtual bool invKinBatch(const std::vector<double> &xds, const std::vector<double> &qGuess, std::vector<double> &qs,
+                const reference_frame frame = BASE_FRAME) = 0;
+
+        /**
+         * @brief Perform differential inverse kinematics on a batch of joint positions
+         *
+         * Entries that could not be solved are filled with NaN, the remaining ones
+         * are still computed.
+         *
+         * @param qs Concatenation of N vectors describing current positions in joint space
+         * (meters or degrees).
+         * @param xdots Concatenation of N 6-element vectors describing desired velocities in
+         * cartesian space, as in @ref diffInvKin.
+         * @param qdots Concatenation of N vectors describing target velocities in joint space
+         * (meters/second or degrees/second).
+         * @param frame Points at the @ref reference_frame the desired velocities are expressed in.
+         *
+         * @return true if all entries succeeded, false otherwise
+         */
+        virtual bool diffInvKinBatch(const std::vector<double> &qs, const std::vector<double> &xdots, std::vector<double> &qdots,
+                const reference_frame frame = BASE_FRAME) = 0;
+
 };
 
 }  // namespace roboticslab
@@ -0,0 +1,161 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __I_CARTESIAN_SOLVER_IN_PLACE__
+#define __I_CARTESIAN_SOLVER_IN_PLACE__
+
+#include "ICartesianSolver.h"
+
+/**
+ * @file
+ * @brief Contains roboticslab::ICartesianSolverInPlace
+ * @ingroup YarpPlugins
+ * @{
+ */
+
+namespace roboticslab
+{
+
+/**
+ * @brief Allocation-free extension of a cartesian solver.
+ *
+ * Counterpart of the most frequent @ref ICartesianSolver queries meant for control
+ * loops. All results are written into caller-provided storage, which must hold as
+ * many elements as joints the solver has been configured for (see
+ * ICartesianSolver::getNumJoints), or six for cartesian quantities. Joint-space
+ * quantities are expressed in radians or meters, as opposed to ICartesianSolver.
+ * Cartesian quantities follow the same conventions as in ICartesianSolver.
+ *
+ * Control loops that need both the current pose and joint velocities may obtain
+ * the former along with the Jacobian through fwdKinJacInto, then feed both to
+ * diffInvKinJacInto, so that the chain is traversed only once per cycle.
+ */
+class ICartesianSolverInPlace
+{
+    public:
+
+        //! Destructor
+        virtual ~ICartesianSolverInPlace() {}
+
+        /**
+         * @brief Perform forward kinematics
+         *
+         * @param q Array describing a position in joint space (meters or radians).
+         * @param x 6-element output array describing same position in cartesian space.
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool fwdKinInto(const double * q, double * x) = 0;
+
+        /**
+         * @brief Obtain difference between supplied pose inputs
+         *
+         * @param xLhs 6-element array describing a pose in cartesian space (left hand side).
+         * @param xRhs 6-element array describing a pose in cartesian space (right hand side).
+         * @param xOut 6-element output array describing the resulting displacement twist.
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool poseDiffInto(const double * xLhs, const double * xRhs, double * xOut) = 0;
+
+        /**
+         * @brief Perform forward kinematics and compute the Jacobian
+         *
+         * @param q Array describing a position in joint space (meters or radians).
+         * @param x 6-element output array describing same position in cartesian space.
+         * @param J Output array of 6 * N elements (N joints) that stores the geometric Jacobian
+         * in column-major order, expressed in the base frame and referred to the end-effector.
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool fwdKinJacInto(const double * q, double * x, double * J) = 0;
+
+        /**
+         * @brief Perform inverse kinematics
+         *
+         * @param xd 6-element array describing desired position in cartesian space.
+         * @param qGuess Array describing current position in joint space (meters or radians).
+         * @param q Output array describing target position in joint space (meters or radians).
+         * @param frame Points at the @ref ICartesianSolver::reference_frame the desired position is expressed in.
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool invKinInto(const double * xd, const double * qGuess, double * q,
+                const ICartesianSolver::reference_frame frame = ICartesianSolver::BASE_FRAME) = 0;
+
+        /**
+         * @brief Perform differential inverse kinematics
+         *
+         * @param q Array describing current position in joint space (meters or radians).
+         * @param xdot 6-element array describing desired velocity in cartesian space.
+         * @param qdot Output array describing target velocity in joint space (meters/second or radians/second).
+         * @param frame Points at the @ref ICartesianSolver::reference_frame the desired velocity is expressed in.
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool diffInvKinInto(const double * q, const double * xdot, double * qdot,
+                const ICartesianSolver::reference_frame frame = ICartesianSolver::BASE_FRAME) = 0;
+
+        /**
+         * @brief Perform differential inverse kinematics given a precomputed Jacobian
+         *
+         * @param x 6-element array describing current position in cartesian space, as
+         * obtained from @ref fwdKinJacInto.
+         * @param J Array of 6 * N elements describing the Jacobian at the same position, as
+         * obtained from @ref fwdKinJacInto.
+         * @param xdot 6-element array describing desired velocity in cartesian space.
+         * @param qdot Output array describing target velocity in joint space (meters/second or radians/second).
+         * @param frame Points at the @ref ICartesianSolver::reference_frame the desired velocity is expressed in.
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool diffInvKinJacInto(const double * x, const double * J, const double * xdot, double * qdot,
+                const ICartesianSolver::reference_frame frame = ICartesianSolver::BASE_FRAME) = 0;
+
+        /**
+         * @brief Perform inverse dynamics
+         *
+         * Assumes null joint velocities and accelerations, and no external forces.
+         *
+         * @param q Array describing current position in joint space (meters or radians).
+         * @param t Output array of joint torques or forces (newton-meters or newtons).
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool invDynInto(const double * q, double * t) = 0;
+
+        /**
+         * @brief Perform inverse dynamics
+         *
+         * @param q Array describing current position in joint space (meters or radians).
+         * @param qdot Array describing current velocity in joint space (meters/second or radians/second).
+         * @param qdotdot Array describing current acceleration in joint space (meters/second² or radians/second²).
+         * @param fexts Array of external wrenches applied to the first @p numFexts robot segments,
+         * six consecutive elements each (force, then torque), expressed in cartesian space.
+         * @param numFexts Number of external wrenches.
+         * @param t Output array of joint torques or forces (newton-meters or newtons).
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool invDynInto(const double * q, const double * qdot, const double * qdotdot,
+                const double * fexts, int numFexts, double * t) = 0;
+
+        /**
+         * @brief Obtain the counters of the IK result cache, if any
+         *
+         * Lookups are performed by invKinInto and the rest of IK queries, the counters
+         * accumulate since the solver was opened.
+         *
+         * @param hits Output number of lookups that found a cached result.
+         * @param misses Output number of lookups that did not.
+         *
+         * @return true on success, false if the solver has no such cache
+         */
+        virtual bool getIkResultCacheStats(unsigned long * hits, unsigned long * misses)
+        { return false; }
+};
+
+}  // namespace roboticslab
+
+/** @} */
+
+#endif  //  __I_CARTESIAN_SOLVER_IN_PLACE__
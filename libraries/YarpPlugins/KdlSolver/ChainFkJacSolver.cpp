@@ -0,0 +1,70 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "ChainFkJacSolver.hpp"
+
+#include <kdl/joint.hpp>
+#include <kdl/segment.hpp>
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+ChainFkJacSolver::ChainFkJacSolver(const KDL::Chain & _chain)
+    : chain(_chain),
+      tips(chain.getNrOfJoints())
+{}
+
+// -----------------------------------------------------------------------------
+
+int ChainFkJacSolver::JntToCartJac(const KDL::JntArray & q_in, KDL::Frame & p_out, KDL::Jacobian & jac)
+{
+    if (tips.size() != chain.getNrOfJoints())
+    {
+        return (error = E_NOT_UP_TO_DATE);
+    }
+
+    if (q_in.rows() != tips.size() || jac.columns() != tips.size())
+    {
+        return (error = E_SIZE_MISMATCH);
+    }
+
+    KDL::Frame H;
+    int j = 0;
+
+    for (int i = 0; i < chain.getNrOfSegments(); i++)
+    {
+        const KDL::Segment & segment = chain.getSegment(i);
+
+        if (segment.getJoint().getType() != KDL::Joint::None)
+        {
+            // Unit twist of this joint, referred to the tip of its segment.
+            jac.setColumn(j, H.M * segment.twist(q_in(j), 1.0));
+            H = H * segment.pose(q_in(j));
+            tips[j] = H.p;
+            j++;
+        }
+        else
+        {
+            H = H * segment.pose(0.0);
+        }
+    }
+
+    // Once the end-effector position is known, move all reference points there at once.
+    for (j = 0; j < tips.size(); j++)
+    {
+        jac.setColumn(j, jac.getColumn(j).RefPoint(H.p - tips[j]));
+    }
+
+    p_out = H;
+
+    return (error = E_NOERROR);
+}
+
+// -----------------------------------------------------------------------------
+
+void ChainFkJacSolver::updateInternalDataStructures()
+{
+    tips.resize(chain.getNrOfJoints());
+}
+
+// -----------------------------------------------------------------------------
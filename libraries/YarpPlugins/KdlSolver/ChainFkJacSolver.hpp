@@ -0,0 +1,67 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __CHAIN_FK_JAC_SOLVER_HPP__
+#define __CHAIN_FK_JAC_SOLVER_HPP__
+
+#include <vector>
+
+#include <kdl/chain.hpp>
+#include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/solveri.hpp>
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup KdlSolver
+ * @brief Combined FK and Jacobian solver.
+ *
+ * Obtains the end-effector pose and the geometric Jacobian in a single recursive
+ * pass over the chain, as opposed to KDL::ChainFkSolverPos_recursive followed by
+ * KDL::ChainJntToJacSolver. The Jacobian is expressed in the base frame and refers
+ * to the end-effector position, same as KDL::ChainJntToJacSolver does.
+ */
+class ChainFkJacSolver : public KDL::SolverI
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param chain The chain to calculate the pose and Jacobian for.
+     */
+    explicit ChainFkJacSolver(const KDL::Chain & chain);
+
+    /**
+     * @brief Perform FK and compute the Jacobian
+     *
+     * @param q_in Input joint coordinates.
+     * @param p_out Reference to output cartesian pose.
+     * @param jac Reference to output Jacobian, must be sized as the number of joints.
+     *
+     * @return Return code, < 0 if something went wrong.
+     */
+    int JntToCartJac(const KDL::JntArray & q_in, KDL::Frame & p_out, KDL::Jacobian & jac);
+
+    /**
+     * @brief Update the internal data structures.
+     *
+     * Update the internal data structures. This is required if the number of segments
+     * or number of joints of a chain has changed. This provides a single point of contact
+     * for solver memory allocations.
+     */
+    virtual void updateInternalDataStructures();
+
+private:
+
+    const KDL::Chain & chain;
+
+    //! Position of each joint's segment tip, reference point of its Jacobian column during the pass.
+    std::vector<KDL::Vector> tips;
+};
+
+}  // namespace roboticslab
+
+#endif  // __CHAIN_FK_JAC_SOLVER_HPP__
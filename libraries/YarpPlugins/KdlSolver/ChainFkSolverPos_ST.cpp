@@ -2,29 +2,49 @@
 
 #include "ChainFkSolverPos_ST.hpp"
 
+#include <kdl/joint.hpp>
+#include <kdl/segment.hpp>
+
 using namespace roboticslab;
 
 // -----------------------------------------------------------------------------
 
 ChainFkSolverPos_ST::ChainFkSolverPos_ST(const KDL::Chain & _chain)
     : chain(_chain),
-      poe(PoeExpression::fromChain(chain))
-{}
+      evaluator(PoeExpression::fromChain(chain))
+{
+    updateSegments();
+}
 
 // -----------------------------------------------------------------------------
 
 int ChainFkSolverPos_ST::JntToCart(const KDL::JntArray & q_in, KDL::Frame & p_out, int segmentNr)
 {
-    if (segmentNr >= 0)
+    if (segmentNr > (int)chain.getNrOfSegments())
     {
-        return (error = E_OPERATION_NOT_SUPPORTED);
+        return (error = E_OUT_OF_RANGE);
     }
 
-    if (!poe.evaluate(q_in, p_out))
+    KDL::Frame H;
+
+    if (!evaluator.evaluate(q_in, H))
     {
         return (error = E_ILLEGAL_ARGUMENT_SIZE);
     }
 
+    if (segmentNr < 0)
+    {
+        p_out = H;
+    }
+    else if (segmentNr == 0)
+    {
+        p_out = KDL::Frame::Identity();
+    }
+    else
+    {
+        p_out = getSegmentFrame(segmentNr - 1);
+    }
+
     return (error = E_NOERROR);
 }
 
@@ -32,14 +52,83 @@ int ChainFkSolverPos_ST::JntToCart(const KDL::JntArray & q_in, KDL::Frame & p_ou
 
 int ChainFkSolverPos_ST::JntToCart(const KDL::JntArray & q_in, std::vector<KDL::Frame> & p_out, int segmentNr)
 {
-    return (error = E_OPERATION_NOT_SUPPORTED);
+    if (segmentNr < 0)
+    {
+        segmentNr = chain.getNrOfSegments();
+    }
+
+    if (segmentNr > (int)chain.getNrOfSegments())
+    {
+        return (error = E_OUT_OF_RANGE);
+    }
+
+    if (p_out.size() != segmentNr)
+    {
+        return (error = E_ILLEGAL_ARGUMENT_SIZE);
+    }
+
+    KDL::Frame H;
+
+    if (!evaluator.evaluate(q_in, H))
+    {
+        return (error = E_ILLEGAL_ARGUMENT_SIZE);
+    }
+
+    for (int i = 0; i < segmentNr; i++)
+    {
+        p_out[i] = getSegmentFrame(i);
+    }
+
+    return (error = E_NOERROR);
 }
 
 // -----------------------------------------------------------------------------
 
 void ChainFkSolverPos_ST::updateInternalDataStructures()
 {
-    poe = PoeExpression::fromChain(chain);
+    evaluator = PoeEvaluator(PoeExpression::fromChain(chain));
+    updateSegments();
+}
+
+// -----------------------------------------------------------------------------
+
+void ChainFkSolverPos_ST::updateSegments()
+{
+    segmentFrames.resize(chain.getNrOfSegments());
+    segmentJoints.resize(chain.getNrOfSegments());
+
+    KDL::Frame H_S_prev;
+    int joints = 0;
+
+    for (int i = 0; i < chain.getNrOfSegments(); i++)
+    {
+        const KDL::Segment & segment = chain.getSegment(i);
+
+        if (segment.getJoint().getType() != KDL::Joint::None)
+        {
+            joints++;
+        }
+
+        H_S_prev = H_S_prev * segment.pose(0);
+
+        segmentFrames[i] = H_S_prev;
+        segmentJoints[i] = joints;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+KDL::Frame ChainFkSolverPos_ST::getSegmentFrame(int i) const
+{
+    int joints = segmentJoints[i];
+
+    if (joints == 0)
+    {
+        return segmentFrames[i];
+    }
+
+    // Link poses follow from the zero configuration, see PoeEvaluator::getPrefix.
+    return evaluator.getPrefix(joints - 1) * segmentFrames[i];
 }
 
 // -----------------------------------------------------------------------------
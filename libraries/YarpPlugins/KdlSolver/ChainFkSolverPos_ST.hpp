@@ -15,8 +15,9 @@ namespace roboticslab
  * @brief FK solver using Screw Theory.
  *
  * Implementation of a forward position kinematics algorithm. This is a thin wrapper
- * around \ref PoeExpression. Methods that retrieve resulting frames for intermediate
- * links are not supported.
+ * around \ref PoeEvaluator, hence only POE terms whose joint value has changed since
+ * the previous call are evaluated. Frames of intermediate segments are obtained from
+ * the cached prefix products at no extra cost.
  */
 class ChainFkSolverPos_ST : public KDL::ChainFkSolverPos
 {
@@ -27,22 +28,21 @@ public:
      *
      * @param q_in Input joint coordinates.
      * @param p_out Reference to output cartesian pose.
-     * @param segmentNr Desired segment frame (unsupported).
+     * @param segmentNr Desired segment frame, use a negative value for the last one.
      *
      * @return Return code, < 0 if something went wrong.
      */
     virtual int JntToCart(const KDL::JntArray & q_in, KDL::Frame & p_out, int segmentNr = -1);
 
     /**
-     * @brief Perform FK on the selected segments (unsupported)
+     * @brief Perform FK on the selected segments
      *
      * @param q_in Input joint coordinates.
-     * @param p_out Reference to a vector of output cartesian poses for all segments.
-     * @param segmentNr Last selected segment frame.
+     * @param p_out Reference to a vector of output cartesian poses for all segments,
+     * must be sized as the number of selected segments.
+     * @param segmentNr Last selected segment frame, use a negative value for all of them.
      *
      * @return Return code, < 0 if something went wrong.
-     *
-     * @warning Unsupported, will return @ref E_OPERATION_NOT_SUPPORTED.
      */
     virtual int JntToCart(const KDL::JntArray & q_in, std::vector<KDL::Frame> & p_out, int segmentNr = -1);
 
@@ -84,9 +84,19 @@ private:
 
     ChainFkSolverPos_ST(const KDL::Chain & chain);
 
+    void updateSegments();
+
+    KDL::Frame getSegmentFrame(int i) const;
+
     const KDL::Chain & chain;
 
-    PoeExpression poe;
+    PoeEvaluator evaluator;
+
+    //! Pose of each segment at the zero configuration.
+    std::vector<KDL::Frame> segmentFrames;
+
+    //! Number of joints up to and including each segment.
+    std::vector<int> segmentJoints;
 };
 
 }  // namespace roboticslab
@@ -0,0 +1,160 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "ChainIkSolverPos_Anytime.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    // Consecutive bursts without improving the residual before giving up.
+    const int MAX_STALLED_BURSTS = 3;
+}
+
+// -----------------------------------------------------------------------------
+
+ChainIkSolverPos_Anytime::ChainIkSolverPos_Anytime(const KDL::Chain & _chain, KDL::ChainIkSolverPos & _stepSolver,
+        KDL::ChainFkSolverPos & _fkSolver, int _maxBursts)
+    : chain(_chain),
+      stepSolver(_stepSolver),
+      fkSolver(_fkSolver),
+      maxBursts(_maxBursts),
+      budget(0.0),
+      cancel(NULL),
+      residual(std::numeric_limits<double>::infinity()),
+      qSeed(chain.getNrOfJoints()),
+      qStep(chain.getNrOfJoints())
+{}
+
+// -----------------------------------------------------------------------------
+
+int ChainIkSolverPos_Anytime::CartToJnt(const KDL::JntArray & q_init, const KDL::Frame & p_in, KDL::JntArray & q_out)
+{
+    if (qSeed.rows() != chain.getNrOfJoints())
+    {
+        return (error = E_NOT_UP_TO_DATE);
+    }
+
+    if (q_init.rows() != qSeed.rows() || q_out.rows() != qSeed.rows())
+    {
+        return (error = E_SIZE_MISMATCH);
+    }
+
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(budget));
+
+    //-- The initial guess is a valid (if poor) answer, too.
+    q_out = q_init;
+    qSeed = q_init;
+
+    if (!evaluate(q_out, p_in, residual))
+    {
+        return (error = E_FKSOLVERPOS_FAILED);
+    }
+
+    int stalled = 0;
+
+    for (int bursts = 1; ; bursts++)
+    {
+        int ret = stepSolver.CartToJnt(qSeed, p_in, qStep);
+
+        if (ret == E_NOT_UP_TO_DATE || ret == E_SIZE_MISMATCH)
+        {
+            return (error = ret);
+        }
+
+        double r;
+
+        if (!evaluate(qStep, p_in, r))
+        {
+            return (error = E_FKSOLVERPOS_FAILED);
+        }
+
+        if (ret == E_NOERROR)
+        {
+            q_out = qStep;
+            residual = r;
+            return (error = E_NOERROR);
+        }
+
+        //-- Keep the best solution, but let the solver follow its own path.
+        if (r < residual)
+        {
+            q_out = qStep;
+            residual = r;
+            stalled = 0;
+        }
+        else if (++stalled >= MAX_STALLED_BURSTS)
+        {
+            return (error = E_NO_PROGRESS);
+        }
+
+        if (maxBursts > 0 && bursts >= maxBursts)
+        {
+            return (error = E_MAX_ITERATIONS_EXCEEDED);
+        }
+
+        if (budget > 0.0 && std::chrono::steady_clock::now() >= deadline)
+        {
+            return (error = E_DEADLINE_EXPIRED);
+        }
+
+        if (cancel != NULL && *cancel)
+        {
+            return (error = E_CANCELED);
+        }
+
+        qSeed = qStep;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool ChainIkSolverPos_Anytime::evaluate(const KDL::JntArray & q, const KDL::Frame & p_in, double & r)
+{
+    KDL::Frame f;
+
+    if (fkSolver.JntToCart(q, f) < 0)
+    {
+        return false;
+    }
+
+    KDL::Twist delta = KDL::diff(f, p_in);
+    r = std::sqrt(KDL::dot(delta.vel, delta.vel) + KDL::dot(delta.rot, delta.rot));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void ChainIkSolverPos_Anytime::updateInternalDataStructures()
+{
+    qSeed.resize(chain.getNrOfJoints());
+    qStep.resize(chain.getNrOfJoints());
+}
+
+// -----------------------------------------------------------------------------
+
+const char * ChainIkSolverPos_Anytime::strError(const int error) const
+{
+    switch (error)
+    {
+    case E_DEADLINE_EXPIRED:
+        return "Deadline expired, returned the best solution found";
+    case E_CANCELED:
+        return "Canceled, returned the best solution found";
+    case E_NO_PROGRESS:
+        return "No further progress, returned the best solution found";
+    case E_FKSOLVERPOS_FAILED:
+        return "Internal FK position solver failed";
+    default:
+        return stepSolver.strError(error);
+    }
+}
+
+// -----------------------------------------------------------------------------
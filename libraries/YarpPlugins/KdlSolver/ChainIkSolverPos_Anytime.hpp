@@ -0,0 +1,137 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __CHAIN_IK_SOLVER_POS_ANYTIME_HPP__
+#define __CHAIN_IK_SOLVER_POS_ANYTIME_HPP__
+
+#include <atomic>
+
+#include <kdl/chain.hpp>
+#include <kdl/chainfksolver.hpp>
+#include <kdl/chainiksolver.hpp>
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup KdlSolver
+ * @brief Deadline-bounded wrapper of an iterative IK solver.
+ *
+ * Runs the wrapped solver in short bursts of iterations (as many as it has been
+ * configured for), each one seeded with the outcome of the previous burst. The
+ * deadline is checked in between, and the best solution found so far is returned
+ * as soon as it expires. Same for the case in which several bursts in a row do not
+ * improve the residual, i.e. the solver is stuck. Note the residual is not weighted,
+ * unlike the objective of e.g. KDL::ChainIkSolverPos_LMA, hence a single burst that
+ * makes it worse is tolerated. Callers racing several instances may also
+ * cancel the rest through a shared flag, checked at the same points. The number
+ * of bursts may be capped, too, so that the overall count of iterations does not
+ * exceed that of a single call to a regular (non-anytime) solver.
+ */
+class ChainIkSolverPos_Anytime : public KDL::ChainIkSolverPos
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param chain The chain to calculate the inverse position for.
+     * @param stepSolver Iterative IK solver that performs a few iterations per call.
+     * @param fkSolver FK solver used to evaluate the residual.
+     * @param maxBursts Maximum number of calls to @p stepSolver per call to CartToJnt,
+     * zero or less for no limit.
+     */
+    ChainIkSolverPos_Anytime(const KDL::Chain & chain, KDL::ChainIkSolverPos & stepSolver, KDL::ChainFkSolverPos & fkSolver,
+            int maxBursts = 0);
+
+    /**
+     * @brief Set the time budget of the next calls to CartToJnt
+     *
+     * @param seconds Time budget (seconds), non-positive values disable the deadline.
+     */
+    void setBudget(double seconds)
+    { budget = seconds; }
+
+    /**
+     * @brief Set a flag that aborts the next calls to CartToJnt once raised
+     *
+     * @param flag Cancellation flag, NULL to disable.
+     */
+    void setCancelFlag(const std::atomic<bool> * flag)
+    { cancel = flag; }
+
+    /**
+     * @brief Calculate inverse position kinematics.
+     *
+     * @param q_init Initial guess of the joint coordinates.
+     * @param p_in Input cartesian coordinates.
+     * @param q_out Output joint coordinates, best solution found.
+     *
+     * @return Return code, \ref E_DEADLINE_EXPIRED if the solver did not converge
+     * within the time budget, \ref E_NO_PROGRESS if stuck or \ref E_CANCELED if
+     * aborted, in which cases @p q_out is still valid. E_MAX_ITERATIONS_EXCEEDED if the maximum number of bursts has
+     * been reached without converging.
+     */
+    virtual int CartToJnt(const KDL::JntArray & q_init, const KDL::Frame & p_in, KDL::JntArray & q_out);
+
+    /**
+     * @brief Norm of the displacement twist between the desired pose and the one
+     * achieved by the last solution (meters and radians).
+     */
+    double getResidual() const
+    { return residual; }
+
+    /**
+    * @brief Update the internal data structures.
+    *
+    * Update the internal data structures. This is required if the number of segments
+    * or number of joints of a chain has changed. This provides a single point of contact
+    * for solver memory allocations.
+    */
+    virtual void updateInternalDataStructures();
+
+    /**
+     * @brief Return a description of the last error
+     *
+     * @param error Error code.
+     *
+     * @return If \p error is known then a description of \p error, otherwise
+     * "UNKNOWN ERROR".
+     */
+    virtual const char * strError(const int error) const;
+
+    // Codes of the wrapped solvers are forwarded as they are, hence these
+    // must not clash with KDL's nor with those of ChainIkSolverPos_LMA/ID.
+
+    /** @brief Return code, the deadline expired before convergence. */
+    static const int E_DEADLINE_EXPIRED = 200;
+
+    /** @brief Return code, aborted through the cancellation flag. */
+    static const int E_CANCELED = 201;
+
+    /** @brief Return code, the residual stopped improving before convergence. */
+    static const int E_NO_PROGRESS = 202;
+
+    /** @brief Return code, internal FK position solver failed. */
+    static const int E_FKSOLVERPOS_FAILED = -200;
+
+private:
+
+    bool evaluate(const KDL::JntArray & q, const KDL::Frame & p_in, double & r);
+
+    const KDL::Chain & chain;
+    KDL::ChainIkSolverPos & stepSolver;
+    KDL::ChainFkSolverPos & fkSolver;
+
+    int maxBursts;
+    double budget;
+    const std::atomic<bool> * cancel;
+    double residual;
+
+    KDL::JntArray qSeed, qStep;
+};
+
+}  // namespace roboticslab
+
+#endif  // __CHAIN_IK_SOLVER_POS_ANYTIME_HPP__
@@ -3,31 +3,48 @@
 #include "ChainIkSolverPos_ID.hpp"
 
 #include <limits>
-#include <vector>
 
 #include <kdl/frames.hpp>
 
-#include <Eigen/Core>
-
 using namespace roboticslab;
 
 // -----------------------------------------------------------------------------
 
+namespace
+{
+    // Each backtracking step halves the increment, give up below 2^-20 of the initial one.
+    const int MAX_BACKTRACKS = 20;
+
+    inline void twistToVector(const KDL::Twist & in, Eigen::Matrix<double, 6, 1> & out)
+    {
+        out << in.vel.x(), in.vel.y(), in.vel.z(), in.rot.x(), in.rot.y(), in.rot.z();
+    }
+}
+
+// -----------------------------------------------------------------------------
+
 ChainIkSolverPos_ID::ChainIkSolverPos_ID(const KDL::Chain & _chain, const KDL::JntArray & _q_min,
-        const KDL::JntArray & _q_max, KDL::ChainFkSolverPos & fksolver)
+        const KDL::JntArray & _q_max, double _eps, int _maxIter)
     : chain(_chain),
       nj(chain.getNrOfJoints()),
       qMin(_q_min),
       qMax(_q_max),
-      fkSolverPos(fksolver),
-      jacSolver(chain),
-      jacobian(nj)
+      eps(_eps),
+      maxIter(_maxIter),
+      lastNrOfIter(0),
+      poe(PoeExpression::fromChain(chain)),
+      jacobian(nj),
+      jacobianTry(nj),
+      deltaQ(nj),
+      qTry(nj)
 {}
 
 // -----------------------------------------------------------------------------
 
 int ChainIkSolverPos_ID::CartToJnt(const KDL::JntArray & q_init, const KDL::Frame & p_in, KDL::JntArray & q_out)
 {
+    lastNrOfIter = 0;
+
     if (nj != chain.getNrOfJoints())
     {
         return (error = E_NOT_UP_TO_DATE);
@@ -40,36 +57,59 @@ int ChainIkSolverPos_ID::CartToJnt(const KDL::JntArray & q_init, const KDL::Fram
 
     KDL::Frame f;
 
-    if (fkSolverPos.JntToCart(q_init, f) < 0)
+    q_out = q_init;
+
+    if (!poe.evaluate(q_out, f, jacobian, PoeExpression::HYBRID))
     {
-        return (error = E_FKSOLVERPOS_FAILED);
+        return (error = E_JACSOLVER_FAILED);
     }
 
-    KDL::Twist delta_twist = KDL::diff(f, p_in);
+    Vector6d e, eTry;
+    twistToVector(KDL::diff(f, p_in), e);
+    double err = e.norm();
 
-    if (jacSolver.JntToJac(q_init, jacobian) < 0)
+    while (err >= eps)
     {
-        return (error = E_JACSOLVER_FAILED);
-    }
+        if (lastNrOfIter >= maxIter)
+        {
+            return (error = E_MAX_ITERATIONS_EXCEEDED);
+        }
 
-    KDL::JntArray delta_q = computeDiffInvKin(delta_twist);
+        if (!computeDiffInvKin(e))
+        {
+            return (error = E_NO_CONVERGE);
+        }
 
-    KDL::Add(q_init, delta_q, q_out);
+        lastNrOfIter++;
 
-    for (unsigned int j = 0; j < qMin.rows(); j++)
-    {
-        if (q_out(j) < qMin(j))
+        //-- Backtracking: halve the increment until the error decreases.
+        bool improved = false;
+
+        for (int i = 0; i < MAX_BACKTRACKS && !improved; i++)
         {
-            q_out(j) = qMin(j);
+            KDL::Add(q_out, deltaQ, qTry);
+            clamp(qTry);
+
+            if (!poe.evaluate(qTry, f, jacobianTry, PoeExpression::HYBRID))
+            {
+                return (error = E_JACSOLVER_FAILED);
+            }
+
+            twistToVector(KDL::diff(f, p_in), eTry);
+            improved = eTry.norm() < err;
+
+            deltaQ.data *= 0.5;
         }
-    }
 
-    for (unsigned int j = 0; j < qMax.rows(); j++)
-    {
-        if (q_out(j) > qMax(j))
+        if (!improved)
         {
-            q_out(j) = qMax(j);
+            return (error = E_NO_CONVERGE);
         }
+
+        q_out = qTry;
+        e = eTry;
+        err = e.norm();
+        jacobian.data.swap(jacobianTry.data);
     }
 
     return (error = E_NOERROR);
@@ -77,29 +117,44 @@ int ChainIkSolverPos_ID::CartToJnt(const KDL::JntArray & q_init, const KDL::Fram
 
 // -----------------------------------------------------------------------------
 
-KDL::JntArray ChainIkSolverPos_ID::computeDiffInvKin(const KDL::Twist & delta_twist)
+bool ChainIkSolverPos_ID::computeDiffInvKin(const Vector6d & e)
 {
     // Samuel R. Buss, "Introduction to Inverse Kinematics with Jacobian Transpose,
     // Pseudoinverse and Damped Least Squares methods", Department of Mathematics,
     // University of California, San Diego [unpublished].
 
-    KDL::JntArray q(nj);
+    deltaQ.data.noalias() = jacobian.data.transpose() * e;
 
-    Eigen::Matrix<double, 6, 1> e;
+    Vector6d JJTe;
+    JJTe.noalias() = jacobian.data * deltaQ.data;
 
-    e[0] = delta_twist.vel.x();
-    e[1] = delta_twist.vel.y();
-    e[2] = delta_twist.vel.z();
-    e[3] = delta_twist.rot.x();
-    e[4] = delta_twist.rot.y();
-    e[5] = delta_twist.rot.z();
+    double den = JJTe.squaredNorm();
 
-    Eigen::Matrix<double, 6, 1> JJTe = jacobian.data * jacobian.data.transpose() * e;
-    double alpha = e.dot(JJTe) / JJTe.dot(JJTe);
+    if (den == 0.0)
+    {
+        return false;  // error lies in the null space of J^T
+    }
 
-    q.data = alpha * jacobian.data.transpose() * e;
+    deltaQ.data *= e.dot(JJTe) / den;
+
+    return true;
+}
 
-    return q;
+// -----------------------------------------------------------------------------
+
+void ChainIkSolverPos_ID::clamp(KDL::JntArray & q) const
+{
+    for (unsigned int j = 0; j < nj; j++)
+    {
+        if (q(j) < qMin(j))
+        {
+            q(j) = qMin(j);
+        }
+        else if (q(j) > qMax(j))
+        {
+            q(j) = qMax(j);
+        }
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -109,9 +164,11 @@ void ChainIkSolverPos_ID::updateInternalDataStructures()
     nj = chain.getNrOfJoints();
     qMin.data.conservativeResizeLike(Eigen::VectorXd::Constant(nj, std::numeric_limits<double>::min()));
     qMax.data.conservativeResizeLike(Eigen::VectorXd::Constant(nj, std::numeric_limits<double>::max()));
-    fkSolverPos.updateInternalDataStructures();
-    jacSolver.updateInternalDataStructures();
+    poe = PoeExpression::fromChain(chain);
     jacobian.resize(nj);
+    jacobianTry.resize(nj);
+    deltaQ.resize(nj);
+    qTry.resize(nj);
 }
 
 // -----------------------------------------------------------------------------
@@ -120,8 +177,6 @@ const char * ChainIkSolverPos_ID::strError(const int error) const
 {
     switch (error)
     {
-    case E_FKSOLVERPOS_FAILED:
-        return "Internal FK position solver failed";
     case E_JACSOLVER_FAILED:
         return "Internal Jacobian solver failed";
     default:
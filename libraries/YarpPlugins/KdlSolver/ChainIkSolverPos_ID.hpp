@@ -4,12 +4,14 @@
 #define __CHAIN_IK_SOLVER_POS_ID_HPP__
 
 #include <kdl/chain.hpp>
-#include <kdl/chainfksolver.hpp>
 #include <kdl/chainiksolver.hpp>
-#include <kdl/chainjnttojacsolver.hpp>
 #include <kdl/jacobian.hpp>
 #include <kdl/jntarray.hpp>
 
+#include <Eigen/Core>
+
+#include "ProductOfExponentials.hpp"
+
 namespace roboticslab
 {
 
@@ -17,9 +19,12 @@ namespace roboticslab
  * @ingroup KdlSolver
  * @brief IK solver using infinitesimal displacement twists.
  *
- * Re-implementation of KDL::ChainIkSolverPos_NR_JL in which only one iteration step
- * is performed. Aimed to provide a quick means of obtaining IK whenever the displacements
- * are small enough.
+ * Iterative Jacobian transpose method with joint limits, along the lines of
+ * KDL::ChainIkSolverPos_NR_JL. The step size is chosen as in Buss' paper, then halved
+ * until the error decreases (backtracking). Aimed to provide a quick means of obtaining
+ * IK whenever the displacements are small enough, in which case a single iteration may
+ * suffice. Both the current pose and the Jacobian are obtained in a single pass over
+ * the POE representation of the chain, and all storage is reused across iterations.
  */
 class ChainIkSolverPos_ID : public KDL::ChainIkSolverPos
 {
@@ -31,20 +36,23 @@ public:
      * @param chain The chain to calculate the inverse position for.
      * @param q_min The minimum joint positions.
      * @param q_max The maximum joint positions.
-     * @param fksolver A forward position kinematics solver.
-     * @param iksolver An inverse velocity kinematics solver.
+     * @param eps Convergence tolerance, norm of the displacement twist between the
+     * current and the desired pose (meters and radians).
+     * @param maxIter Maximum number of iterations.
      */
-    ChainIkSolverPos_ID(const KDL::Chain & chain, const KDL::JntArray & q_min, const KDL::JntArray & q_max, KDL::ChainFkSolverPos & fksolver);
+    ChainIkSolverPos_ID(const KDL::Chain & chain, const KDL::JntArray & q_min, const KDL::JntArray & q_max,
+            double eps = 1e-6, int maxIter = 100);
 
     /**
      * @brief Calculate inverse position kinematics.
      *
-     * @param q_init Initial guess of the joint coordinates (unused).
+     * @param q_init Initial guess of the joint coordinates.
      * @param p_in Input cartesian coordinates.
-     * @param q_out Output joint coordinates.
+     * @param q_out Output joint coordinates, best solution found even on failure.
      *
-     * @return Return code, \ref E_SOLUTION_NOT_FOUND if there is no solution or
-     * \ref E_NOT_REACHABLE if at least one of them is out of reach.
+     * @return Return code, E_MAX_ITERATIONS_EXCEEDED if not converged within the
+     * iteration cap or E_NO_CONVERGE if no step along the Jacobian transpose decreases
+     * the error anymore (e.g. joint limits or singularities).
      */
     virtual int CartToJnt(const KDL::JntArray & q_init, const KDL::Frame & p_in, KDL::JntArray & q_out);
 
@@ -67,15 +75,19 @@ public:
      */
     virtual const char * strError(const int error) const;
 
-    /** @brief Return code, internal FK position solver failed. */
-    static const int E_FKSOLVERPOS_FAILED = -100;
+    /** @brief Number of iterations performed by the last call to CartToJnt. */
+    int getLastNrOfIter() const
+    { return lastNrOfIter; }
 
     /** @brief Return code, internal Jacobian solver failed. */
     static const int E_JACSOLVER_FAILED = -101;
 
 private:
 
-    KDL::JntArray computeDiffInvKin(const KDL::Twist & delta_twist);
+    typedef Eigen::Matrix<double, 6, 1> Vector6d;
+
+    bool computeDiffInvKin(const Vector6d & e);
+    void clamp(KDL::JntArray & q) const;
 
     const KDL::Chain & chain;
     unsigned int nj;
@@ -83,10 +95,15 @@ private:
     KDL::JntArray qMin;
     KDL::JntArray qMax;
 
-    KDL::ChainFkSolverPos & fkSolverPos;
-    KDL::ChainJntToJacSolver jacSolver;
+    double eps;
+    int maxIter;
+    int lastNrOfIter;
+
+    PoeExpression poe;
 
-    KDL::Jacobian jacobian;
+    //-- Scratch storage, the trial Jacobian is swapped with the current one on each accepted step.
+    KDL::Jacobian jacobian, jacobianTry;
+    KDL::JntArray deltaQ, qTry;
 };
 
 }  // namespace roboticslab
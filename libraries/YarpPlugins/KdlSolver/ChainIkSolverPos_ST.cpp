@@ -2,15 +2,114 @@
 
 #include "ChainIkSolverPos_ST.hpp"
 
+#include <cmath>
+
+#include <kdl/utilities/utility.h>
+
 using namespace roboticslab;
 
 // -----------------------------------------------------------------------------
 
-ChainIkSolverPos_ST::ChainIkSolverPos_ST(const KDL::Chain & _chain, ScrewTheoryIkProblem * _problem,
-        ConfigurationSelector * _config)
+namespace
+{
+    ScrewTheoryIkProblem * buildProblem(const PoeExpression & poe, ScrewTheoryIkProblemCache * cache,
+            ScrewTheoryIkProblemBuilder::Description & description)
+    {
+        if (cache != NULL)
+        {
+            return cache->build(poe, description);
+        }
+
+        ScrewTheoryIkProblemBuilder builder(poe);
+        return builder.build(description);
+    }
+
+    bool hasSameJoints(const PoeExpression & lhs, const PoeExpression & rhs)
+    {
+        if (lhs.size() != rhs.size())
+        {
+            return false;
+        }
+
+        for (int i = 0; i < lhs.size(); i++)
+        {
+            const MatrixExponential & lhsExp = lhs.exponentialAtJoint(i);
+            const MatrixExponential & rhsExp = rhs.exponentialAtJoint(i);
+
+            if (lhsExp.getMotionType() != rhsExp.getMotionType()
+                    || !KDL::Equal(lhsExp.getAxis(), rhsExp.getAxis())
+                    || !KDL::Equal(lhsExp.getOrigin(), rhsExp.getOrigin()))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    ScrewTheoryIkProblem * deriveProblem(const PoeExpression & oldPoe, const PoeExpression & newPoe,
+            ScrewTheoryIkProblemBuilder::Description & description)
+    {
+        if (!hasSameJoints(oldPoe, newPoe))
+        {
+            return NULL;
+        }
+
+        // Only the tool frame has changed (e.g. fixed segments appended), reuse
+        // the sequence of subproblems found so far instead of searching again.
+        KDL::Frame H_new_old = oldPoe.getTransform().Inverse() * newPoe.getTransform();
+        ScrewTheoryIkProblemBuilder::changeToolFrame(description, H_new_old);
+        return ScrewTheoryIkProblemBuilder::rebuild(newPoe, description);
+    }
+
+    bool isWithinLimits(const KDL::JntArray & q, const KDL::JntArray & qMin, const KDL::JntArray & qMax)
+    {
+        for (int i = 0; i < q.rows(); i++)
+        {
+            if (q(i) < qMin(i) - KDL::epsilon || q(i) > qMax(i) + KDL::epsilon)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool isWithinThreshold(const KDL::JntArray & q, const KDL::JntArray & qRef, double threshold)
+    {
+        if (q.rows() != qRef.rows())
+        {
+            return false;
+        }
+
+        for (int i = 0; i < q.rows(); i++)
+        {
+            if (std::abs(q(i) - qRef(i)) > threshold)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+ChainIkSolverPos_ST::ChainIkSolverPos_ST(const KDL::Chain & _chain, const PoeExpression & _poe, ScrewTheoryIkProblem * _problem,
+        const ScrewTheoryIkProblemBuilder::Description & _description, ConfigurationSelector * _config,
+        ScrewTheoryIkProblemCache * _cache, double _branchLockThreshold)
     : chain(_chain),
+      poe(_poe),
       problem(_problem),
-      config(_config)
+      description(_description),
+      config(_config),
+      cache(_cache),
+      workspace(*_problem),
+      solutions(_problem->solutions(), KDL::JntArray(_poe.size())),
+      qBranch(_poe.size()),
+      branchLockThreshold(_branchLockThreshold),
+      lockedBranch(NO_BRANCH)
 {}
 
 // -----------------------------------------------------------------------------
@@ -33,9 +132,19 @@ int ChainIkSolverPos_ST::CartToJnt(const KDL::JntArray & q_init, const KDL::Fram
         return error;
     }
 
-    std::vector<KDL::JntArray> solutions;
+    if (lockedBranch != NO_BRANCH)
+    {
+        if (solveLockedBranch(q_init, p_in, q_out))
+        {
+            return (error = E_NOERROR);
+        }
+
+        // Unlock and look for the best configuration again.
+        lockedBranch = NO_BRANCH;
+    }
 
-    bool ret = problem->solve(p_in, solutions);
+    // Out-of-limits branches are dropped early, the selector will discard them anyway.
+    bool ret = problem->solve(p_in, solutions, config->getMinLimits(), config->getMaxLimits(), workspace, &pruningStats);
 
     if (!config->configure(solutions))
     {
@@ -49,16 +158,56 @@ int ChainIkSolverPos_ST::CartToJnt(const KDL::JntArray & q_init, const KDL::Fram
 
     config->retrievePose(q_out);
 
+    if (ret && branchLockThreshold > 0.0)
+    {
+        for (int i = 0; i < solutions.size(); i++)
+        {
+            if (solutions[i] == q_out)
+            {
+                lockedBranch = i;
+                break;
+            }
+        }
+    }
+
     return (error = ret ? E_NOERROR : E_NOT_REACHABLE);
 }
 
 // -----------------------------------------------------------------------------
 
+bool ChainIkSolverPos_ST::solveLockedBranch(const KDL::JntArray & q_init, const KDL::Frame & p_in, KDL::JntArray & q_out)
+{
+    if (!problem->solveBranch(p_in, lockedBranch, qBranch, workspace))
+    {
+        return false;
+    }
+
+    if (!isWithinLimits(qBranch, config->getMinLimits(), config->getMaxLimits()))
+    {
+        return false;
+    }
+
+    if (!isWithinThreshold(qBranch, q_init, branchLockThreshold))
+    {
+        return false;
+    }
+
+    q_out = qBranch;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 void ChainIkSolverPos_ST::updateInternalDataStructures()
 {
-    PoeExpression poe = PoeExpression::fromChain(chain);
-    ScrewTheoryIkProblemBuilder builder(poe);
-    ScrewTheoryIkProblem * problem = builder.build();
+    PoeExpression newPoe = PoeExpression::fromChain(chain);
+    ScrewTheoryIkProblemBuilder::Description newDescription = description;
+    ScrewTheoryIkProblem * problem = deriveProblem(poe, newPoe, newDescription);
+
+    if (problem == NULL)
+    {
+        problem = buildProblem(newPoe, cache, newDescription);
+    }
 
     if (problem == NULL)
     {
@@ -68,15 +217,26 @@ void ChainIkSolverPos_ST::updateInternalDataStructures()
 
     delete this->problem;
     this->problem = problem;
+
+    workspace = ScrewTheoryIkProblem::Workspace(*problem);
+    solutions.assign(problem->solutions(), KDL::JntArray(newPoe.size()));
+    qBranch.resize(newPoe.size());
+
+    // Solutions might be laid out differently now.
+    lockedBranch = NO_BRANCH;
+
+    poe = newPoe;
+    description = newDescription;
 }
 
 // -----------------------------------------------------------------------------
 
-KDL::ChainIkSolverPos * ChainIkSolverPos_ST::create(const KDL::Chain & chain, const ConfigurationSelectorFactory & configFactory)
+KDL::ChainIkSolverPos * ChainIkSolverPos_ST::create(const KDL::Chain & chain, const ConfigurationSelectorFactory & configFactory,
+        ScrewTheoryIkProblemCache * cache, double branchLockThreshold)
 {
     PoeExpression poe = PoeExpression::fromChain(chain);
-    ScrewTheoryIkProblemBuilder builder(poe);
-    ScrewTheoryIkProblem * problem = builder.build();
+    ScrewTheoryIkProblemBuilder::Description description;
+    ScrewTheoryIkProblem * problem = buildProblem(poe, cache, description);
 
     if (problem == NULL)
     {
@@ -85,7 +245,26 @@ KDL::ChainIkSolverPos * ChainIkSolverPos_ST::create(const KDL::Chain & chain, co
 
     ConfigurationSelector * config = configFactory.create();
 
-    return new ChainIkSolverPos_ST(chain, problem, config);
+    return new ChainIkSolverPos_ST(chain, poe, problem, description, config, cache, branchLockThreshold);
+}
+
+// -----------------------------------------------------------------------------
+
+KDL::ChainIkSolverPos * ChainIkSolverPos_ST::create(const KDL::Chain & chain, const ChainIkSolverPos_ST & prototype,
+        const ConfigurationSelectorFactory & configFactory)
+{
+    PoeExpression poe = PoeExpression::fromChain(chain);
+    ScrewTheoryIkProblemBuilder::Description description = prototype.description;
+    ScrewTheoryIkProblem * problem = deriveProblem(prototype.poe, poe, description);
+
+    if (problem == NULL)
+    {
+        return create(chain, configFactory, prototype.cache, prototype.branchLockThreshold);
+    }
+
+    ConfigurationSelector * config = configFactory.create();
+
+    return new ChainIkSolverPos_ST(chain, poe, problem, description, config, prototype.cache, prototype.branchLockThreshold);
 }
 
 // -----------------------------------------------------------------------------
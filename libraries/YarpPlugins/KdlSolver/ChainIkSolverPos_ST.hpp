@@ -6,6 +6,7 @@
 #include <kdl/chainiksolver.hpp>
 
 #include "ScrewTheoryIkProblem.hpp"
+#include "ScrewTheoryIkProblemCache.hpp"
 #include "ConfigurationSelector.hpp"
 
 namespace roboticslab
@@ -19,6 +20,12 @@ namespace roboticslab
  * around \ref ScrewTheoryIkProblem. Non-exhaustive tests on TEO's (UC3M) right arm
  * kinematic chain reveal that this is 5-10 faster than a numeric Newton-Raphson
  * solver as provided by KDL (e.g. KDL::ChainIkSolverPos_NR_JL).
+ *
+ * Optionally, the solver may lock onto the last selected configuration (branch of
+ * the solution tree) and solve only that one in subsequent calls, which is meant
+ * for streaming commands at a high rate. Full enumeration is performed again
+ * whenever the locked branch becomes unreachable, exceeds the joint limits or
+ * jumps further than a given threshold away from the initial guess.
  */
 class ChainIkSolverPos_ST : public KDL::ChainIkSolverPos
 {
@@ -30,7 +37,8 @@ public:
     /**
      * @brief Calculate inverse position kinematics.
      *
-     * @param q_init Initial guess of the joint coordinates (unused).
+     * @param q_init Initial guess of the joint coordinates, used by the configuration
+     * selector and the branch locking mode.
      * @param p_in Input cartesian coordinates.
      * @param q_out Output joint coordinates.
      *
@@ -44,7 +52,9 @@ public:
     *
     * Update the internal data structures. This is required if the number of segments
     * or number of joints of a chain has changed. This provides a single point of contact
-    * for solver memory allocations.
+    * for solver memory allocations. If the joint geometry is unchanged, e.g. fixed segments
+    * have been appended, the current sequence of subproblems is reused for the new tool
+    * frame and no search is performed.
     */
     virtual void updateInternalDataStructures();
 
@@ -58,16 +68,53 @@ public:
      */
     virtual const char * strError(const int error) const;
 
+    /**
+     * @brief Work saved so far by discarding solutions out of joint limits.
+     *
+     * Branches of the solution tree are pruned as soon as any joint exceeds the
+     * limits of the configuration selector, counters accumulate across calls
+     * to \ref CartToJnt.
+     *
+     * @return Pruning counters.
+     */
+    const ScrewTheoryIkProblem::PruningStats & getPruningStats() const
+    { return pruningStats; }
+
     /**
      * @brief Create an instance of \ref ChainIkSolverPos_ST.
      *
      * @param chain Input kinematic chain.
      * @param configFactory Instance of an abstract factory class that
      * instantiates a ConfigurationSelector.
+     * @param cache Optional cache of IK problems, also used on subsequent
+     * calls to \ref updateInternalDataStructures. Must outlive this solver.
+     * @param branchLockThreshold Maximum displacement of any joint (radians) with
+     * respect to the initial guess for the last selected branch to be kept, zero
+     * disables branch locking.
+     *
+     * @return Solver instance or NULL if no solution was found.
+     */
+    static KDL::ChainIkSolverPos * create(const KDL::Chain & chain, const ConfigurationSelectorFactory & configFactory,
+            ScrewTheoryIkProblemCache * cache = NULL, double branchLockThreshold = 0.0);
+
+    /**
+     * @brief Create an instance of \ref ChainIkSolverPos_ST from an existing one.
+     *
+     * If the joint geometry of both chains is the same, e.g. fixed segments have been
+     * appended or removed, the sequence of subproblems of \p prototype is reused for
+     * the new tool frame and no search is performed. The problem cache is neither
+     * queried nor updated in that case. Otherwise, this behaves as the overload above
+     * with the cache and branch locking settings of \p prototype.
+     *
+     * @param chain Input kinematic chain.
+     * @param prototype Solver whose IK problem will be adapted to \p chain.
+     * @param configFactory Instance of an abstract factory class that
+     * instantiates a ConfigurationSelector.
      *
      * @return Solver instance or NULL if no solution was found.
      */
-    static KDL::ChainIkSolverPos * create(const KDL::Chain & chain, const ConfigurationSelectorFactory & configFactory);
+    static KDL::ChainIkSolverPos * create(const KDL::Chain & chain, const ChainIkSolverPos_ST & prototype,
+            const ConfigurationSelectorFactory & configFactory);
 
     /** @brief Return code, IK solution not found. */
     static const int E_SOLUTION_NOT_FOUND = -100;
@@ -80,13 +127,35 @@ public:
 
 private:
 
-    ChainIkSolverPos_ST(const KDL::Chain & chain, ScrewTheoryIkProblem * problem, ConfigurationSelector * config);
+    ChainIkSolverPos_ST(const KDL::Chain & chain, const PoeExpression & poe, ScrewTheoryIkProblem * problem,
+            const ScrewTheoryIkProblemBuilder::Description & description, ConfigurationSelector * config,
+            ScrewTheoryIkProblemCache * cache, double branchLockThreshold);
+
+    bool solveLockedBranch(const KDL::JntArray & q_init, const KDL::Frame & p_in, KDL::JntArray & q_out);
+
+    static const int NO_BRANCH = -1;
 
     const KDL::Chain & chain;
 
+    PoeExpression poe;
+
     ScrewTheoryIkProblem * problem;
 
+    ScrewTheoryIkProblemBuilder::Description description;
+
     ConfigurationSelector * config;
+
+    ScrewTheoryIkProblemCache * cache;
+
+    ScrewTheoryIkProblem::PruningStats pruningStats;
+
+    // Scratch memory, sized along with the IK problem.
+    ScrewTheoryIkProblem::Workspace workspace;
+    ScrewTheoryIkProblem::Solutions solutions;
+    KDL::JntArray qBranch;
+
+    double branchLockThreshold;
+    int lockedBranch;
 };
 
 }  // namespace roboticslab
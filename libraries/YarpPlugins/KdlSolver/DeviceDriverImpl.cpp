@@ -38,6 +38,9 @@
 
 namespace
 {
+    // Same as the default value of KDL::ChainIkSolverPos_LMA.
+    const int LMA_MAXITER = 500;
+
     bool getMatrixFromProperties(const yarp::os::Searchable & options, const std::string & tag, yarp::sig::Matrix & H)
     {
         yarp::os::Bottle * bH = options.find(tag).asList();
@@ -162,9 +165,11 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
 
     yarp::os::Value gravityValue = fullConfig.check("gravity", defaultGravityValue, "gravity vector (SI units)");
     yarp::os::Bottle *gravityBottle = gravityValue.asList();
-    KDL::Vector gravity(gravityBottle->get(0).asFloat64(),gravityBottle->get(1).asFloat64(),gravityBottle->get(2).asFloat64());
+    gravity = KDL::Vector(gravityBottle->get(0).asFloat64(),gravityBottle->get(1).asFloat64(),gravityBottle->get(2).asFloat64());
     CD_INFO("gravity: %s [%s]\n",gravityBottle->toString().c_str(),defaultGravityBottle->toString().c_str());
 
+    KDL::Chain chain;
+
     //-- H0
     yarp::sig::Matrix defaultYmH0(4,4);
     defaultYmH0.eye();
@@ -282,12 +287,8 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
     CD_INFO("Chain number of segments (post- H0 and HN): %d\n",chain.getNrOfSegments());
     CD_INFO("Chain number of joints (post- H0 and HN): %d\n",chain.getNrOfJoints());
 
-    fkSolverPos = new KDL::ChainFkSolverPos_recursive(chain);
-    ikSolverVel = new KDL::ChainIkSolverVel_pinv(chain);
-    idSolver = new KDL::ChainIdSolver_RNE(chain, gravity);
-
     //-- IK solver algorithm.
-    std::string ik = fullConfig.check("ik", yarp::os::Value(DEFAULT_IK_SOLVER), "IK solver algorithm (lma, nrjl, st, id)").asString();
+    ik = fullConfig.check("ik", yarp::os::Value(DEFAULT_IK_SOLVER), "IK solver algorithm (lma, nrjl, st, id)").asString();
 
     if (ik == "lma")
     {
@@ -301,12 +302,12 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
             return false;
         }
 
-        ikSolverPos = new KDL::ChainIkSolverPos_LMA(chain, L);
+        lmaWeights.assign(L.data(), L.data() + L.size());
     }
     else if (ik == "nrjl")
     {
-        KDL::JntArray qMax(chain.getNrOfJoints());
-        KDL::JntArray qMin(chain.getNrOfJoints());
+        qMax.resize(chain.getNrOfJoints());
+        qMin.resize(chain.getNrOfJoints());
 
         //-- Joint limits.
         if (!retrieveJointLimits(fullConfig, qMin, qMax))
@@ -316,15 +317,13 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
         }
 
         //-- Precision and max iterations.
-        double eps = fullConfig.check("eps", yarp::os::Value(DEFAULT_EPS), "IK solver precision (meters)").asFloat64();
-        double maxIter = fullConfig.check("maxIter", yarp::os::Value(DEFAULT_MAXITER), "maximum number of iterations").asInt32();
-
-        ikSolverPos = new KDL::ChainIkSolverPos_NR_JL(chain, qMin, qMax, *fkSolverPos, *ikSolverVel, maxIter, eps);
+        eps = fullConfig.check("eps", yarp::os::Value(DEFAULT_EPS), "IK solver precision (meters)").asFloat64();
+        maxIter = fullConfig.check("maxIter", yarp::os::Value(DEFAULT_MAXITER), "maximum number of iterations").asInt32();
     }
     else if (ik == "st")
     {
-        KDL::JntArray qMax(chain.getNrOfJoints());
-        KDL::JntArray qMin(chain.getNrOfJoints());
+        qMax.resize(chain.getNrOfJoints());
+        qMin.resize(chain.getNrOfJoints());
 
         //-- Joint limits.
         if (!retrieveJointLimits(fullConfig, qMin, qMax))
@@ -333,35 +332,35 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
             return false;
         }
 
+        //-- IK problem cache, skips the subproblem search on known geometries.
+        std::string cacheDir = fullConfig.check("ikCacheDir", yarp::os::Value(DEFAULT_IK_CACHE_DIR), "IK problem cache directory (empty: memory only)").asString();
+        ikProblemCache = new ScrewTheoryIkProblemCache(cacheDir);
+
+        //-- Branch locking, solves only the last selected configuration while streaming.
+        branchLock = fullConfig.check("ikBranchLock", yarp::os::Value(DEFAULT_IK_BRANCH_LOCK), "max joint jump to keep the last IK configuration (degrees, 0: disabled)").asFloat64();
+        branchLock = KDL::deg2rad * branchLock;
+
         //-- IK configuration selection strategy.
         std::string strategy = fullConfig.check("invKinStrategy", yarp::os::Value(DEFAULT_STRATEGY), "IK configuration strategy").asString();
 
         if (strategy == "leastOverallAngularDisplacement")
         {
-            ConfigurationSelectorLeastOverallAngularDisplacementFactory factory(qMin, qMax);
-            ikSolverPos = ChainIkSolverPos_ST::create(chain, factory);
+            ikConfigFactory = new ConfigurationSelectorLeastOverallAngularDisplacementFactory(qMin, qMax);
         }
         else if (strategy == "humanoidGait")
         {
-            ConfigurationSelectorHumanoidGaitFactory factory(qMin, qMax);
-            ikSolverPos = ChainIkSolverPos_ST::create(chain, factory);
+            ikConfigFactory = new ConfigurationSelectorHumanoidGaitFactory(qMin, qMax);
         }
         else
         {
             CD_ERROR("Unsupported IK strategy: %s.\n", strategy.c_str());
             return false;
         }
-
-        if (ikSolverPos == NULL)
-        {
-            CD_ERROR("Unable to solve IK.\n");
-            return false;
-        }
     }
     else if (ik == "id")
     {
-        KDL::JntArray qMax(chain.getNrOfJoints());
-        KDL::JntArray qMin(chain.getNrOfJoints());
+        qMax.resize(chain.getNrOfJoints());
+        qMin.resize(chain.getNrOfJoints());
 
         //-- Joint limits.
         if (!retrieveJointLimits(fullConfig, qMin, qMax))
@@ -370,7 +369,15 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
             return false;
         }
 
-        ikSolverPos = new ChainIkSolverPos_ID(chain, qMin, qMax, *fkSolverPos);
+        //-- Precision and max iterations, the Jacobian transpose method converges slowly.
+        eps = fullConfig.check("eps", yarp::os::Value(DEFAULT_ID_EPS), "IK solver precision (meters and radians)").asFloat64();
+        maxIter = fullConfig.check("maxIter", yarp::os::Value(DEFAULT_MAXITER), "maximum number of iterations").asInt32();
+
+        if (eps <= 0.0 || maxIter <= 0)
+        {
+            CD_ERROR("Illegal IK solver precision (%f) or max iterations (%d).\n", eps, maxIter);
+            return false;
+        }
     }
     else
     {
@@ -378,7 +385,145 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
         return false;
     }
 
-    originalChain = chain;
+    //-- Time budget of iterative IK solvers.
+    if (ik == "lma" || ik == "nrjl" || ik == "id")
+    {
+        ikTimeBudget = fullConfig.check("ikTimeBudget", yarp::os::Value(DEFAULT_IK_TIME_BUDGET), "IK time budget, best solution returned on expiry (seconds, 0: disabled)").asFloat64();
+        ikTimeBudgetIter = fullConfig.check("ikTimeBudgetIter", yarp::os::Value(DEFAULT_IK_TIME_BUDGET_ITER), "IK iterations between deadline checks").asInt32();
+
+        if (ikTimeBudgetIter <= 0)
+        {
+            CD_ERROR("Illegal number of iterations between deadline checks: %d.\n", ikTimeBudgetIter);
+            return false;
+        }
+
+        //-- Multi-start, races the solver from several seeds.
+        ikStarts = fullConfig.check("ikStarts", yarp::os::Value(DEFAULT_IK_STARTS), "number of IK seeds raced in parallel (1: disabled)").asInt32();
+
+        if (ikStarts < 1)
+        {
+            CD_ERROR("Illegal number of IK seeds: %d.\n", ikStarts);
+            return false;
+        }
+
+        if (ikStarts > 1)
+        {
+            if (ik == "lma")
+            {
+                qMax.resize(chain.getNrOfJoints());
+                qMin.resize(chain.getNrOfJoints());
+
+                //-- Joint limits, random seeds are sampled within them.
+                if (!retrieveJointLimits(fullConfig, qMin, qMax))
+                {
+                    CD_ERROR("Unable to retrieve joint limits.\n");
+                    return false;
+                }
+            }
+
+            yarp::os::Bottle * homes = fullConfig.findGroup("ikHomePoses", "IK seeds tried after the initial guess (list of joint positions in degrees)").get(1).asList();
+
+            for (int i = 0; homes != YARP_NULLPTR && i < homes->size(); i++)
+            {
+                yarp::os::Bottle * home = homes->get(i).asList();
+
+                if (home == YARP_NULLPTR || home->size() != chain.getNrOfJoints())
+                {
+                    CD_ERROR("Illegal IK home pose at index %d.\n", i);
+                    return false;
+                }
+
+                KDL::JntArray q(chain.getNrOfJoints());
+
+                for (int motor = 0; motor < home->size(); motor++)
+                {
+                    q(motor) = KinRepresentation::degToRad(home->get(motor).asFloat64());
+                }
+
+                ikHomePoses.push_back(q);
+            }
+
+            if ((int)ikHomePoses.size() > ikStarts - 1)
+            {
+                CD_WARNING("Only the first %d IK home pose(s) will be used.\n", ikStarts - 1);
+                ikHomePoses.resize(ikStarts - 1);
+            }
+
+            CD_INFO("Multi-start IK: %d seed(s), %d home pose(s).\n", ikStarts, (int)ikHomePoses.size());
+        }
+    }
+
+    //-- Velocity IK solver algorithm, operates on the Jacobian obtained alongside the current pose.
+    ikVel = fullConfig.check("ikVel", yarp::os::Value(DEFAULT_IK_VEL_SOLVER), "velocity IK solver algorithm (pinv, wsvd, dls)").asString();
+
+    if (ikVel == "dls")
+    {
+        ikVelDamping = fullConfig.check("ikVelDamping", yarp::os::Value(DEFAULT_IK_VEL_DAMPING), "DLS velocity IK damping factor").asFloat64();
+
+        if (ikVelDamping <= 0.0)
+        {
+            CD_ERROR("Illegal DLS damping factor: %f.\n", ikVelDamping);
+            return false;
+        }
+    }
+    else if (ikVel == "wsvd")
+    {
+        if (chain.getNrOfJoints() > JacobianIkSolverVel::MAX_FIXED_JOINTS)
+        {
+            CD_ERROR("Warm-started SVD supports up to %d joints, got %d.\n", JacobianIkSolverVel::MAX_FIXED_JOINTS, chain.getNrOfJoints());
+            return false;
+        }
+    }
+    else if (ikVel != "pinv")
+    {
+        CD_ERROR("Unsupported velocity IK solver algorithm: %s.\n", ikVel.c_str());
+        return false;
+    }
+
+    originalChain = std::make_shared<const KDL::Chain>(chain);
+    currentChain = originalChain;
+
+    //-- Check solver configuration, more instances are spawned later on demand.
+    SolverSet * solvers = makeSolvers(currentChain, NULL);
+
+    if (solvers == NULL)
+    {
+        CD_ERROR("Unable to solve IK.\n");
+        return false;
+    }
+
+    prototypeSolvers.reset(solvers);
+
+    //-- IK result cache, meant for repeated queries on the same few target poses.
+    int resultCacheSize = fullConfig.check("ikResultCacheSize", yarp::os::Value(DEFAULT_IK_RESULT_CACHE_SIZE), "max number of cached IK results (0: disabled)").asInt32();
+
+    if (resultCacheSize > 0)
+    {
+        double posStep = fullConfig.check("ikResultCachePosStep", yarp::os::Value(DEFAULT_IK_RESULT_CACHE_POS_STEP), "IK result cache quantization of target position (meters)").asFloat64();
+        double rotStep = fullConfig.check("ikResultCacheRotStep", yarp::os::Value(DEFAULT_IK_RESULT_CACHE_ROT_STEP), "IK result cache quantization of target rotation matrix").asFloat64();
+        double seedStep = fullConfig.check("ikResultCacheSeedStep", yarp::os::Value(DEFAULT_IK_RESULT_CACHE_SEED_STEP), "IK result cache quantization of initial guess (meters or degrees)").asFloat64();
+
+        if (posStep <= 0.0 || rotStep <= 0.0 || seedStep <= 0.0)
+        {
+            CD_ERROR("IK result cache quantization steps must be positive.\n");
+            return false;
+        }
+
+        ikResultCacheReport = fullConfig.check("ikResultCacheReport", yarp::os::Value(DEFAULT_IK_RESULT_CACHE_REPORT), "IK result cache lookups between hit/miss reports (0: on close only)").asInt32();
+
+        if (ikResultCacheReport < 0)
+        {
+            CD_ERROR("Illegal IK result cache report period: %d.\n", ikResultCacheReport);
+            return false;
+        }
+
+        ikResultCache = new IkResultCache(resultCacheSize, posStep, rotStep, KinRepresentation::degToRad(seedStep));
+        CD_INFO("IK result cache: %d entries (pos step %f, rot step %f, seed step %f)\n", resultCacheSize, posStep, rotStep, seedStep);
+    }
+
+    int batchThreads = fullConfig.check("batchThreads", yarp::os::Value(DEFAULT_BATCH_THREADS), "number of threads for batch queries (0: hardware concurrency)").asInt32();
+    batchPool = new ThreadPool(batchThreads);
+    CD_INFO("Batch queries using %d thread(s).\n", batchPool->size());
 
     return true;
 }
@@ -387,10 +532,253 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
 
 bool roboticslab::KdlSolver::close()
 {
-    delete fkSolverPos;
+    delete batchPool;
+    batchPool = NULL;
+
+    if (ikStarts > 1)
+    {
+        CD_INFO("Multi-start IK wins: %lu initial guess, %lu home pose, %lu random.\n", ikStartWins[0], ikStartWins[1], ikStartWins[2]);
+    }
+
+    // All leases must have been returned by now.
+    for (int i = 0; i < idleSolvers.size(); i++)
+    {
+        delete idleSolvers[i];
+    }
+
+    idleSolvers.clear();
+    prototypeSolvers.reset();
+
+    currentChain.reset();
+    originalChain.reset();
+
+    delete ikConfigFactory;
+    ikConfigFactory = NULL;
+
+    delete ikProblemCache;
+    ikProblemCache = NULL;
+
+    if (ikResultCache != NULL)
+    {
+        CD_INFO("IK result cache: %lu hits, %lu misses, %d/%d entries.\n", ikResultCache->getHits(),
+                ikResultCache->getMisses(), ikResultCache->size(), ikResultCache->getCapacity());
+        delete ikResultCache;
+        ikResultCache = NULL;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+roboticslab::KdlSolver::SolverSet::~SolverSet()
+{
+    // The IK solver may hold references to the other ones.
+    delete ikSolverPosAnytime;
     delete ikSolverPos;
+    delete ikSolverPosStep;
+    delete fkSolverPos;
+    delete fkJacSolver;
     delete ikSolverVel;
+    delete jacIkSolverVel;
     delete idSolver;
+}
+
+// -----------------------------------------------------------------------------
+
+roboticslab::KdlSolver::SolverSet * roboticslab::KdlSolver::makeSolvers(const std::shared_ptr<const KDL::Chain> & snapshot,
+        const SolverSet * prototype) const
+{
+    SolverSet * set = new SolverSet;
+
+    // Solvers keep a reference to the chain, hence the snapshot must outlive them.
+    set->chain = snapshot;
+
+    set->qIn.resize(snapshot->getNrOfJoints());
+    set->qdotIn.resize(snapshot->getNrOfJoints());
+    set->qdotdotIn.resize(snapshot->getNrOfJoints());
+    set->qOut.resize(snapshot->getNrOfJoints());
+    set->qRace.resize(snapshot->getNrOfJoints());
+    set->wrenches.resize(snapshot->getNrOfSegments());
+    set->jacobian.resize(snapshot->getNrOfJoints());
+    set->rng.seed(std::random_device()());
+
+    set->fkSolverPos = new KDL::ChainFkSolverPos_recursive(*set->chain);
+    set->fkJacSolver = new ChainFkJacSolver(*set->chain);
+    set->ikSolverVel = new KDL::ChainIkSolverVel_pinv(*set->chain);
+    set->jacIkSolverVel = JacobianIkSolverVel::create(ikVel, snapshot->getNrOfJoints(), ikVelDamping);
+    set->idSolver = new KDL::ChainIdSolver_RNE(*set->chain, gravity);
+
+    //-- Iterations allowed to the regular solver, the anytime one must not exceed them either.
+    int ikMaxIter = maxIter;
+
+    if (ik == "lma")
+    {
+        Eigen::Matrix<double, 6, 1> L(lmaWeights.data());
+        set->ikSolverPos = new KDL::ChainIkSolverPos_LMA(*set->chain, L, 1e-5, LMA_MAXITER);
+        set->ikSolverPosStep = new KDL::ChainIkSolverPos_LMA(*set->chain, L, 1e-5, ikTimeBudgetIter);
+        ikMaxIter = LMA_MAXITER;
+    }
+    else if (ik == "nrjl")
+    {
+        set->ikSolverPos = new KDL::ChainIkSolverPos_NR_JL(*set->chain, qMin, qMax, *set->fkSolverPos, *set->ikSolverVel, maxIter, eps);
+        set->ikSolverPosStep = new KDL::ChainIkSolverPos_NR_JL(*set->chain, qMin, qMax, *set->fkSolverPos, *set->ikSolverVel, ikTimeBudgetIter, eps);
+    }
+    else if (ik == "st")
+    {
+        if (prototype != NULL && prototype->ikSolverPos != NULL)
+        {
+            // Tool changes are handled by the prototype, skip the builder search and the problem cache.
+            const ChainIkSolverPos_ST & ikPrototype = static_cast<const ChainIkSolverPos_ST &>(*prototype->ikSolverPos);
+            set->ikSolverPos = ChainIkSolverPos_ST::create(*set->chain, ikPrototype, *ikConfigFactory);
+        }
+        else
+        {
+            set->ikSolverPos = ChainIkSolverPos_ST::create(*set->chain, *ikConfigFactory, ikProblemCache, branchLock);
+        }
+    }
+    else if (ik == "id")
+    {
+        set->ikSolverPos = new ChainIkSolverPos_ID(*set->chain, qMin, qMax, eps, maxIter);
+        set->ikSolverPosStep = new ChainIkSolverPos_ID(*set->chain, qMin, qMax, eps, ikTimeBudgetIter);
+    }
+
+    if (set->ikSolverPos == NULL || set->jacIkSolverVel == NULL)
+    {
+        delete set;
+        return NULL;
+    }
+
+    //-- Only iterative solvers can be interrupted.
+    if (set->ikSolverPosStep != NULL)
+    {
+        int maxBursts = (ikMaxIter + ikTimeBudgetIter - 1) / ikTimeBudgetIter;
+        set->ikSolverPosAnytime = new ChainIkSolverPos_Anytime(*set->chain, *set->ikSolverPosStep, *set->fkSolverPos, maxBursts);
+    }
+
+    return set;
+}
+
+// -----------------------------------------------------------------------------
+
+roboticslab::KdlSolver::SolverSet * roboticslab::KdlSolver::acquireSolvers()
+{
+    std::shared_ptr<const SolverSet> prototype;
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        if (!idleSolvers.empty())
+        {
+            SolverSet * set = idleSolvers.back();
+            idleSolvers.pop_back();
+            return set;
+        }
+
+        prototype = prototypeSolvers;
+    }
+
+    // Expensive stuff happens outside the critical section.
+    SolverSet * set = makeSolvers(prototype->chain, prototype.get());
+
+    if (set == NULL)
+    {
+        CD_ERROR("Unable to instantiate solvers.\n");
+    }
+
+    return set;
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::KdlSolver::releaseSolvers(SolverSet * set)
+{
+    if (set == NULL)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        if (set->chain == std::atomic_load(&currentChain))
+        {
+            idleSolvers.push_back(set);
+            return;
+        }
+    }
+
+    // The chain has changed while this set was in use.
+    delete set;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::publishChain(const std::shared_ptr<const KDL::Chain> & snapshot)
+{
+    int count = 1;
+    std::shared_ptr<const SolverSet> prototype;
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        if (idleSolvers.size() > count)
+        {
+            count = idleSolvers.size();
+        }
+
+        prototype = prototypeSolvers;
+    }
+
+    // Only the tool segment changes here, so the IK problem is adapted rather than searched for.
+    std::shared_ptr<const SolverSet> nextPrototype(makeSolvers(snapshot, prototype.get()));
+
+    if (!nextPrototype)
+    {
+        CD_ERROR("Unable to instantiate solvers, keeping previous chain.\n");
+        return false;
+    }
+
+    // Replace idle sets in advance, so that no query pays for the rebuild.
+    std::vector<SolverSet *> fresh;
+
+    for (int i = 0; i < count; i++)
+    {
+        SolverSet * set = makeSolvers(snapshot, nextPrototype.get());
+
+        if (set == NULL)
+        {
+            CD_ERROR("Unable to instantiate solvers, keeping previous chain.\n");
+
+            for (int j = 0; j < fresh.size(); j++)
+            {
+                delete fresh[j];
+            }
+
+            return false;
+        }
+
+        fresh.push_back(set);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        std::atomic_store(&currentChain, snapshot);
+        idleSolvers.swap(fresh);
+        prototypeSolvers = nextPrototype;
+
+        if (ikResultCache != NULL)
+        {
+            ikResultCache->clear();
+        }
+    }
+
+    // Outdated sets, sets in use are destroyed on release.
+    for (int i = 0; i < fresh.size(); i++)
+    {
+        delete fresh[i];
+    }
 
     return true;
 }
@@ -2,6 +2,9 @@
 
 #include "KdlSolver.hpp"
 
+#include <atomic>
+#include <limits>
+
 #include <kdl/frames.hpp>
 #include <kdl/jntarray.hpp>
 #include <kdl/joint.hpp>
@@ -14,9 +17,34 @@
 
 // -----------------------------------------------------------------------------
 
+namespace
+{
+    inline void fillNaN(double * out, int size)
+    {
+        for (int i = 0; i < size; i++)
+        {
+            out[i] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    inline bool checkBatchSize(int size, int stride, int * count)
+    {
+        if (stride <= 0 || size % stride != 0)
+        {
+            CD_ERROR("Batch size mismatch: %d is not a multiple of %d.\n", size, stride);
+            return false;
+        }
+
+        *count = size / stride;
+        return true;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::KdlSolver::getNumJoints(int* numJoints)
 {
-    *numJoints = chain.getNrOfJoints();
+    *numJoints = std::atomic_load(&currentChain)->getNrOfJoints();
     return true;
 }
 
@@ -26,32 +54,20 @@ bool roboticslab::KdlSolver::appendLink(const std::vector<double>& x)
 {
     KDL::Frame frameX = KdlVectorConverter::vectorToFrame(x);
 
-    std::lock_guard<std::mutex> lock(mtx);
-
-    chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::None), frameX));
+    std::lock_guard<std::mutex> lock(chainMtx);
 
-    fkSolverPos->updateInternalDataStructures();
-    ikSolverPos->updateInternalDataStructures();
-    ikSolverVel->updateInternalDataStructures();
-    idSolver->updateInternalDataStructures();
+    std::shared_ptr<KDL::Chain> snapshot = std::make_shared<KDL::Chain>(*std::atomic_load(&currentChain));
+    snapshot->addSegment(KDL::Segment(KDL::Joint(KDL::Joint::None), frameX));
 
-    return true;
+    return publishChain(snapshot);
 }
 
 // -----------------------------------------------------------------------------
 
 bool roboticslab::KdlSolver::restoreOriginalChain()
 {
-    std::lock_guard<std::mutex> lock(mtx);
-
-    chain = originalChain;
-
-    fkSolverPos->updateInternalDataStructures();
-    ikSolverPos->updateInternalDataStructures();
-    ikSolverVel->updateInternalDataStructures();
-    idSolver->updateInternalDataStructures();
-
-    return true;
+    std::lock_guard<std::mutex> lock(chainMtx);
+    return publishChain(originalChain);
 }
 
 // -----------------------------------------------------------------------------
@@ -72,23 +88,19 @@ bool roboticslab::KdlSolver::changeOrigin(const std::vector<double> &x_old_obj,
 
 bool roboticslab::KdlSolver::fwdKin(const std::vector<double> &q, std::vector<double> &x)
 {
-    KDL::JntArray qInRad(chain.getNrOfJoints());
-
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
-    {
-        qInRad(motor) = KinRepresentation::degToRad(q[motor]);
-    }
+    int numJoints;
+    getNumJoints(&numJoints);
 
-    KDL::Frame fOutCart;
+    std::vector<double> qInRad(numJoints);
 
+    for (int motor = 0; motor < numJoints; motor++)
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        fkSolverPos->JntToCart(qInRad, fOutCart);
+        qInRad[motor] = KinRepresentation::degToRad(q[motor]);
     }
 
-    x = KdlVectorConverter::frameToVector(fOutCart);
+    x.resize(6);
 
-    return true;
+    return fwdKinInto(qInRad.data(), x.data());
 }
 
 // -----------------------------------------------------------------------------
@@ -109,50 +121,76 @@ bool roboticslab::KdlSolver::poseDiff(const std::vector<double> &xLhs, const std
 bool roboticslab::KdlSolver::invKin(const std::vector<double> &xd, const std::vector<double> &qGuess, std::vector<double> &q,
         const reference_frame frame)
 {
-    KDL::Frame frameXd = KdlVectorConverter::vectorToFrame(xd);
-    KDL::JntArray qGuessInRad(chain.getNrOfJoints());
+    if (xd.size() != 6)
+    {
+        CD_WARNING("Size mismatch; expected: 6, was: %d\n", (int)xd.size());
+        return false;
+    }
+
+    int numJoints;
+    getNumJoints(&numJoints);
+
+    std::vector<double> qGuessInRad(numJoints);
 
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    for (int motor = 0; motor < numJoints; motor++)
     {
-        qGuessInRad(motor) = KinRepresentation::degToRad(qGuess[motor]);
+        qGuessInRad[motor] = KinRepresentation::degToRad(qGuess[motor]);
     }
 
-    KDL::JntArray kdlq(chain.getNrOfJoints());
-    int ret;
+    std::vector<double> qInRad(numJoints);
 
+    if (!invKinInto(xd.data(), qGuessInRad.data(), qInRad.data(), frame))
     {
-        std::lock_guard<std::mutex> lock(mtx);
+        return false;
+    }
 
-        if (frame == TCP_FRAME)
-        {
-            KDL::Frame fOutCart;
-            fkSolverPos->JntToCart(qGuessInRad, fOutCart);
-            frameXd = fOutCart * frameXd;
-        }
-        else if (frame != BASE_FRAME)
-        {
-            CD_WARNING("Unsupported frame.\n");
-            return false;
-        }
+    q.resize(numJoints);
 
-        ret = ikSolverPos->CartToJnt(qGuessInRad, frameXd, kdlq);
+    for (int motor = 0; motor < numJoints; motor++)
+    {
+        q[motor] = KinRepresentation::radToDeg(qInRad[motor]);
     }
 
-    if (ret < 0)
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::invKinBudget(const std::vector<double> &xd, const std::vector<double> &qGuess, double budget,
+        std::vector<double> &q, double &residual, const reference_frame frame)
+{
+    if (xd.size() != 6)
     {
-        CD_ERROR("%d: %s\n", ret, ikSolverPos->strError(ret));
+        CD_WARNING("Size mismatch; expected: 6, was: %d\n", (int)xd.size());
         return false;
     }
-    else if (ret > 0)
+
+    SolverLease solvers(*this);
+
+    if (!solvers.isValid())
     {
-        CD_WARNING("%d: %s\n", ret, ikSolverPos->strError(ret));
+        return false;
+    }
+
+    int numJoints = solvers->qIn.rows();
+
+    std::vector<double> qGuessInRad(numJoints);
+
+    for (int motor = 0; motor < numJoints; motor++)
+    {
+        qGuessInRad[motor] = KinRepresentation::degToRad(qGuess[motor]);
     }
 
-    q.resize(chain.getNrOfJoints());
+    q.resize(numJoints);
 
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    if (!invKinWith(solvers.get(), xd.data(), qGuessInRad.data(), q.data(), frame, budget, &residual))
     {
-        q[motor] = KinRepresentation::radToDeg(kdlq(motor));
+        return false;
+    }
+
+    for (int motor = 0; motor < numJoints; motor++)
+    {
+        q[motor] = KinRepresentation::radToDeg(q[motor]);
     }
 
     return true;
@@ -163,53 +201,34 @@ bool roboticslab::KdlSolver::invKin(const std::vector<double> &xd, const std::ve
 bool roboticslab::KdlSolver::diffInvKin(const std::vector<double> &q, const std::vector<double> &xdot, std::vector<double> &qdot,
         const reference_frame frame)
 {
-    KDL::JntArray qInRad(chain.getNrOfJoints());
-
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    if (xdot.size() != 6)
     {
-        qInRad(motor) = KinRepresentation::degToRad(q[motor]);
+        CD_WARNING("Size mismatch; expected: 6, was: %d\n", (int)xdot.size());
+        return false;
     }
 
-    KDL::Twist kdlxdot = KdlVectorConverter::vectorToTwist(xdot);
-    KDL::JntArray qDotOutRadS(chain.getNrOfJoints());
-    int ret;
-
-    {
-        std::lock_guard<std::mutex> lock(mtx);
-
-        if (frame == TCP_FRAME)
-        {
-            KDL::Frame fOutCart;
-            fkSolverPos->JntToCart(qInRad, fOutCart);
+    int numJoints;
+    getNumJoints(&numJoints);
 
-            //-- Transform the basis to which the twist is expressed, but leave the reference point intact
-            //-- "Twist and Wrench transformations" @ http://docs.ros.org/latest/api/orocos_kdl/html/geomprim.html
-            kdlxdot = fOutCart.M * kdlxdot;
-        }
-        else if (frame != BASE_FRAME)
-        {
-            CD_WARNING("Unsupported frame.\n");
-            return false;
-        }
+    std::vector<double> qInRad(numJoints);
 
-        ret = ikSolverVel->CartToJnt(qInRad, kdlxdot, qDotOutRadS);
+    for (int motor = 0; motor < numJoints; motor++)
+    {
+        qInRad[motor] = KinRepresentation::degToRad(q[motor]);
     }
 
-    if (ret < 0)
+    std::vector<double> qdotInRad(numJoints);
+
+    if (!diffInvKinInto(qInRad.data(), xdot.data(), qdotInRad.data(), frame))
     {
-        CD_ERROR("%d: %s\n", ret, ikSolverVel->strError(ret));
         return false;
     }
-    else if (ret > 0)
-    {
-        CD_WARNING("%d: %s\n", ret, ikSolverVel->strError(ret));
-    }
 
-    qdot.resize(chain.getNrOfJoints());
+    qdot.resize(numJoints);
 
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    for (int motor = 0; motor < numJoints; motor++)
     {
-        qdot[motor] = KinRepresentation::radToDeg(qDotOutRadS(motor));
+        qdot[motor] = KinRepresentation::radToDeg(qdotInRad[motor]);
     }
 
     return true;
@@ -217,42 +236,96 @@ bool roboticslab::KdlSolver::diffInvKin(const std::vector<double> &q, const std:
 
 // -----------------------------------------------------------------------------
 
-bool roboticslab::KdlSolver::invDyn(const std::vector<double> &q,std::vector<double> &t)
+bool roboticslab::KdlSolver::invDyn(const std::vector<double> &q, std::vector<double> &t)
 {
-    KDL::JntArray qInRad(chain.getNrOfJoints());
+    int numJoints;
+    getNumJoints(&numJoints);
+
+    std::vector<double> qInRad(numJoints);
 
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    for (int motor = 0; motor < numJoints; motor++)
     {
-        qInRad(motor) = KinRepresentation::degToRad(q[motor]);
+        qInRad[motor] = KinRepresentation::degToRad(q[motor]);
     }
 
-    KDL::JntArray qdotInRad(chain.getNrOfJoints());
-    KDL::JntArray qdotdotInRad(chain.getNrOfJoints());
-    KDL::JntArray kdlt(chain.getNrOfJoints());
-    KDL::Wrenches wrenches(chain.getNrOfSegments(), KDL::Wrench::Zero());
+    t.resize(numJoints);
+
+    return invDynInto(qInRad.data(), t.data());
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::invDyn(const std::vector<double> &q,const std::vector<double> &qdot,const std::vector<double> &qdotdot, const std::vector< std::vector<double> > &fexts, std::vector<double> &t)
+{
+    int numJoints;
+    getNumJoints(&numJoints);
 
-    int ret;
+    std::vector<double> qInRad(numJoints), qdotInRad(numJoints), qdotdotInRad(numJoints);
 
+    for (int motor = 0; motor < numJoints; motor++)
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        ret = idSolver->CartToJnt(qInRad, qdotInRad, qdotdotInRad, wrenches, kdlt);
+        qInRad[motor] = KinRepresentation::degToRad(q[motor]);
+        qdotInRad[motor] = KinRepresentation::degToRad(qdot[motor]);
+        qdotdotInRad[motor] = KinRepresentation::degToRad(qdotdot[motor]);
     }
 
-    if (ret < 0)
+    std::vector<double> wrenches(6 * fexts.size());
+
+    for (int i = 0; i < fexts.size(); i++)
     {
-        CD_ERROR("%d: %s\n", ret, idSolver->strError(ret));
-        return false;
+        for (int j = 0; j < 6; j++)
+        {
+            wrenches[6 * i + j] = fexts[i][j];
+        }
     }
-    else if (ret > 0)
+
+    t.resize(numJoints);
+
+    return invDynInto(qInRad.data(), qdotInRad.data(), qdotdotInRad.data(), wrenches.data(), fexts.size(), t.data());
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::fwdKinBatch(const std::vector<double> &qs, std::vector<double> &xs)
+{
+    int numJoints, count;
+    getNumJoints(&numJoints);
+
+    if (!checkBatchSize(qs.size(), numJoints, &count))
     {
-        CD_WARNING("%d: %s\n", ret, idSolver->strError(ret));
+        return false;
     }
 
-    t.resize(chain.getNrOfJoints());
+    xs.resize(6 * count);
+
+    std::atomic<int> failures(0);
 
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    batchPool->parallelFor(count, [&](int start, int end)
     {
-        t[motor] = kdlt(motor);
+        SolverLease solvers(*this);
+        std::vector<double> qInRad(numJoints);
+
+        for (int i = start; i < end; i++)
+        {
+            double * x = xs.data() + 6 * i;
+
+            for (int motor = 0; motor < numJoints; motor++)
+            {
+                qInRad[motor] = KinRepresentation::degToRad(qs[numJoints * i + motor]);
+            }
+
+            if (!solvers.isValid() || !fwdKinWith(solvers.get(), qInRad.data(), x))
+            {
+                fillNaN(x, 6);
+                failures++;
+            }
+        }
+    });
+
+    if (failures > 0)
+    {
+        CD_WARNING("%d out of %d batch entries failed.\n", failures.load(), count);
+        return false;
     }
 
     return true;
@@ -260,62 +333,123 @@ bool roboticslab::KdlSolver::invDyn(const std::vector<double> &q,std::vector<dou
 
 // -----------------------------------------------------------------------------
 
-bool roboticslab::KdlSolver::invDyn(const std::vector<double> &q,const std::vector<double> &qdot,const std::vector<double> &qdotdot, const std::vector< std::vector<double> > &fexts, std::vector<double> &t)
+bool roboticslab::KdlSolver::invKinBatch(const std::vector<double> &xds, const std::vector<double> &qGuess, std::vector<double> &qs,
+        const reference_frame frame)
 {
-    KDL::JntArray qInRad(chain.getNrOfJoints());
+    int numJoints, count;
+    getNumJoints(&numJoints);
 
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    if (!checkBatchSize(xds.size(), 6, &count))
     {
-        qInRad(motor) = KinRepresentation::degToRad(q[motor]);
+        return false;
     }
 
-    KDL::JntArray qdotInRad(chain.getNrOfJoints());
+    // Either a single initial guess shared by all entries, or one per entry.
+    bool sharedGuess = qGuess.size() == numJoints;
 
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    if (!sharedGuess && qGuess.size() != numJoints * count)
     {
-        qdotInRad(motor) = KinRepresentation::degToRad(qdot[motor]);
+        CD_ERROR("Size mismatch; expected: %d or %d, was: %d\n", numJoints, numJoints * count, (int)qGuess.size());
+        return false;
     }
 
-    KDL::JntArray qdotdotInRad(chain.getNrOfJoints());
+    qs.resize(numJoints * count);
 
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    std::atomic<int> failures(0);
+
+    batchPool->parallelFor(count, [&](int start, int end)
     {
-        qdotdotInRad(motor) = KinRepresentation::degToRad(qdotdot[motor]);
-    }
+        SolverLease solvers(*this);
+        std::vector<double> qGuessInRad(numJoints);
 
-    KDL::Wrenches wrenches(chain.getNrOfSegments(), KDL::Wrench::Zero());
+        for (int i = start; i < end; i++)
+        {
+            const double * guess = qGuess.data() + (sharedGuess ? 0 : numJoints * i);
+            double * q = qs.data() + numJoints * i;
+
+            for (int motor = 0; motor < numJoints; motor++)
+            {
+                qGuessInRad[motor] = KinRepresentation::degToRad(guess[motor]);
+            }
+
+            if (!solvers.isValid() || !invKinWith(solvers.get(), xds.data() + 6 * i, qGuessInRad.data(), q, frame, ikTimeBudget))
+            {
+                fillNaN(q, numJoints);
+                failures++;
+                continue;
+            }
+
+            for (int motor = 0; motor < numJoints; motor++)
+            {
+                q[motor] = KinRepresentation::radToDeg(q[motor]);
+            }
+        }
+    });
 
-    for (int i = 0; i < fexts.size(); i++)
+    if (failures > 0)
     {
-        wrenches[i] = KDL::Wrench(
-            KDL::Vector(fexts[i][0], fexts[i][1], fexts[i][2]),
-            KDL::Vector(fexts[i][3], fexts[i][4], fexts[i][5])
-        );
+        CD_WARNING("%d out of %d batch entries failed.\n", failures.load(), count);
+        return false;
     }
 
-    KDL::JntArray kdlt(chain.getNrOfJoints());
-    int ret;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
 
+bool roboticslab::KdlSolver::diffInvKinBatch(const std::vector<double> &qs, const std::vector<double> &xdots, std::vector<double> &qdots,
+        const reference_frame frame)
+{
+    int numJoints, count;
+    getNumJoints(&numJoints);
+
+    if (!checkBatchSize(qs.size(), numJoints, &count))
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        ret = idSolver->CartToJnt(qInRad, qdotInRad, qdotdotInRad, wrenches, kdlt);
+        return false;
     }
 
-    if (ret < 0)
+    if (xdots.size() != 6 * count)
     {
-        CD_ERROR("%d: %s\n", ret, idSolver->strError(ret));
+        CD_ERROR("Size mismatch; expected: %d, was: %d\n", 6 * count, (int)xdots.size());
         return false;
     }
-    else if (ret > 0)
+
+    qdots.resize(numJoints * count);
+
+    std::atomic<int> failures(0);
+
+    batchPool->parallelFor(count, [&](int start, int end)
     {
-        CD_WARNING("%d: %s\n", ret, idSolver->strError(ret));
-    }
+        SolverLease solvers(*this);
+        std::vector<double> qInRad(numJoints);
 
-    t.resize(chain.getNrOfJoints());
+        for (int i = start; i < end; i++)
+        {
+            double * qdot = qdots.data() + numJoints * i;
+
+            for (int motor = 0; motor < numJoints; motor++)
+            {
+                qInRad[motor] = KinRepresentation::degToRad(qs[numJoints * i + motor]);
+            }
+
+            if (!solvers.isValid() || !diffInvKinWith(solvers.get(), qInRad.data(), xdots.data() + 6 * i, qdot, frame))
+            {
+                fillNaN(qdot, numJoints);
+                failures++;
+                continue;
+            }
+
+            for (int motor = 0; motor < numJoints; motor++)
+            {
+                qdot[motor] = KinRepresentation::radToDeg(qdot[motor]);
+            }
+        }
+    });
 
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    if (failures > 0)
     {
-        t[motor] = kdlt(motor);
+        CD_WARNING("%d out of %d batch entries failed.\n", failures.load(), count);
+        return false;
     }
 
     return true;
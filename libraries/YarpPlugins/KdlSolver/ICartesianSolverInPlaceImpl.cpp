@@ -0,0 +1,538 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "KdlSolver.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+
+#include <ColorDebug.h>
+
+#include "KdlVectorConverter.hpp"
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    inline void arrayToJntArray(const double * in, KDL::JntArray & out)
+    {
+        for (int i = 0; i < out.rows(); i++)
+        {
+            out(i) = in[i];
+        }
+    }
+
+    inline void jntArrayToArray(const KDL::JntArray & in, double * out)
+    {
+        for (int i = 0; i < in.rows(); i++)
+        {
+            out[i] = in(i);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::fwdKinInto(const double * q, double * x)
+{
+    SolverLease solvers(*this);
+
+    if (!solvers.isValid())
+    {
+        return false;
+    }
+
+    return fwdKinWith(solvers.get(), q, x);
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::fwdKinWith(SolverSet * solvers, const double * q, double * x)
+{
+    arrayToJntArray(q, solvers->qIn);
+
+    KDL::Frame fOutCart;
+    solvers->fkSolverPos->JntToCart(solvers->qIn, fOutCart);
+
+    KdlVectorConverter::frameToArray(fOutCart, x);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::poseDiffInto(const double * xLhs, const double * xRhs, double * xOut)
+{
+    KDL::Frame fLhs = KdlVectorConverter::arrayToFrame(xLhs);
+    KDL::Frame fRhs = KdlVectorConverter::arrayToFrame(xRhs);
+
+    KDL::Twist diff = KDL::diff(fRhs, fLhs); // [fLhs - fRhs] for translation
+    KdlVectorConverter::twistToArray(diff, xOut);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::fwdKinJacInto(const double * q, double * x, double * J)
+{
+    SolverLease solvers(*this);
+
+    if (!solvers.isValid())
+    {
+        return false;
+    }
+
+    arrayToJntArray(q, solvers->qIn);
+
+    KDL::Frame fOutCart;
+    int ret = solvers->fkJacSolver->JntToCartJac(solvers->qIn, fOutCart, solvers->jacobian);
+
+    if (ret < 0)
+    {
+        CD_ERROR("%d: %s\n", ret, solvers->fkJacSolver->strError(ret));
+        return false;
+    }
+
+    KdlVectorConverter::frameToArray(fOutCart, x);
+    Eigen::Map<Eigen::Matrix<double, 6, Eigen::Dynamic> >(J, 6, solvers->jacobian.columns()) = solvers->jacobian.data;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::invKinInto(const double * xd, const double * qGuess, double * q, const reference_frame frame)
+{
+    SolverLease solvers(*this);
+
+    if (!solvers.isValid())
+    {
+        return false;
+    }
+
+    return invKinWith(solvers.get(), xd, qGuess, q, frame, ikTimeBudget);
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::invKinWith(SolverSet * solvers, const double * xd, const double * qGuess, double * q, const reference_frame frame,
+        double budget, double * residual)
+{
+    KDL::Frame frameXd = KdlVectorConverter::arrayToFrame(xd);
+    arrayToJntArray(qGuess, solvers->qIn);
+
+    if (frame == TCP_FRAME)
+    {
+        KDL::Frame fOutCart;
+        solvers->fkSolverPos->JntToCart(solvers->qIn, fOutCart);
+        frameXd = fOutCart * frameXd;
+    }
+    else if (frame != BASE_FRAME)
+    {
+        CD_WARNING("Unsupported frame.\n");
+        return false;
+    }
+
+    KDL::ChainIkSolverPos * ikSolverPos = solvers->ikSolverPos;
+    bool race = ikStarts > 1 && solvers->ikSolverPosAnytime != NULL;
+
+    if ((budget > 0.0 || race) && solvers->ikSolverPosAnytime != NULL)
+    {
+        solvers->ikSolverPosAnytime->setBudget(budget);
+        ikSolverPos = solvers->ikSolverPosAnytime;
+    }
+
+    int ret;
+    bool cached = false;
+
+    if (ikResultCache != NULL)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        if (solvers->chain == std::atomic_load(&currentChain))
+        {
+            cached = ikResultCache->find(frameXd, solvers->qIn, solvers->qOut);
+
+            unsigned long lookups = ikResultCache->getHits() + ikResultCache->getMisses();
+
+            if (ikResultCacheReport > 0 && lookups % ikResultCacheReport == 0)
+            {
+                CD_INFO("IK result cache: %lu hits, %lu misses, %d/%d entries.\n", ikResultCache->getHits(),
+                        ikResultCache->getMisses(), ikResultCache->size(), ikResultCache->getCapacity());
+            }
+        }
+    }
+
+    if (cached)
+    {
+        ret = KDL::SolverI::E_NOERROR;
+    }
+    else
+    {
+        ret = race ? raceSeeds(solvers, frameXd, budget) : ikSolverPos->CartToJnt(solvers->qIn, frameXd, solvers->qOut);
+
+        // Only exact solutions are worth remembering, unless the chain has changed meanwhile.
+        if (ikResultCache != NULL && ret == KDL::SolverI::E_NOERROR)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+
+            if (solvers->chain == std::atomic_load(&currentChain))
+            {
+                ikResultCache->insert(frameXd, solvers->qIn, solvers->qOut);
+            }
+        }
+    }
+
+    if (ret < 0)
+    {
+        CD_ERROR("%d: %s\n", ret, ikSolverPos->strError(ret));
+        return false;
+    }
+    else if (ret > 0)
+    {
+        CD_WARNING("%d: %s\n", ret, ikSolverPos->strError(ret));
+    }
+
+    if (residual != NULL)
+    {
+        KDL::Frame fOutCart;
+        solvers->fkSolverPos->JntToCart(solvers->qOut, fOutCart);
+
+        KDL::Twist delta = KDL::diff(fOutCart, frameXd);
+        *residual = std::sqrt(KDL::dot(delta.vel, delta.vel) + KDL::dot(delta.rot, delta.rot));
+    }
+
+    jntArrayToArray(solvers->qOut, q);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+int roboticslab::KdlSolver::raceSeeds(SolverSet * solvers, const KDL::Frame & frameXd, double budget)
+{
+    std::atomic<bool> converged(false);
+    std::mutex resultMtx;
+
+    int winner = -1;
+    int winnerRet = KDL::SolverI::E_NO_CONVERGE;
+    double winnerResidual = std::numeric_limits<double>::infinity();
+
+    //-- Solve from the i-th seed on the given set, the initial guess is already stored in qIn.
+    auto runSeed = [&](int i, SolverSet * set, KDL::JntArray & qOut)
+    {
+        KDL::JntArray & seed = set->qIn;
+
+        if (i > 0 && i <= (int)ikHomePoses.size())
+        {
+            seed = ikHomePoses[i - 1];
+        }
+        else if (i > 0)
+        {
+            for (int j = 0; j < seed.rows(); j++)
+            {
+                seed(j) = std::uniform_real_distribution<double>(qMin(j), qMax(j))(set->rng);
+            }
+        }
+
+        ChainIkSolverPos_Anytime * solver = set->ikSolverPosAnytime;
+        solver->setBudget(budget);
+        solver->setCancelFlag(&converged);
+
+        int ret = solver->CartToJnt(seed, frameXd, qOut);
+
+        solver->setCancelFlag(NULL);
+
+        std::lock_guard<std::mutex> lock(resultMtx);
+
+        if (ret < 0)
+        {
+            if (winner < 0)
+            {
+                winnerRet = ret;
+            }
+
+            return;
+        }
+
+        //-- The first seed to converge wins, otherwise the one closest to the target.
+        if (ret == KDL::SolverI::E_NOERROR ? !converged.exchange(true) : !converged && solver->getResidual() < winnerResidual)
+        {
+            winner = i;
+            winnerRet = ret;
+            winnerResidual = solver->getResidual();
+            solvers->qOut = qOut;
+        }
+    };
+
+    //-- Other seeds borrow a solver set of their own.
+    auto runLeasedSeed = [&](int i)
+    {
+        SolverLease lease(*this);
+
+        // Chain changed meanwhile, this seed would solve a different problem.
+        if (!lease.isValid() || lease->chain != solvers->chain)
+        {
+            return;
+        }
+
+        runSeed(i, lease.get(), lease->qOut);
+    };
+
+    //-- One thread per seed spawned by this very call, hence concurrent callers (e.g. batch
+    //-- workers) race on their own instead of queuing up behind a shared pool.
+    std::vector<std::thread> racers;
+
+    for (int i = 1; i < ikStarts; i++)
+    {
+        racers.push_back(std::thread(runLeasedSeed, i));
+    }
+
+    //-- The calling thread takes the initial guess on the caller's solver set, which is
+    //-- bound to the right snapshot even if the chain is being replaced right now.
+    runSeed(0, solvers, solvers->qRace);
+
+    for (int i = 0; i < racers.size(); i++)
+    {
+        racers[i].join();
+    }
+
+    if (winner < 0)
+    {
+        return winnerRet;
+    }
+
+    //-- 0: initial guess, 1: home pose, 2: random.
+    int kind = winner == 0 ? 0 : winner <= (int)ikHomePoses.size() ? 1 : 2;
+    CD_DEBUG("Multi-start IK: seed %d (kind %d) won, residual %f.\n", winner, kind, winnerResidual);
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ikStartWins[kind]++;
+    }
+
+    return winnerRet;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::diffInvKinInto(const double * q, const double * xdot, double * qdot, const reference_frame frame)
+{
+    SolverLease solvers(*this);
+
+    if (!solvers.isValid())
+    {
+        return false;
+    }
+
+    return diffInvKinWith(solvers.get(), q, xdot, qdot, frame);
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::diffInvKinWith(SolverSet * solvers, const double * q, const double * xdot, double * qdot, const reference_frame frame)
+{
+    if (frame != BASE_FRAME && frame != TCP_FRAME)
+    {
+        CD_WARNING("Unsupported frame.\n");
+        return false;
+    }
+
+    arrayToJntArray(q, solvers->qIn);
+
+    //-- Current pose and Jacobian in a single pass.
+    KDL::Frame fOutCart;
+    int ret = solvers->fkJacSolver->JntToCartJac(solvers->qIn, fOutCart, solvers->jacobian);
+
+    if (ret < 0)
+    {
+        CD_ERROR("%d: %s\n", ret, solvers->fkJacSolver->strError(ret));
+        return false;
+    }
+
+    KDL::Twist kdlxdot = KdlVectorConverter::arrayToTwist(xdot);
+
+    if (frame == TCP_FRAME)
+    {
+        //-- Transform the basis to which the twist is expressed, but leave the reference point intact
+        //-- "Twist and Wrench transformations" @ http://docs.ros.org/latest/api/orocos_kdl/html/geomprim.html
+        kdlxdot = fOutCart.M * kdlxdot;
+    }
+
+    if (!solveVelocity(solvers, kdlxdot, solvers->qOut))
+    {
+        return false;
+    }
+
+    jntArrayToArray(solvers->qOut, qdot);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::diffInvKinJacInto(const double * x, const double * J, const double * xdot, double * qdot,
+        const reference_frame frame)
+{
+    SolverLease solvers(*this);
+
+    if (!solvers.isValid())
+    {
+        return false;
+    }
+
+    KDL::Twist kdlxdot = KdlVectorConverter::arrayToTwist(xdot);
+
+    if (frame == TCP_FRAME)
+    {
+        kdlxdot = KdlVectorConverter::arrayToFrame(x).M * kdlxdot;
+    }
+    else if (frame != BASE_FRAME)
+    {
+        CD_WARNING("Unsupported frame.\n");
+        return false;
+    }
+
+    solvers->jacobian.data = Eigen::Map<const Eigen::Matrix<double, 6, Eigen::Dynamic> >(J, 6, solvers->jacobian.columns());
+
+    if (!solveVelocity(solvers.get(), kdlxdot, solvers->qOut))
+    {
+        return false;
+    }
+
+    jntArrayToArray(solvers->qOut, qdot);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::solveVelocity(SolverSet * solvers, const KDL::Twist & xdot, KDL::JntArray & qdot) const
+{
+    int ret = solvers->jacIkSolverVel->JacToJnt(solvers->jacobian, xdot, qdot);
+
+    if (ret < 0)
+    {
+        CD_ERROR("%d: %s\n", ret, solvers->jacIkSolverVel->strError(ret));
+        return false;
+    }
+    else if (ret > 0)
+    {
+        CD_WARNING("%d: %s\n", ret, solvers->jacIkSolverVel->strError(ret));
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::invDynInto(const double * q, double * t)
+{
+    SolverLease solvers(*this);
+
+    if (!solvers.isValid())
+    {
+        return false;
+    }
+
+    arrayToJntArray(q, solvers->qIn);
+    KDL::SetToZero(solvers->qdotIn);
+    KDL::SetToZero(solvers->qdotdotIn);
+
+    for (int i = 0; i < solvers->wrenches.size(); i++)
+    {
+        solvers->wrenches[i] = KDL::Wrench::Zero();
+    }
+
+    int ret = solvers->idSolver->CartToJnt(solvers->qIn, solvers->qdotIn, solvers->qdotdotIn, solvers->wrenches, solvers->qOut);
+
+    if (ret < 0)
+    {
+        CD_ERROR("%d: %s\n", ret, solvers->idSolver->strError(ret));
+        return false;
+    }
+    else if (ret > 0)
+    {
+        CD_WARNING("%d: %s\n", ret, solvers->idSolver->strError(ret));
+    }
+
+    jntArrayToArray(solvers->qOut, t);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::invDynInto(const double * q, const double * qdot, const double * qdotdot, const double * fexts,
+        int numFexts, double * t)
+{
+    SolverLease solvers(*this);
+
+    if (!solvers.isValid())
+    {
+        return false;
+    }
+
+    if (numFexts > solvers->wrenches.size())
+    {
+        CD_WARNING("Too many external wrenches: %d (chain has %d segments).\n", numFexts, (int)solvers->wrenches.size());
+        return false;
+    }
+
+    arrayToJntArray(q, solvers->qIn);
+    arrayToJntArray(qdot, solvers->qdotIn);
+    arrayToJntArray(qdotdot, solvers->qdotdotIn);
+
+    for (int i = 0; i < solvers->wrenches.size(); i++)
+    {
+        if (i < numFexts)
+        {
+            const double * fext = fexts + 6 * i;
+            solvers->wrenches[i] = KDL::Wrench(KDL::Vector(fext[0], fext[1], fext[2]), KDL::Vector(fext[3], fext[4], fext[5]));
+        }
+        else
+        {
+            solvers->wrenches[i] = KDL::Wrench::Zero();
+        }
+    }
+
+    int ret = solvers->idSolver->CartToJnt(solvers->qIn, solvers->qdotIn, solvers->qdotdotIn, solvers->wrenches, solvers->qOut);
+
+    if (ret < 0)
+    {
+        CD_ERROR("%d: %s\n", ret, solvers->idSolver->strError(ret));
+        return false;
+    }
+    else if (ret > 0)
+    {
+        CD_WARNING("%d: %s\n", ret, solvers->idSolver->strError(ret));
+    }
+
+    jntArrayToArray(solvers->qOut, t);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::getIkResultCacheStats(unsigned long * hits, unsigned long * misses)
+{
+    if (ikResultCache == NULL)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    *hits = ikResultCache->getHits();
+    *misses = ikResultCache->getMisses();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,113 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "IkResultCache.hpp"
+
+#include <cmath>
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    inline long long quantize(double value, double step)
+    {
+        return std::llround(value / step);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+IkResultCache::IkResultCache(int _capacity, double _positionStep, double _orientationStep, double _seedStep)
+    : capacity(_capacity),
+      positionStep(_positionStep),
+      orientationStep(_orientationStep),
+      seedStep(_seedStep),
+      hits(0),
+      misses(0)
+{}
+
+// -----------------------------------------------------------------------------
+
+bool IkResultCache::find(const KDL::Frame & H, const KDL::JntArray & qGuess, KDL::JntArray & q)
+{
+    std::map<Key, Entries::iterator>::iterator it = index.find(makeKey(H, qGuess));
+
+    if (it == index.end())
+    {
+        misses++;
+        return false;
+    }
+
+    // Move to front, iterators remain valid.
+    entries.splice(entries.begin(), entries, it->second);
+
+    q = it->second->second;
+    hits++;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void IkResultCache::insert(const KDL::Frame & H, const KDL::JntArray & qGuess, const KDL::JntArray & q)
+{
+    if (capacity <= 0)
+    {
+        return;
+    }
+
+    Key key = makeKey(H, qGuess);
+    std::map<Key, Entries::iterator>::iterator it = index.find(key);
+
+    if (it != index.end())
+    {
+        it->second->second = q;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    if (size() >= capacity)
+    {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+
+    entries.push_front(std::make_pair(key, q));
+    index[key] = entries.begin();
+}
+
+// -----------------------------------------------------------------------------
+
+void IkResultCache::clear()
+{
+    entries.clear();
+    index.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+IkResultCache::Key IkResultCache::makeKey(const KDL::Frame & H, const KDL::JntArray & qGuess) const
+{
+    Key key;
+    key.reserve(3 + 9 + qGuess.rows());
+
+    for (int i = 0; i < 3; i++)
+    {
+        key.push_back(quantize(H.p(i), positionStep));
+    }
+
+    for (int i = 0; i < 9; i++)
+    {
+        key.push_back(quantize(H.M.data[i], orientationStep));
+    }
+
+    for (int i = 0; i < qGuess.rows(); i++)
+    {
+        key.push_back(quantize(qGuess(i), seedStep));
+    }
+
+    return key;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,101 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __IK_RESULT_CACHE_HPP__
+#define __IK_RESULT_CACHE_HPP__
+
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup KdlSolver
+ * @brief Least-recently-used cache of inverse kinematics results.
+ *
+ * Entries are keyed by the target frame and the initial guess, both quantized with
+ * configurable step sizes. Any query that falls in the same cell of this grid will
+ * return the stored joint values, thus the step sizes bound the error introduced
+ * by a cache hit. The oldest entry is evicted once the capacity is exceeded.
+ *
+ * This class is not thread-safe, callers must provide their own locking.
+ */
+class IkResultCache
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param capacity Maximum number of entries.
+     * @param positionStep Quantization step of the target position (meters).
+     * @param orientationStep Quantization step of each element of the target
+     * rotation matrix (approximately radians).
+     * @param seedStep Quantization step of the initial guess (radians or meters).
+     */
+    IkResultCache(int capacity, double positionStep, double orientationStep, double seedStep);
+
+    /**
+     * @brief Look up the IK result for a target frame and an initial guess.
+     *
+     * @param H Target frame.
+     * @param qGuess Initial guess of the joint coordinates.
+     * @param q Output joint coordinates, untouched on a miss.
+     *
+     * @return True on a hit, false on a miss.
+     */
+    bool find(const KDL::Frame & H, const KDL::JntArray & qGuess, KDL::JntArray & q);
+
+    /**
+     * @brief Store the IK result for a target frame and an initial guess.
+     *
+     * @param H Target frame.
+     * @param qGuess Initial guess of the joint coordinates.
+     * @param q Joint coordinates found by the IK solver.
+     */
+    void insert(const KDL::Frame & H, const KDL::JntArray & qGuess, const KDL::JntArray & q);
+
+    /** @brief Remove all entries, e.g. after a change in the kinematic chain. Counters are kept. */
+    void clear();
+
+    /** @brief Number of entries. */
+    int size() const
+    { return index.size(); }
+
+    /** @brief Maximum number of entries. */
+    int getCapacity() const
+    { return capacity; }
+
+    /** @brief Number of lookups that found an entry. */
+    unsigned long getHits() const
+    { return hits; }
+
+    /** @brief Number of lookups that didn't find an entry. */
+    unsigned long getMisses() const
+    { return misses; }
+
+private:
+
+    typedef std::vector<long long> Key;
+    typedef std::list<std::pair<Key, KDL::JntArray> > Entries;
+
+    Key makeKey(const KDL::Frame & H, const KDL::JntArray & qGuess) const;
+
+    const int capacity;
+    const double positionStep, orientationStep, seedStep;
+
+    // Most recently used entries first.
+    Entries entries;
+    std::map<Key, Entries::iterator> index;
+
+    unsigned long hits, misses;
+};
+
+}  // namespace roboticslab
+
+#endif  // __IK_RESULT_CACHE_HPP__
@@ -0,0 +1,228 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "JacobianIkSolverVel.hpp"
+
+#include <cmath>
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    // Singular values below this threshold are neglected, as in KDL::ChainIkSolverVel_pinv.
+    const double PINV_EPS = 1e-5;
+
+    // Columns are deemed orthogonal below this relative dot product.
+    const double WSVD_TOLERANCE = 1e-12;
+
+    // Columns below this norm, relative to the whole matrix, are numerically null and left alone.
+    const double WSVD_NULL_TOLERANCE = 1e-12;
+
+    // Upper bound of sweeps per call, a cold start rarely needs more than ten.
+    const int WSVD_MAX_SWEEPS = 30;
+
+    // Restart from the identity now and then, rounding errors pile up in V otherwise.
+    const int WSVD_RESTART_PERIOD = 1000;
+
+    inline void twistToVector(const KDL::Twist & in, Eigen::Matrix<double, 6, 1> & out)
+    {
+        out << in.vel.x(), in.vel.y(), in.vel.z(), in.rot.x(), in.rot.y(), in.rot.z();
+    }
+
+    template <typename Matrix>
+    inline void rotateColumns(Matrix & M, int i, int j, double c, double s)
+    {
+        for (int k = 0; k < M.rows(); k++)
+        {
+            double mi = M(k, i);
+            double mj = M(k, j);
+            M(k, i) = c * mi - s * mj;
+            M(k, j) = s * mi + c * mj;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+JacobianIkSolverVel * JacobianIkSolverVel::create(const std::string & type, int joints, double damping)
+{
+    if (type == "pinv")
+    {
+        return new JacobianIkSolverVel_pinv(joints);
+    }
+    else if (type == "wsvd" && joints <= MAX_FIXED_JOINTS)
+    {
+        return new JacobianIkSolverVel_wsvd(joints);
+    }
+    else if (type == "dls" && damping > 0.0)
+    {
+        return new JacobianIkSolverVel_dls(damping);
+    }
+
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+
+JacobianIkSolverVel_pinv::JacobianIkSolverVel_pinv(int joints)
+    : svd(6, joints, Eigen::ComputeThinU | Eigen::ComputeThinV)
+{}
+
+// -----------------------------------------------------------------------------
+
+int JacobianIkSolverVel_pinv::JacToJnt(const KDL::Jacobian & jac, const KDL::Twist & v_in, KDL::JntArray & qdot_out)
+{
+    if (jac.columns() != qdot_out.rows())
+    {
+        return (error = E_SIZE_MISMATCH);
+    }
+
+    Eigen::Matrix<double, 6, 1> v;
+    twistToVector(v_in, v);
+
+    svd.compute(jac.data);
+
+    const Eigen::VectorXd & S = svd.singularValues();
+
+    //-- Accumulated column by column to avoid temporaries.
+    qdot_out.data.setZero();
+
+    for (int i = 0; i < S.size(); i++)
+    {
+        if (S(i) >= PINV_EPS)
+        {
+            qdot_out.data += (svd.matrixU().col(i).dot(v) / S(i)) * svd.matrixV().col(i);
+        }
+    }
+
+    return (error = E_NOERROR);
+}
+
+// -----------------------------------------------------------------------------
+
+JacobianIkSolverVel_wsvd::JacobianIkSolverVel_wsvd(int joints)
+    : A(6, joints),
+      V(MatrixV::Identity(joints, joints)),
+      calls(0),
+      sweeps(0)
+{}
+
+// -----------------------------------------------------------------------------
+
+int JacobianIkSolverVel_wsvd::JacToJnt(const KDL::Jacobian & jac, const KDL::Twist & v_in, KDL::JntArray & qdot_out)
+{
+    const int n = V.cols();
+
+    if (jac.columns() != (unsigned int)n || qdot_out.rows() != (unsigned int)n)
+    {
+        return (error = E_SIZE_MISMATCH);
+    }
+
+    if (++calls >= WSVD_RESTART_PERIOD)
+    {
+        V.setIdentity();
+        calls = 0;
+    }
+
+    //-- Warm start: columns of J*V are nearly orthogonal if J barely changed since the last call.
+    A.noalias() = jac.data * V;
+
+    //-- Invariant under rotations.
+    const double nullSq = WSVD_NULL_TOLERANCE * WSVD_NULL_TOLERANCE * A.squaredNorm();
+
+    for (sweeps = 0; sweeps < WSVD_MAX_SWEEPS; sweeps++)
+    {
+        bool rotated = false;
+
+        for (int i = 0; i < n - 1; i++)
+        {
+            for (int j = i + 1; j < n; j++)
+            {
+                double alpha = A.col(i).squaredNorm();
+                double beta = A.col(j).squaredNorm();
+                double gamma = A.col(i).dot(A.col(j));
+
+                if (alpha <= nullSq || beta <= nullSq || std::abs(gamma) <= WSVD_TOLERANCE * std::sqrt(alpha * beta))
+                {
+                    continue;
+                }
+
+                double zeta = (beta - alpha) / (2.0 * gamma);
+                double t = (zeta >= 0.0 ? 1.0 : -1.0) / (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                double c = 1.0 / std::sqrt(1.0 + t * t);
+                double s = c * t;
+
+                rotateColumns(A, i, j, c, s);
+                rotateColumns(V, i, j, c, s);
+                rotated = true;
+            }
+        }
+
+        if (!rotated)
+        {
+            break;
+        }
+    }
+
+    Eigen::Matrix<double, 6, 1> v;
+    twistToVector(v_in, v);
+
+    //-- J = U*S*V^T, where column i of A equals U_i*S_i, hence pinv(J)*v = sum(V_i * (A_i . v) / S_i^2).
+    qdot_out.data.setZero();
+
+    for (int i = 0; i < n; i++)
+    {
+        double sigmaSq = A.col(i).squaredNorm();
+
+        if (sigmaSq >= PINV_EPS * PINV_EPS)
+        {
+            qdot_out.data += (A.col(i).dot(v) / sigmaSq) * V.col(i);
+        }
+    }
+
+    if (sweeps == WSVD_MAX_SWEEPS)
+    {
+        //-- Columns are still not quite orthogonal, start over next time.
+        V.setIdentity();
+        calls = 0;
+        return (error = E_DEGRADED);
+    }
+
+    return (error = E_NOERROR);
+}
+
+// -----------------------------------------------------------------------------
+
+JacobianIkSolverVel_dls::JacobianIkSolverVel_dls(double damping)
+    : lambdaSq(damping * damping)
+{}
+
+// -----------------------------------------------------------------------------
+
+int JacobianIkSolverVel_dls::JacToJnt(const KDL::Jacobian & jac, const KDL::Twist & v_in, KDL::JntArray & qdot_out)
+{
+    if (jac.columns() != qdot_out.rows())
+    {
+        return (error = E_SIZE_MISMATCH);
+    }
+
+    JJt.noalias() = jac.data * jac.data.transpose();
+    JJt.diagonal().array() += lambdaSq;
+
+    llt.compute(JJt);
+
+    if (llt.info() != Eigen::Success)
+    {
+        return (error = E_UNDEFINED);
+    }
+
+    twistToVector(v_in, y);
+    llt.solveInPlace(y);
+
+    qdot_out.data.noalias() = jac.data.transpose() * y;
+
+    return (error = E_NOERROR);
+}
+
+// -----------------------------------------------------------------------------
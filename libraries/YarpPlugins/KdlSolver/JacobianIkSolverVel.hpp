@@ -0,0 +1,141 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __JACOBIAN_IK_SOLVER_VEL_HPP__
+#define __JACOBIAN_IK_SOLVER_VEL_HPP__
+
+#include <string>
+
+#include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/solveri.hpp>
+
+#include <Eigen/Core>
+#include <Eigen/Cholesky>
+#include <Eigen/SVD>
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup KdlSolver
+ * @brief Differential IK solver working on a precomputed Jacobian.
+ *
+ * Unlike KDL::ChainIkSolverVel, no chain is involved: the caller supplies a 6xN
+ * Jacobian expressed in the same frame as the desired twist. All storage is
+ * allocated on construction.
+ */
+class JacobianIkSolverVel : public KDL::SolverI
+{
+public:
+
+    //! Largest number of joints supported by solvers with fixed-size storage.
+    static const int MAX_FIXED_JOINTS = 8;
+
+    /**
+     * @brief Find joint velocities
+     *
+     * @param jac Input Jacobian, as many columns as joints.
+     * @param v_in Input cartesian velocity.
+     * @param qdot_out Output joint velocities.
+     *
+     * @return Return code, < 0 if something went wrong.
+     */
+    virtual int JacToJnt(const KDL::Jacobian & jac, const KDL::Twist & v_in, KDL::JntArray & qdot_out) = 0;
+
+    /**
+     * @brief Factory method
+     *
+     * @param type Algorithm: "pinv", "wsvd" or "dls".
+     * @param joints Number of joints.
+     * @param damping Damping factor, only used by "dls".
+     *
+     * @return A new solver, or NULL if the algorithm is unknown or does not support
+     * this number of joints.
+     */
+    static JacobianIkSolverVel * create(const std::string & type, int joints, double damping);
+};
+
+/**
+ * @ingroup KdlSolver
+ * @brief Truncated pseudoinverse through a full SVD on each call.
+ *
+ * Same results as KDL::ChainIkSolverVel_pinv.
+ */
+class JacobianIkSolverVel_pinv : public JacobianIkSolverVel
+{
+public:
+
+    explicit JacobianIkSolverVel_pinv(int joints);
+
+    virtual int JacToJnt(const KDL::Jacobian & jac, const KDL::Twist & v_in, KDL::JntArray & qdot_out);
+
+    virtual void updateInternalDataStructures() {}
+
+private:
+
+    Eigen::JacobiSVD<Eigen::MatrixXd> svd;
+};
+
+/**
+ * @ingroup KdlSolver
+ * @brief Truncated pseudoinverse through a warm-started one-sided Jacobi SVD.
+ *
+ * Hestenes' method orthogonalizes the columns of J*V by plane rotations that are
+ * accumulated into V. The V obtained on the previous call is taken as the initial
+ * guess, thus a few rotations are enough when the Jacobian changes slowly, as in
+ * streaming control loops. Storage is fixed-size, up to MAX_FIXED_JOINTS joints.
+ */
+class JacobianIkSolverVel_wsvd : public JacobianIkSolverVel
+{
+public:
+
+    explicit JacobianIkSolverVel_wsvd(int joints);
+
+    virtual int JacToJnt(const KDL::Jacobian & jac, const KDL::Twist & v_in, KDL::JntArray & qdot_out);
+
+    virtual void updateInternalDataStructures() {}
+
+    //! Number of sweeps performed on the last call.
+    int getSweeps() const
+    { return sweeps; }
+
+private:
+
+    typedef Eigen::Matrix<double, 6, Eigen::Dynamic, Eigen::ColMajor, 6, MAX_FIXED_JOINTS> MatrixA;
+    typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MAX_FIXED_JOINTS, MAX_FIXED_JOINTS> MatrixV;
+
+    MatrixA A;
+    MatrixV V;
+    int calls;
+    int sweeps;
+};
+
+/**
+ * @ingroup KdlSolver
+ * @brief Damped least squares through a Cholesky factorization.
+ *
+ * Solves qdot = J^T * (J * J^T + lambda^2 * I)^-1 * v, where the matrix to be
+ * factorized is always 6x6 regardless of the number of joints.
+ */
+class JacobianIkSolverVel_dls : public JacobianIkSolverVel
+{
+public:
+
+    explicit JacobianIkSolverVel_dls(double damping);
+
+    virtual int JacToJnt(const KDL::Jacobian & jac, const KDL::Twist & v_in, KDL::JntArray & qdot_out);
+
+    virtual void updateInternalDataStructures() {}
+
+private:
+
+    double lambdaSq;
+    Eigen::Matrix<double, 6, 6> JJt;
+    Eigen::LLT<Eigen::Matrix<double, 6, 6> > llt;
+    Eigen::Matrix<double, 6, 1> y;
+};
+
+}  // namespace roboticslab
+
+#endif  // __JACOBIAN_IK_SOLVER_VEL_HPP__
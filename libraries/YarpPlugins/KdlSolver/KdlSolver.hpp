@@ -3,7 +3,12 @@
 #ifndef __KDL_SOLVER_HPP__
 #define __KDL_SOLVER_HPP__
 
+#include <algorithm>
+#include <memory>
 #include <mutex>
+#include <random>
+#include <string>
+#include <vector>
 
 #include <yarp/dev/DeviceDriver.h>
 
@@ -11,10 +16,23 @@
 #include <kdl/chainfksolver.hpp>
 #include <kdl/chainiksolver.hpp>
 #include <kdl/chainidsolver.hpp>
+#include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
+#include <kdl/jntarray.hpp>
+
+#include <Eigen/Core>
 
 #include <iostream> // only windows
 
 #include "ICartesianSolver.h"
+#include "ICartesianSolverInPlace.h"
+#include "ChainFkJacSolver.hpp"
+#include "ChainIkSolverPos_Anytime.hpp"
+#include "JacobianIkSolverVel.hpp"
+#include "ConfigurationSelector.hpp"
+#include "ScrewTheoryIkProblemCache.hpp"
+#include "IkResultCache.hpp"
+#include "ThreadPool.hpp"
 
 #define DEFAULT_KINEMATICS "none.ini"  // string
 #define DEFAULT_NUM_LINKS 1  // int
@@ -25,10 +43,24 @@
 #define DEFAULT_MAXACC 0.2      // unit/s^2
 
 #define DEFAULT_EPS 1e-9
+#define DEFAULT_ID_EPS 1e-4
 #define DEFAULT_MAXITER 1000
 #define DEFAULT_IK_SOLVER "lma"
+#define DEFAULT_IK_VEL_SOLVER "pinv"
+#define DEFAULT_IK_VEL_DAMPING 0.01  // only for dls
 #define DEFAULT_LMA_WEIGHTS "1 1 1 0.1 0.1 0.1"
 #define DEFAULT_STRATEGY "leastOverallAngularDisplacement"
+#define DEFAULT_IK_CACHE_DIR ""  // in-memory only
+#define DEFAULT_IK_BRANCH_LOCK 0.0  // degrees, disabled
+#define DEFAULT_IK_RESULT_CACHE_SIZE 0  // entries, disabled
+#define DEFAULT_IK_RESULT_CACHE_POS_STEP 1e-4  // meters
+#define DEFAULT_IK_RESULT_CACHE_ROT_STEP 1e-4  // rotation matrix elements
+#define DEFAULT_IK_RESULT_CACHE_SEED_STEP 1.0  // degrees
+#define DEFAULT_IK_RESULT_CACHE_REPORT 0  // lookups between hit/miss reports, disabled
+#define DEFAULT_BATCH_THREADS 0  // hardware concurrency
+#define DEFAULT_IK_TIME_BUDGET 0.0  // seconds, disabled
+#define DEFAULT_IK_TIME_BUDGET_ITER 10  // iterations between deadline checks
+#define DEFAULT_IK_STARTS 1  // seeds, multi-start disabled
 
 namespace roboticslab
 {
@@ -42,19 +74,47 @@ namespace roboticslab
 
 /**
  * @ingroup KdlSolver
- * @brief The KdlSolver class implements ICartesianSolver.
+ * @brief The KdlSolver class implements ICartesianSolver and ICartesianSolverInPlace.
+ *
+ * KDL solvers are not reentrant, hence each query borrows a whole set of them from
+ * a pool of idle instances, which grows on demand up to the number of concurrent
+ * callers. The kinematic chain is an immutable snapshot: changes build a new one
+ * along with fresh solvers, then publish it atomically. Queries in flight keep
+ * using the previous snapshot until they finish, without ever waiting for the
+ * rebuild to complete. Each solver set carries preallocated joint arrays, hence
+ * ICartesianSolverInPlace queries do not allocate memory. Batch queries are split
+ * among the threads of a pool, each chunk borrowing a single solver set. The
+ * velocity IK algorithm is selected with the ikVel option: a full SVD on each call
+ * (pinv), a one-sided Jacobi SVD warm-started from the solver set's previous call
+ * (wsvd), or damped least squares (dls). Iterative position IK solvers (lma, nrjl, id)
+ * may be given a time budget, either per device (ikTimeBudget option) or per query
+ * (see invKinBudget), after which the best solution found so far is returned.
+ * They may also race from several seeds at once (ikStarts option): the initial
+ * guess, a few home poses and random samples within joint limits.
  */
 
-class KdlSolver : public yarp::dev::DeviceDriver, public ICartesianSolver
+class KdlSolver : public yarp::dev::DeviceDriver,
+                  public ICartesianSolver,
+                  public ICartesianSolverInPlace
 {
     public:
 
         KdlSolver()
-            : fkSolverPos(NULL),
-              ikSolverPos(NULL),
-              ikSolverVel(NULL),
-              idSolver(NULL)
-        {}
+            : maxIter(DEFAULT_MAXITER),
+              eps(DEFAULT_EPS),
+              branchLock(DEFAULT_IK_BRANCH_LOCK),
+              ikConfigFactory(NULL),
+              ikVelDamping(DEFAULT_IK_VEL_DAMPING),
+              ikTimeBudget(DEFAULT_IK_TIME_BUDGET),
+              ikTimeBudgetIter(DEFAULT_IK_TIME_BUDGET_ITER),
+              ikStarts(DEFAULT_IK_STARTS),
+              ikProblemCache(NULL),
+              ikResultCache(NULL),
+              ikResultCacheReport(DEFAULT_IK_RESULT_CACHE_REPORT),
+              batchPool(NULL)
+        {
+            std::fill(ikStartWins, ikStartWins + 3, 0);
+        }
 
         // -- ICartesianSolver declarations. Implementation in ICartesianSolverImpl.cpp--
 
@@ -81,6 +141,9 @@ class KdlSolver : public yarp::dev::DeviceDriver, public ICartesianSolver
         // Perform inverse kinematics.
         virtual bool invKin(const std::vector<double> &xd, const std::vector<double> &qGuess, std::vector<double> &q, const reference_frame frame);
 
+        // Perform inverse kinematics within a time budget.
+        virtual bool invKinBudget(const std::vector<double> &xd, const std::vector<double> &qGuess, double budget, std::vector<double> &q, double &residual, const reference_frame frame);
+
         // Perform differential inverse kinematics.
         virtual bool diffInvKin(const std::vector<double> &q, const std::vector<double> &xdot, std::vector<double> &qdot, const reference_frame frame);
 
@@ -90,6 +153,44 @@ class KdlSolver : public yarp::dev::DeviceDriver, public ICartesianSolver
         // Perform inverse dynamics.
         virtual bool invDyn(const std::vector<double> &q,const std::vector<double> &qdot,const std::vector<double> &qdotdot, const std::vector< std::vector<double> > &fexts, std::vector<double> &t);
 
+        // Perform forward kinematics on a batch of joint positions.
+        virtual bool fwdKinBatch(const std::vector<double> &qs, std::vector<double> &xs);
+
+        // Perform inverse kinematics on a batch of poses.
+        virtual bool invKinBatch(const std::vector<double> &xds, const std::vector<double> &qGuess, std::vector<double> &qs, const reference_frame frame);
+
+        // Perform differential inverse kinematics on a batch of joint positions.
+        virtual bool diffInvKinBatch(const std::vector<double> &qs, const std::vector<double> &xdots, std::vector<double> &qdots, const reference_frame frame);
+
+        // -- ICartesianSolverInPlace declarations. Implementation in ICartesianSolverInPlaceImpl.cpp--
+
+        // Perform forward kinematics.
+        virtual bool fwdKinInto(const double * q, double * x);
+
+        // Obtain difference between supplied pose inputs.
+        virtual bool poseDiffInto(const double * xLhs, const double * xRhs, double * xOut);
+
+        // Perform forward kinematics and compute the Jacobian.
+        virtual bool fwdKinJacInto(const double * q, double * x, double * J);
+
+        // Perform inverse kinematics.
+        virtual bool invKinInto(const double * xd, const double * qGuess, double * q, const reference_frame frame);
+
+        // Perform differential inverse kinematics.
+        virtual bool diffInvKinInto(const double * q, const double * xdot, double * qdot, const reference_frame frame);
+
+        // Perform differential inverse kinematics given a precomputed Jacobian.
+        virtual bool diffInvKinJacInto(const double * x, const double * J, const double * xdot, double * qdot, const reference_frame frame);
+
+        // Perform inverse dynamics.
+        virtual bool invDynInto(const double * q, double * t);
+
+        // Perform inverse dynamics.
+        virtual bool invDynInto(const double * q, const double * qdot, const double * qdotdot, const double * fexts, int numFexts, double * t);
+
+        // Obtain the counters of the IK result cache.
+        virtual bool getIkResultCacheStats(unsigned long * hits, unsigned long * misses);
+
         // -------- DeviceDriver declarations. Implementation in IDeviceImpl.cpp --------
 
         /**
@@ -115,18 +216,146 @@ class KdlSolver : public yarp::dev::DeviceDriver, public ICartesianSolver
 
     protected:
 
+        /** Solvers bound to a chain snapshot, used by one caller at a time. **/
+        struct SolverSet
+        {
+            SolverSet()
+                : fkSolverPos(NULL),
+                  fkJacSolver(NULL),
+                  ikSolverPos(NULL),
+                  ikSolverPosStep(NULL),
+                  ikSolverPosAnytime(NULL),
+                  ikSolverVel(NULL),
+                  jacIkSolverVel(NULL),
+                  idSolver(NULL)
+            {}
+
+            ~SolverSet();
+
+            std::shared_ptr<const KDL::Chain> chain;
+
+            KDL::ChainFkSolverPos * fkSolverPos;
+            ChainFkJacSolver * fkJacSolver;
+            KDL::ChainIkSolverPos * ikSolverPos;
+            KDL::ChainIkSolverPos * ikSolverPosStep;
+            ChainIkSolverPos_Anytime * ikSolverPosAnytime;
+            KDL::ChainIkSolverVel * ikSolverVel;
+            JacobianIkSolverVel * jacIkSolverVel;
+            KDL::ChainIdSolver * idSolver;
+
+            //-- Scratch storage sized after the chain.
+            KDL::JntArray qIn, qdotIn, qdotdotIn, qOut;
+            KDL::JntArray qRace;  // initial guess' own output when racing IK seeds
+            KDL::Wrenches wrenches;
+            KDL::Jacobian jacobian;
+
+            //-- Draws random IK seeds.
+            std::mt19937 rng;
+        };
+
+        /** Scoped access to an idle solver set, returned to the pool on destruction. **/
+        class SolverLease
+        {
+            public:
+
+                explicit SolverLease(KdlSolver & _owner)
+                    : owner(_owner),
+                      set(_owner.acquireSolvers())
+                {}
+
+                ~SolverLease()
+                { owner.releaseSolvers(set); }
+
+                bool isValid() const
+                { return set != NULL; }
+
+                SolverSet * operator->() const
+                { return set; }
+
+                SolverSet * get() const
+                { return set; }
+
+            private:
+
+                SolverLease(const SolverLease &);
+                SolverLease & operator=(const SolverLease &);
+
+                KdlSolver & owner;
+                SolverSet * set;
+        };
+
+        /** Borrow an idle solver set (or create one) bound to the current chain snapshot. **/
+        SolverSet * acquireSolvers();
+
+        /** Return a solver set to the pool, or destroy it if bound to an outdated snapshot. **/
+        void releaseSolvers(SolverSet * set);
+
+        /** Instantiate all solvers for the given chain snapshot, reusing the IK problem of a prototype set if any, NULL on failure. **/
+        SolverSet * makeSolvers(const std::shared_ptr<const KDL::Chain> & snapshot, const SolverSet * prototype) const;
+
+        /** Build solvers for a new chain snapshot and make it current, caller must hold chainMtx. **/
+        bool publishChain(const std::shared_ptr<const KDL::Chain> & snapshot);
+
+        //-- Queries on a solver set already borrowed by the caller, joint values in radians.
+        bool fwdKinWith(SolverSet * solvers, const double * q, double * x);
+        bool invKinWith(SolverSet * solvers, const double * xd, const double * qGuess, double * q, const reference_frame frame,
+                double budget, double * residual = NULL);
+        bool diffInvKinWith(SolverSet * solvers, const double * q, const double * xdot, double * qdot, const reference_frame frame);
+
+        /** Run the iterative IK solver from several seeds on threads of this call, the first one to converge wins. **/
+        int raceSeeds(SolverSet * solvers, const KDL::Frame & frameXd, double budget);
+
+        /** Solve for joint velocities given the Jacobian stored in the solver set, twist in base frame. **/
+        bool solveVelocity(SolverSet * solvers, const KDL::Twist & xdot, KDL::JntArray & qdot) const;
+
+        /** Guards the pool of idle solver sets and the IK result cache. **/
         mutable std::mutex mtx;
 
-        /** The chain. **/
-        KDL::Chain chain;
+        /** Serializes changes of the chain, never taken by queries. **/
+        std::mutex chainMtx;
 
-        /** To store a copy of the original chain. **/
-        KDL::Chain originalChain;
+        /** Current chain snapshot, accessed with std::atomic_load/store. **/
+        std::shared_ptr<const KDL::Chain> currentChain;
 
-        KDL::ChainFkSolverPos * fkSolverPos;
-        KDL::ChainIkSolverPos * ikSolverPos;
-        KDL::ChainIkSolverVel * ikSolverVel;
-        KDL::ChainIdSolver * idSolver;
+        /** To store a copy of the original chain. **/
+        std::shared_ptr<const KDL::Chain> originalChain;
+
+        /** Solver sets not in use by any caller, all bound to the current snapshot. **/
+        std::vector<SolverSet *> idleSolvers;
+
+        /** Never leased, new solver sets derive from it instead of searching for an IK problem again. **/
+        std::shared_ptr<const SolverSet> prototypeSolvers;
+
+        //-- Solver configuration, needed to create new solver sets.
+        KDL::Vector gravity;
+        std::string ik;
+        std::vector<double> lmaWeights;
+        KDL::JntArray qMin, qMax;
+        int maxIter;
+        double eps;
+        double branchLock;
+        ConfigurationSelectorFactory * ikConfigFactory;
+        std::string ikVel;
+        double ikVelDamping;
+        double ikTimeBudget;
+        int ikTimeBudgetIter;
+        int ikStarts;
+        std::vector<KDL::JntArray> ikHomePoses;
+
+        /** Results of the ST solver's IK problem search, shared across chain updates. **/
+        ScrewTheoryIkProblemCache * ikProblemCache;
+
+        /** Recent IK results keyed by quantized target frame and initial guess, NULL if disabled. **/
+        IkResultCache * ikResultCache;
+
+        /** Lookups between reports of the IK result cache counters, zero to report on close only. **/
+        int ikResultCacheReport;
+
+        /** Worker threads for batch queries. **/
+        ThreadPool * batchPool;
+
+        /** Multi-start IK races won by the initial guess, home poses and random seeds, guarded by mtx. **/
+        unsigned long ikStartWins[3];
 };
 
 }  // namespace roboticslab
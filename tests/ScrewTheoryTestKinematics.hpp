@@ -0,0 +1,94 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __SCREW_THEORY_TEST_KINEMATICS_HPP__
+#define __SCREW_THEORY_TEST_KINEMATICS_HPP__
+
+#include <kdl/frames.hpp>
+#include <kdl/utilities/utility.h>
+
+#include "MatrixExponential.hpp"
+#include "ProductOfExponentials.hpp"
+
+namespace roboticslab
+{
+
+// Kinematic chains (POE formulation) shared by Screw Theory tests and benchmarks.
+
+inline PoeExpression makeTeoRightArmKinematicsFromPoE()
+{
+    KDL::Frame H_S_T(KDL::Vector(-0.63401, 0, 0));
+    PoeExpression poe(H_S_T);
+
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 0, 1), KDL::Vector::Zero()));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector::Zero()));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector::Zero()));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 0, 1), KDL::Vector(-0.32901, 0, 0)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(-0.32901, 0, 0)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 0, 1), KDL::Vector(-0.54401, 0, 0)));
+
+    return poe;
+}
+
+inline PoeExpression makeTeoRightLegKinematicsFromPoE()
+{
+    KDL::Frame H_S_T(KDL::Rotation::RotY(-KDL::PI / 2) * KDL::Rotation::RotX(KDL::PI / 2), KDL::Vector(0.0175, 0, -0.753005));
+    PoeExpression poe(H_S_T);
+
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0,  0, 1), KDL::Vector::Zero()));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, -1, 0), KDL::Vector::Zero()));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1,  0, 0), KDL::Vector::Zero()));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1,  0, 0), KDL::Vector(     0, 0, -0.33)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1,  0, 0), KDL::Vector(0.0175, 0, -0.63)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, -1, 0), KDL::Vector(0.0175, 0, -0.63)));
+
+    return poe;
+}
+
+inline PoeExpression makeAbbIrb120KinematicsFromPoE()
+{
+    KDL::Frame H_S_T(KDL::Rotation::RotX(KDL::PI / 2) * KDL::Rotation::RotZ(KDL::PI / 2), KDL::Vector(0.302, 0.47, 0));
+    PoeExpression poe(H_S_T);
+
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0,  1, 0), KDL::Vector::Zero()));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0,  0, 1), KDL::Vector(    0, 0.29, 0)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0,  0, 1), KDL::Vector(    0, 0.56, 0)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1,  0, 0), KDL::Vector(0.302, 0.63, 0)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0,  0, 1), KDL::Vector(0.302, 0.63, 0)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, -1, 0), KDL::Vector(0.302, 0.63, 0)));
+
+    return poe;
+}
+
+inline PoeExpression makePumaKinematicsFromPoE()
+{
+    KDL::Frame H_S_T(KDL::Vector(0, 5, 1));
+    PoeExpression poe(H_S_T);
+
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector::Zero()));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(0, 2, 0)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(0, 3, 0)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector(0, 3, 0)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(0, 5, 0)));
+    poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 0, 1), KDL::Vector(0, 5, 0)));
+
+    return poe;
+}
+
+inline PoeExpression makeStanfordKinematicsFromPoE()
+{
+    KDL::Frame H_S_T(KDL::Vector(0, 5, 1));
+    PoeExpression poe(H_S_T);
+
+    poe.append(MatrixExponential(   MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector::Zero()));
+    poe.append(MatrixExponential(   MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(0, 2, 0)));
+    poe.append(MatrixExponential(MatrixExponential::TRANSLATION, KDL::Vector(0, 1, 0)));
+    poe.append(MatrixExponential(   MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector(0, 2, 0)));
+    poe.append(MatrixExponential(   MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(0, 5, 0)));
+    poe.append(MatrixExponential(   MatrixExponential::ROTATION, KDL::Vector(0, 0, 1), KDL::Vector(0, 5, 0)));
+
+    return poe;
+}
+
+}  // namespace roboticslab
+
+#endif  // __SCREW_THEORY_TEST_KINEMATICS_HPP__
@@ -0,0 +1,222 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <yarp/os/all.h>
+#include <yarp/dev/Drivers.h>
+#include <yarp/dev/PolyDriver.h>
+
+#include <ColorDebug.h>
+
+#include "ICartesianSolver.h"
+#include "ICartesianSolverInPlace.h"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Measures aggregate throughput of concurrent \ref KdlSolver queries, and
+ * latency of single-threaded velocity IK queries.
+ *
+ * Not registered as a unit test, run manually on a Release build.
+ */
+class KdlSolverBenchmark : public testing::Test
+{
+
+    public:
+        virtual void SetUp() {
+            // PUMA 560, standard DH parameters
+            yarp::os::Property solverOptions("(device KdlSolver) (numLinks 6) "
+                    "(mins (-160 -225 -45 -110 -100 -266)) (maxs (160 45 225 170 100 266)) "
+                    "(link_0 (A 0) (D 0) (alpha 90)) "
+                    "(link_1 (A 0.4318) (D 0) (alpha 0)) "
+                    "(link_2 (A 0.0203) (D 0.15005) (alpha -90)) "
+                    "(link_3 (A 0) (D 0.4318) (alpha 90)) "
+                    "(link_4 (A 0) (D 0) (alpha -90)) "
+                    "(link_5 (A 0) (D 0) (alpha 0))");
+
+            solverDevice.open(solverOptions);
+            if( ! solverDevice.isValid() ) {
+                CD_ERROR("solverDevice not valid: %s.\n",solverOptions.find("device").asString().c_str());
+                return;
+            }
+            if( ! solverDevice.view(iCartesianSolver) ) {
+                CD_ERROR("Could not view ICartesianSolver in %s.\n",solverOptions.find("device").asString().c_str());
+                return;
+            }
+        }
+
+        virtual void TearDown()
+        {
+            solverDevice.close();
+        }
+
+        static double secondsSince(const std::chrono::steady_clock::time_point & start)
+        {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            return elapsed.count();
+        }
+
+        static std::vector<double> makeJointValues(int seed)
+        {
+            std::vector<double> q(6);
+
+            for (int i = 0; i < 6; i++)
+            {
+                q[i] = ((seed * 7 + i * 13) % 60) - 30.0;  // degrees, within limits
+            }
+
+            return q;
+        }
+
+        void runFwdKin(int queries)
+        {
+            std::vector<double> x;
+
+            for (int i = 0; i < queries; i++)
+            {
+                iCartesianSolver->fwdKin(makeJointValues(i), x);
+            }
+        }
+
+        void runInvKin(int queries)
+        {
+            std::vector<double> qGuess(6, 0.0), q, x;
+
+            for (int i = 0; i < queries; i++)
+            {
+                iCartesianSolver->fwdKin(makeJointValues(i), x);
+                iCartesianSolver->invKin(x, qGuess, q);
+            }
+        }
+
+        template <typename Fn>
+        void benchmark(const char * name, Fn fn, int queriesPerThread)
+        {
+            ASSERT_TRUE(solverDevice.isValid());
+
+            std::printf("[%s] %d queries per thread\n", name, queriesPerThread);
+
+            for (int threads = 1; threads <= 8; threads *= 2)
+            {
+                std::vector<std::thread> workers;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+                for (int i = 0; i < threads; i++)
+                {
+                    workers.push_back(std::thread(fn, this, queriesPerThread));
+                }
+
+                for (int i = 0; i < threads; i++)
+                {
+                    workers[i].join();
+                }
+
+                double elapsed = secondsSince(start);
+
+                std::printf("  %d thread(s): %12.0f queries/s\n", threads, threads * queriesPerThread / elapsed);
+            }
+        }
+
+        /**
+         * Time each diffInvKinJacInto call along a smooth joint trajectory sampled
+         * at 200 Hz, mimicking the streaming commands of a cartesian controller.
+         */
+        static void benchmarkVelocity(const char * name, const std::string & chain, int numJoints, int queries)
+        {
+            const char * variants[] = {"pinv", "wsvd", "dls"};
+
+            std::printf("[%s] %d queries\n", name, queries);
+
+            for (int v = 0; v < 3; v++)
+            {
+                yarp::os::Property options((chain + " (ikVel " + variants[v] + ")").c_str());
+                yarp::dev::PolyDriver device(options);
+                ASSERT_TRUE(device.isValid());
+
+                ICartesianSolverInPlace * iCartesianSolverInPlace;
+                ASSERT_TRUE(device.view(iCartesianSolverInPlace));
+
+                std::vector<double> q(numJoints), x(6), J(6 * numJoints), qdot(numJoints), latencies(queries);
+                const double xdot[6] = {0.01, -0.02, 0.01, 0.0, 0.05, -0.05};
+
+                for (int i = 0; i < queries; i++)
+                {
+                    for (int j = 0; j < numJoints; j++)
+                    {
+                        q[j] = 0.5 * std::sin(0.2 * i / 200.0 + j) + 0.1 * (j + 1);  // radians
+                    }
+
+                    ASSERT_TRUE(iCartesianSolverInPlace->fwdKinJacInto(q.data(), x.data(), J.data()));
+
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                    iCartesianSolverInPlace->diffInvKinJacInto(x.data(), J.data(), xdot, qdot.data());
+                    latencies[i] = secondsSince(start) * 1e6;
+                }
+
+                device.close();
+
+                std::sort(latencies.begin(), latencies.end());
+
+                double mean = 0.0;
+
+                for (int i = 0; i < queries; i++)
+                {
+                    mean += latencies[i] / queries;
+                }
+
+                std::printf("  %-4s: mean %6.2f us, median %6.2f us, p99 %6.2f us, max %6.2f us\n", variants[v],
+                        mean, latencies[queries / 2], latencies[queries * 99 / 100], latencies[queries - 1]);
+            }
+        }
+
+    protected:
+        yarp::dev::PolyDriver solverDevice;
+        roboticslab::ICartesianSolver *iCartesianSolver;
+};
+
+TEST_F( KdlSolverBenchmark, FwdKinThroughput)
+{
+    benchmark("fwdKin", &KdlSolverBenchmark::runFwdKin, 100000);
+}
+
+TEST_F( KdlSolverBenchmark, InvKinThroughput)
+{
+    benchmark("invKin", &KdlSolverBenchmark::runInvKin, 2000);
+}
+
+TEST_F( KdlSolverBenchmark, DiffInvKinLatencyTeoRightArm)
+{
+    // TEO right arm, same as in testScrewTheory
+    benchmarkVelocity("diffInvKin TEO right arm", "(device KdlSolver) (numLinks 6) "
+            "(mins (-180 -180 -180 -180 -180 -180)) (maxs (180 180 180 180 180 180)) "
+            "(link_0 (A 0) (D 0) (alpha -90) (offset 0)) "
+            "(link_1 (A 0) (D 0) (alpha -90) (offset -90)) "
+            "(link_2 (A 0) (D -0.32901) (alpha -90) (offset -90)) "
+            "(link_3 (A 0) (D 0) (alpha 90) (offset 0)) "
+            "(link_4 (A 0) (D -0.215) (alpha -90) (offset 0)) "
+            "(link_5 (A -0.09) (D 0) (alpha 0) (offset -90))", 6, 20000);
+}
+
+TEST_F( KdlSolverBenchmark, DiffInvKinLatencyAbbIrb120)
+{
+    // ABB IRB120, same as in testScrewTheory
+    benchmarkVelocity("diffInvKin ABB IRB120", "(device KdlSolver) (numLinks 6) "
+            "(H0 (1 0 0 0  0 0 1 0  0 -1 0 0  0 0 0 1)) (HN (0 -1 0 0  1 0 0 0  0 0 1 0  0 0 0 1)) "
+            "(mins (-165 -110 -110 -160 -120 -400)) (maxs (165 110 70 160 120 400)) "
+            "(link_0 (A 0) (D 0.29) (alpha 90) (offset 0)) "
+            "(link_1 (A 0.27) (D 0) (alpha 0) (offset 90)) "
+            "(link_2 (A 0.07) (D 0) (alpha 90) (offset 0)) "
+            "(link_3 (A 0) (D 0.302) (alpha -90) (offset 0)) "
+            "(link_4 (A 0) (D 0) (alpha 90) (offset -90)) "
+            "(link_5 (A 0) (D 0.16) (alpha 0) (offset 0))", 6, 20000);
+}
+
+}  // namespace roboticslab
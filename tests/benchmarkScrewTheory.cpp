@@ -0,0 +1,295 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/utilities/utility.h>
+
+#include "MatrixExponential.hpp"
+#include "ProductOfExponentials.hpp"
+#include "ScrewTheoryIkProblem.hpp"
+#include "ScrewTheoryIkSolver.hpp"
+#include "ScrewTheoryIkSubproblems.hpp"
+#include "SubproblemKernels.hpp"
+#include "ThreadPool.hpp"
+
+#include "ScrewTheoryTestKinematics.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Measures throughput of Screw Theory solvers.
+ *
+ * Not registered as a unit test, run manually on a Release build.
+ */
+class ScrewTheoryBenchmark : public testing::Test
+{
+public:
+
+    virtual void SetUp()
+    {
+    }
+
+    virtual void TearDown()
+    {
+    }
+
+    static std::vector<KDL::Frame> makeTargets(const PoeExpression & poe, int count)
+    {
+        std::vector<KDL::Frame> targets(count);
+        KDL::JntArray q(poe.size());
+
+        for (int i = 0; i < count; i++)
+        {
+            for (int j = 0; j < poe.size(); j++)
+            {
+                KDL::random(q(j)); // [-0.99, 0.99]
+            }
+
+            poe.evaluate(q, targets[i]);
+        }
+
+        return targets;
+    }
+
+    static double secondsSince(const std::chrono::steady_clock::time_point & start)
+    {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    static void benchmarkIkProblem(const std::string & name, const PoeExpression & poe)
+    {
+        ScrewTheoryIkProblemBuilder builder(poe);
+        ScrewTheoryIkProblem * ikProblem = builder.build();
+
+        ASSERT_TRUE(ikProblem);
+
+        const int soln = ikProblem->solutions();
+        std::vector<KDL::Frame> targets = makeTargets(poe, POSES);
+        std::vector<KDL::JntArray> solutions(POSES * soln, KDL::JntArray(poe.size()));
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < POSES; i++)
+        {
+            ScrewTheoryIkProblem::Solutions single;
+            ikProblem->solve(targets[i], single);
+        }
+
+        double single = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        ikProblem->solveBatch(&targets[0], POSES, &solutions[0]);
+        double batch = secondsSince(start);
+
+        ThreadPool pool;
+
+        start = std::chrono::steady_clock::now();
+        ikProblem->solveBatch(&targets[0], POSES, &solutions[0], NULL, &pool);
+        double parallel = secondsSince(start);
+
+        std::printf("[%s] %d poses, %d solutions per pose\n", name.c_str(), POSES, soln);
+        std::printf("  solve():                 %12.0f poses/s\n", POSES / single);
+        std::printf("  solveBatch():            %12.0f poses/s\n", POSES / batch);
+        std::printf("  solveBatch(), %2d threads: %12.0f poses/s\n", pool.size(), POSES / parallel);
+
+        delete ikProblem;
+    }
+
+    template <typename Solver>
+    static void benchmarkIkSolver(const std::string & name, const PoeExpression & poe)
+    {
+        ScrewTheoryIkProblemBuilder builder(poe);
+        ScrewTheoryIkProblem * ikProblem = builder.build();
+
+        ASSERT_TRUE(ikProblem);
+
+        Solver solver(*ikProblem);
+        ASSERT_TRUE(solver.isValid());
+
+        std::vector<KDL::Frame> targets = makeTargets(poe, POSES);
+        ScrewTheoryIkProblem::Workspace workspace(*ikProblem);
+        ScrewTheoryIkProblem::Solutions solutions;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < POSES; i++)
+        {
+            ikProblem->solve(targets[i], solutions, workspace);
+        }
+
+        double generic = secondsSince(start);
+
+        typename Solver::Solutions specializedSolutions;
+
+        start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < POSES; i++)
+        {
+            solver.solve(targets[i], specializedSolutions);
+        }
+
+        double specialized = secondsSince(start);
+
+        std::printf("[%s] %d poses, %d solutions per pose\n", name.c_str(), POSES, Solver::SOLUTIONS);
+        std::printf("  solve(), workspace:      %12.0f poses/s\n", POSES / generic);
+        std::printf("  ScrewTheoryIkSolver:     %12.0f poses/s\n", POSES / specialized);
+
+        delete ikProblem;
+    }
+
+    static void benchmarkSubproblem(const std::string & name, const ScrewTheoryIkSubproblem & subproblem,
+            const MatrixExponential & exp1, const MatrixExponential & exp2)
+    {
+        std::vector<KDL::Frame> rhs(POSES), pointTransforms(POSES);
+
+        for (int i = 0; i < POSES; i++)
+        {
+            double theta1, theta2;
+            KDL::random(theta1);
+            KDL::random(theta2);
+            rhs[i] = exp1.asFrame(theta1) * exp2.asFrame(theta2);
+        }
+
+        std::vector<ScrewTheoryIkSubproblem::Solutions> solutions(POSES);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < POSES; i++)
+        {
+            subproblem.solve(rhs[i], pointTransforms[i], solutions[i]);
+        }
+
+        double single = secondsSince(start);
+
+        std::printf("[%s] %d inputs\n", name.c_str(), POSES);
+        std::printf("  solve():                 %12.0f inputs/s\n", POSES / single);
+
+        std::vector<const SubproblemKernels *> kernelSets;
+        kernelSets.push_back(&getScalarSubproblemKernels());
+
+        if (getSimdSubproblemKernels() != NULL)
+        {
+            kernelSets.push_back(getSimdSubproblemKernels());
+        }
+
+        for (int i = 0; i < kernelSets.size(); i++)
+        {
+            setUseSimdSubproblemKernels(kernelSets[i] != &getScalarSubproblemKernels());
+
+            start = std::chrono::steady_clock::now();
+            subproblem.solveBatch(&rhs[0], &pointTransforms[0], POSES, &solutions[0], NULL);
+            double batch = secondsSince(start);
+
+            std::printf("  solveBatch(), %-10s %12.0f inputs/s\n", (std::string(kernelSets[i]->name) + ":").c_str(), POSES / batch);
+        }
+
+        setUseSimdSubproblemKernels(true);
+    }
+
+    static const int POSES = 100000;
+};
+
+TEST_F(ScrewTheoryBenchmark, PadenKahanOneBatch)
+{
+    MatrixExponential exp(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector(1, 0, 0));
+    PadenKahanOne pk1(0, exp, KDL::Vector(0, 1, 1));
+    benchmarkSubproblem("PadenKahanOne", pk1, exp, exp);
+}
+
+TEST_F(ScrewTheoryBenchmark, PadenKahanTwoBatch)
+{
+    MatrixExponential exp1(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(1, 0, 0));
+    MatrixExponential exp2(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector(1, 0, 0));
+    PadenKahanTwo pk2(0, 1, exp1, exp2, KDL::Vector(0, 1, 0), KDL::Vector(1, 0, 0));
+    benchmarkSubproblem("PadenKahanTwo", pk2, exp1, exp2);
+}
+
+TEST_F(ScrewTheoryBenchmark, PadenKahanThreeBatch)
+{
+    MatrixExponential exp(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector(1, 0, 0));
+    PadenKahanThree pk3(0, exp, KDL::Vector(0, 1, 0), KDL::Vector(2, 1, 1));
+    benchmarkSubproblem("PadenKahanThree", pk3, exp, exp);
+}
+
+TEST_F(ScrewTheoryBenchmark, PardosGotorOneBatch)
+{
+    MatrixExponential exp(MatrixExponential::TRANSLATION, KDL::Vector(0, 1, 0));
+    PardosGotorOne pg1(0, exp, KDL::Vector(1, 0, 0));
+    benchmarkSubproblem("PardosGotorOne", pg1, exp, exp);
+}
+
+TEST_F(ScrewTheoryBenchmark, PardosGotorTwoBatch)
+{
+    MatrixExponential exp1(MatrixExponential::TRANSLATION, KDL::Vector(0, 1, 0));
+    MatrixExponential exp2(MatrixExponential::TRANSLATION, KDL::Vector(1, 0, 0));
+    PardosGotorTwo pg2(0, 1, exp1, exp2, KDL::Vector(1, 1, 0));
+    benchmarkSubproblem("PardosGotorTwo", pg2, exp1, exp2);
+}
+
+TEST_F(ScrewTheoryBenchmark, PardosGotorThreeBatch)
+{
+    MatrixExponential exp(MatrixExponential::TRANSLATION, KDL::Vector(0, 1, 0));
+    PardosGotorThree pg3(0, exp, KDL::Vector(1, 0, 0), KDL::Vector(1, 2, 0));
+    benchmarkSubproblem("PardosGotorThree", pg3, exp, exp);
+}
+
+TEST_F(ScrewTheoryBenchmark, PardosGotorFourBatch)
+{
+    MatrixExponential exp1(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector(2, 0, 0));
+    MatrixExponential exp2(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector(1, 0, 0));
+    PardosGotorFour pg4(0, 1, exp1, exp2, KDL::Vector(0, 1, 0));
+    benchmarkSubproblem("PardosGotorFour", pg4, exp1, exp2);
+}
+
+TEST_F(ScrewTheoryBenchmark, AbbIrb120Batch)
+{
+    benchmarkIkProblem("ABB IRB120", makeAbbIrb120KinematicsFromPoE());
+}
+
+TEST_F(ScrewTheoryBenchmark, PumaBatch)
+{
+    benchmarkIkProblem("Puma", makePumaKinematicsFromPoE());
+}
+
+TEST_F(ScrewTheoryBenchmark, StanfordBatch)
+{
+    benchmarkIkProblem("Stanford", makeStanfordKinematicsFromPoE());
+}
+
+TEST_F(ScrewTheoryBenchmark, TeoRightArmBatch)
+{
+    benchmarkIkProblem("TEO right arm", makeTeoRightArmKinematicsFromPoE());
+}
+
+TEST_F(ScrewTheoryBenchmark, TeoRightLegBatch)
+{
+    benchmarkIkProblem("TEO right leg", makeTeoRightLegKinematicsFromPoE());
+}
+
+TEST_F(ScrewTheoryBenchmark, AbbIrb120Specialized)
+{
+    benchmarkIkSolver<ScrewTheoryIkSolver<6, PadenKahanThree, PadenKahanTwo, PadenKahanTwo, PadenKahanOne> >(
+            "ABB IRB120", makeAbbIrb120KinematicsFromPoE());
+}
+
+TEST_F(ScrewTheoryBenchmark, StanfordSpecialized)
+{
+    benchmarkIkSolver<ScrewTheoryIkSolver<6, PardosGotorThree, PadenKahanTwo, PadenKahanTwo, PadenKahanOne> >(
+            "Stanford", makeStanfordKinematicsFromPoE());
+}
+
+TEST_F(ScrewTheoryBenchmark, TeoRightLegSpecialized)
+{
+    benchmarkIkSolver<ScrewTheoryIkSolver<6, PadenKahanThree, PadenKahanTwo, PadenKahanTwo, PadenKahanOne> >(
+            "TEO right leg", makeTeoRightLegKinematicsFromPoE());
+}
+
+}  // namespace roboticslab
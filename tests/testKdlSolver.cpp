@@ -1,6 +1,8 @@
 #include "gtest/gtest.h"
 
 #include <cmath>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include <yarp/os/all.h>
@@ -10,6 +12,7 @@
 #include <ColorDebug.h>
 
 #include "ICartesianSolver.h"
+#include "ICartesianSolverInPlace.h"
 
 namespace roboticslab
 {
@@ -96,6 +99,398 @@ TEST_F( KdlSolverTest, KdlSolverInvKin2)
     ASSERT_NEAR(q[0], 90, 1e-3);
 }
 
+TEST_F( KdlSolverTest, KdlSolverInvKinBudget)
+{
+    std::vector<double> xd(6,0.0),qGuess(1,0.0),q;
+    xd[1] = 1;  // y
+    xd[5] = M_PI / 2;  // o(z)
+    double residual;
+
+    ASSERT_TRUE(iCartesianSolver->invKinBudget(xd,qGuess,0.1,q,residual));
+    ASSERT_EQ(q.size(), 1 );
+    ASSERT_NEAR(q[0], 90, 1e-3);
+    ASSERT_NEAR(residual, 0, 1e-4);
+
+    //-- No time limit.
+    ASSERT_TRUE(iCartesianSolver->invKinBudget(xd,qGuess,0.0,q,residual));
+    ASSERT_NEAR(q[0], 90, 1e-3);
+    ASSERT_NEAR(residual, 0, 1e-4);
+}
+
+TEST_F( KdlSolverTest, KdlSolverInvKinBudgetLma)
+{
+    //-- Short bursts, LMA's weighted error may improve while the plain residual does not.
+    yarp::os::Property solverOptions("(device KdlSolver) (numLinks 3) (link_0 (A 1)) (link_1 (A 1)) (link_2 (A 1)) (ik lma) (ikTimeBudget 0.5) (ikTimeBudgetIter 2)");
+    yarp::dev::PolyDriver lmaSolverDevice(solverOptions);
+    ASSERT_TRUE(lmaSolverDevice.isValid());
+
+    roboticslab::ICartesianSolver *iLmaSolver;
+    ASSERT_TRUE(lmaSolverDevice.view(iLmaSolver));
+
+    std::vector<double> qTarget(3),qGuess(3),q,xd,x;
+    qTarget[0] = 30;
+    qTarget[1] = 60;
+    qTarget[2] = -45;
+    qGuess[0] = 10;
+    qGuess[1] = 20;
+    qGuess[2] = 10;
+    ASSERT_TRUE(iLmaSolver->fwdKin(qTarget,xd));
+
+    //-- Device-wide budget.
+    ASSERT_TRUE(iLmaSolver->invKin(xd,qGuess,q));
+    ASSERT_EQ(q.size(), 3 );
+    ASSERT_TRUE(iLmaSolver->fwdKin(q,x));
+    ASSERT_NEAR(x[0], xd[0], 1e-3);
+    ASSERT_NEAR(x[1], xd[1], 1e-3);
+    ASSERT_NEAR(x[5], xd[5], 1e-3);
+
+    double residual;
+    ASSERT_TRUE(iLmaSolver->invKinBudget(xd,qGuess,0.5,q,residual));
+    ASSERT_LT(residual, 1e-4);
+
+    lmaSolverDevice.close();
+}
+
+TEST_F( KdlSolverTest, KdlSolverInvKinMultiStart)
+{
+    yarp::os::Property solverOptions("(device KdlSolver) (numLinks 1) (link_0 (A 1)) (mins (-180)) (maxs (180)) (ikStarts 4) (ikHomePoses ((90)))");
+    yarp::dev::PolyDriver multiStartSolverDevice(solverOptions);
+    ASSERT_TRUE(multiStartSolverDevice.isValid());
+
+    roboticslab::ICartesianSolver *iMultiStartSolver;
+    ASSERT_TRUE(multiStartSolverDevice.view(iMultiStartSolver));
+
+    std::vector<double> xd(6,0.0),qGuess(1,-170.0),q,x;
+    xd[1] = 1;  // y
+    xd[5] = M_PI / 2;  // o(z)
+
+    //-- Any seed may win, but all of them lead to the same pose.
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_TRUE(iMultiStartSolver->invKin(xd,qGuess,q));
+        ASSERT_EQ(q.size(), 1 );
+        ASSERT_TRUE(iMultiStartSolver->fwdKin(q,x));
+        ASSERT_NEAR(x[0], 0, 1e-3);
+        ASSERT_NEAR(x[1], 1, 1e-3);
+    }
+
+    double residual;
+    ASSERT_TRUE(iMultiStartSolver->invKinBudget(xd,qGuess,0.1,q,residual));
+    ASSERT_NEAR(residual, 0, 1e-4);
+
+    multiStartSolverDevice.close();
+
+    //-- Home poses must match the number of joints.
+    yarp::os::Property badOptions("(device KdlSolver) (numLinks 1) (link_0 (A 1)) (mins (-180)) (maxs (180)) (ikStarts 4) (ikHomePoses ((90 0)))");
+    yarp::dev::PolyDriver badSolverDevice(badOptions);
+    ASSERT_FALSE(badSolverDevice.isValid());
+}
+
+TEST_F( KdlSolverTest, KdlSolverInvKinId)
+{
+    yarp::os::Property solverOptions("(device KdlSolver) (numLinks 2) (link_0 (A 1)) (link_1 (A 1)) (mins (-180 -180)) (maxs (180 180)) (ik id)");
+    yarp::dev::PolyDriver idSolverDevice(solverOptions);
+    ASSERT_TRUE(idSolverDevice.isValid());
+
+    roboticslab::ICartesianSolver *iIdSolver;
+    ASSERT_TRUE(idSolverDevice.view(iIdSolver));
+
+    std::vector<double> qTarget(2),qGuess(2),q,xd;
+    qTarget[0] = 30;
+    qTarget[1] = 60;
+    qGuess[0] = 20;
+    qGuess[1] = 70;
+    ASSERT_TRUE(iIdSolver->fwdKin(qTarget,xd));
+
+    //-- Far beyond a single Jacobian transpose step.
+    ASSERT_TRUE(iIdSolver->invKin(xd,qGuess,q));
+    ASSERT_EQ(q.size(), 2 );
+    ASSERT_NEAR(q[0], 30, 0.1);
+    ASSERT_NEAR(q[1], 60, 0.1);
+
+    double residual;
+    ASSERT_TRUE(iIdSolver->invKinBudget(xd,qGuess,0.1,q,residual));
+    ASSERT_LT(residual, 1e-4);
+
+    idSolverDevice.close();
+}
+
+TEST_F( KdlSolverTest, KdlSolverInPlace)
+{
+    ICartesianSolverInPlace *iCartesianSolverInPlace;
+    ASSERT_TRUE(solverDevice.view(iCartesianSolverInPlace));
+
+    double q[1] = {M_PI / 2}, x[6], qSol[1], qGuess[1] = {0.0};
+    ASSERT_TRUE(iCartesianSolverInPlace->fwdKinInto(q, x));
+    ASSERT_NEAR(x[0], 0, 1e-9);
+    ASSERT_NEAR(x[1], 1, 1e-9);
+    ASSERT_NEAR(x[2], 0, 1e-9);
+
+    ASSERT_TRUE(iCartesianSolverInPlace->invKinInto(x, qGuess, qSol));
+    ASSERT_NEAR(qSol[0], M_PI / 2, 1e-3);
+
+    double t[1];
+    q[0] = 0.0;
+    ASSERT_TRUE(iCartesianSolverInPlace->invDynInto(q, t));
+    ASSERT_NEAR(t[0], 5, 1e-9);  //-- T = F*d = 1kg * 10m/s^2 * 0.5m = 5 N*m
+}
+
+TEST_F( KdlSolverTest, KdlSolverFwdKinJac)
+{
+    ICartesianSolverInPlace *iCartesianSolverInPlace;
+    ASSERT_TRUE(solverDevice.view(iCartesianSolverInPlace));
+
+    double q[1] = {M_PI / 2}, x[6], J[6];
+    ASSERT_TRUE(iCartesianSolverInPlace->fwdKinJacInto(q, x, J));
+    ASSERT_NEAR(x[0], 0, 1e-9);
+    ASSERT_NEAR(x[1], 1, 1e-9);
+    ASSERT_NEAR(J[0], -1, 1e-9);  //-- vx
+    ASSERT_NEAR(J[1], 0, 1e-9);  //-- vy
+    ASSERT_NEAR(J[5], 1, 1e-9);  //-- wz
+
+    //-- Same result as the regular query, with no further chain traversal.
+    double xdot[6] = {-1, 0, 0, 0, 0, 1}, qdot[1], qdotRef[1];
+    ASSERT_TRUE(iCartesianSolverInPlace->diffInvKinJacInto(x, J, xdot, qdot));
+    ASSERT_TRUE(iCartesianSolverInPlace->diffInvKinInto(q, xdot, qdotRef));
+    ASSERT_NEAR(qdot[0], 1, 1e-9);
+    ASSERT_NEAR(qdot[0], qdotRef[0], 1e-9);
+
+    //-- Twist along the TCP's own axes: +y (TCP) is -x (base).
+    double xdotTcp[6] = {0, 1, 0, 0, 0, 1};
+    ASSERT_TRUE(iCartesianSolverInPlace->diffInvKinJacInto(x, J, xdotTcp, qdot, ICartesianSolver::TCP_FRAME));
+    ASSERT_NEAR(qdot[0], 1, 1e-9);
+}
+
+TEST_F( KdlSolverTest, KdlSolverBatch)
+{
+    std::vector<double> qs(3),xs;
+    qs[0] = 0;
+    qs[1] = 90;
+    qs[2] = -90;
+    ASSERT_TRUE(iCartesianSolver->fwdKinBatch(qs,xs));
+    ASSERT_EQ(xs.size(), 18 );
+    ASSERT_NEAR(xs[0], 1, 1e-9);  //-- 0 degrees
+    ASSERT_NEAR(xs[7], 1, 1e-9);  //-- 90 degrees
+    ASSERT_NEAR(xs[13], -1, 1e-9);  //-- -90 degrees
+
+    std::vector<double> qGuess(1,0.0),qSols;
+    ASSERT_TRUE(iCartesianSolver->invKinBatch(xs,qGuess,qSols));
+    ASSERT_EQ(qSols.size(), 3 );
+    ASSERT_NEAR(qSols[0], 0, 1e-3);
+    ASSERT_NEAR(qSols[1], 90, 1e-3);
+    ASSERT_NEAR(qSols[2], -90, 1e-3);
+
+    //-- Unreachable entries are flagged without spoiling the rest.
+    xs[12] = 5;  // x
+    ASSERT_FALSE(iCartesianSolver->invKinBatch(xs,qs,qSols));
+    ASSERT_EQ(qSols.size(), 3 );
+    ASSERT_NEAR(qSols[1], 90, 1e-3);
+    ASSERT_TRUE(std::isnan(qSols[2]));
+
+    std::vector<double> xdots(12,0.0),qdots;
+    xdots[1] = xdots[5] = 1;  // vy, wz at 0 degrees
+    xdots[6] = -1;  // vx at 90 degrees
+    xdots[11] = 1;  // wz
+    qs.resize(2);
+    ASSERT_TRUE(iCartesianSolver->diffInvKinBatch(qs,xdots,qdots));
+    ASSERT_EQ(qdots.size(), 2 );
+    ASSERT_NEAR(qdots[0], 180 / M_PI, 1e-3);
+    ASSERT_NEAR(qdots[1], 180 / M_PI, 1e-3);
+
+    xdots.resize(7);
+    ASSERT_FALSE(iCartesianSolver->diffInvKinBatch(qs,xdots,qdots));
+}
+
+TEST_F( KdlSolverTest, KdlSolverInvKinResultCache)
+{
+    yarp::os::Property solverOptions("(device KdlSolver) (numLinks 1) (link_0 (A 1)) (mins (-180)) (maxs (180)) (ikResultCacheSize 8)");
+    yarp::dev::PolyDriver cachedSolverDevice(solverOptions);
+    ASSERT_TRUE(cachedSolverDevice.isValid());
+
+    roboticslab::ICartesianSolver *iCachedSolver;
+    ASSERT_TRUE(cachedSolverDevice.view(iCachedSolver));
+
+    roboticslab::ICartesianSolverInPlace *iCachedSolverInPlace;
+    ASSERT_TRUE(cachedSolverDevice.view(iCachedSolverInPlace));
+
+    std::vector<double> xd(6,0.0),qGuess(1,90.0),q,qCached;
+    xd[1] = 1;  // y
+    xd[5] = M_PI / 2;  // o(z)
+
+    unsigned long hits, misses;
+
+    ASSERT_TRUE(iCachedSolver->invKin(xd,qGuess,q));
+    ASSERT_TRUE(iCachedSolverInPlace->getIkResultCacheStats(&hits,&misses));
+    ASSERT_EQ(hits, 0UL);
+    ASSERT_EQ(misses, 1UL);
+
+    ASSERT_TRUE(iCachedSolver->invKin(xd,qGuess,qCached));
+    ASSERT_TRUE(iCachedSolverInPlace->getIkResultCacheStats(&hits,&misses));
+    ASSERT_EQ(hits, 1UL);
+    ASSERT_EQ(misses, 1UL);
+    ASSERT_EQ(qCached.size(), 1 );
+    ASSERT_NEAR(qCached[0], 90, 1e-3);
+    ASSERT_EQ(qCached, q);
+
+    //-- Cached results must not survive a change in the chain: the same query is
+    //-- now out of reach, since the tool lies one meter further away.
+    std::vector<double> x(6,0.0);
+    x[0] = 1;
+    ASSERT_TRUE(iCachedSolver->appendLink(x));
+
+    ASSERT_FALSE(iCachedSolver->invKin(xd,qGuess,q));
+    ASSERT_TRUE(iCachedSolverInPlace->getIkResultCacheStats(&hits,&misses));
+    ASSERT_EQ(hits, 1UL);
+    ASSERT_EQ(misses, 2UL);
+
+    //-- Nor the other way round.
+    ASSERT_TRUE(iCachedSolver->restoreOriginalChain());
+
+    ASSERT_TRUE(iCachedSolver->invKin(xd,qGuess,q));
+    ASSERT_NEAR(q[0], 90, 1e-3);
+    ASSERT_TRUE(iCachedSolverInPlace->getIkResultCacheStats(&hits,&misses));
+    ASSERT_EQ(hits, 1UL);
+    ASSERT_EQ(misses, 3UL);
+
+    cachedSolverDevice.close();
+}
+
+TEST_F( KdlSolverTest, KdlSolverVelocitySolvers)
+{
+    const std::string arm = "(device KdlSolver) (numLinks 2) (link_0 (A 1)) (link_1 (A 1)) (mins (-180 -180)) (maxs (180 180)) ";
+
+    yarp::os::Property pinvOptions(arm.c_str());
+    yarp::dev::PolyDriver pinvSolverDevice(pinvOptions);
+    ASSERT_TRUE(pinvSolverDevice.isValid());
+
+    roboticslab::ICartesianSolver *iPinvSolver;
+    ASSERT_TRUE(pinvSolverDevice.view(iPinvSolver));
+
+    const char * variants[] = {"(ikVel wsvd)", "(ikVel dls) (ikVelDamping 1e-4)"};
+
+    for (int i = 0; i < 2; i++)
+    {
+        yarp::os::Property velOptions((arm + variants[i]).c_str());
+        yarp::dev::PolyDriver velSolverDevice(velOptions);
+        ASSERT_TRUE(velSolverDevice.isValid());
+
+        roboticslab::ICartesianSolver *iVelSolver;
+        ASSERT_TRUE(velSolverDevice.view(iVelSolver));
+
+        std::vector<double> q(2),xdot(6,0.0),qdot,qdotRef;
+        xdot[0] = 0.1;  // vx
+        xdot[1] = -0.2;  // vy
+        xdot[5] = 0.05;  // wz
+
+        //-- Successive configurations close to each other, as in a control loop.
+        for (int j = 0; j < 10; j++)
+        {
+            q[0] = 30 + j;
+            q[1] = 60 - j;
+            ASSERT_TRUE(iVelSolver->diffInvKin(q,xdot,qdot));
+            ASSERT_TRUE(iPinvSolver->diffInvKin(q,xdot,qdotRef));
+            ASSERT_EQ(qdot.size(), 2 );
+            ASSERT_NEAR(qdot[0], qdotRef[0], 1e-3);
+            ASSERT_NEAR(qdot[1], qdotRef[1], 1e-3);
+        }
+
+        velSolverDevice.close();
+    }
+
+    pinvSolverDevice.close();
+
+    yarp::os::Property badOptions((arm + "(ikVel foo)").c_str());
+    yarp::dev::PolyDriver badSolverDevice(badOptions);
+    ASSERT_FALSE(badSolverDevice.isValid());
+}
+
+TEST_F( KdlSolverTest, KdlSolverConcurrentQueries)
+{
+    const int threads = 4;
+    const int queries = 200;
+
+    std::vector<int> failures(threads, 0);
+    std::vector<std::thread> workers;
+
+    for (int i = 0; i < threads; i++)
+    {
+        workers.push_back(std::thread([this, i, &failures]()
+        {
+            std::vector<double> q(1), qGuess(1, 0.0), qSol, x;
+
+            for (int j = 0; j < queries; j++)
+            {
+                q[0] = (i * queries + j) % 170 - 85.0;
+
+                if (!iCartesianSolver->fwdKin(q, x) || !iCartesianSolver->invKin(x, qGuess, qSol)
+                        || std::abs(qSol[0] - q[0]) > 1e-3)
+                {
+                    failures[i]++;
+                }
+            }
+        }));
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i].join();
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        ASSERT_EQ(failures[i], 0);
+    }
+}
+
+TEST_F( KdlSolverTest, KdlSolverAppendLinkDuringQueries)
+{
+    const int threads = 4;
+    const int queries = 500;
+
+    std::vector<int> failures(threads, 0);
+    std::vector<std::thread> workers;
+
+    for (int i = 0; i < threads; i++)
+    {
+        workers.push_back(std::thread([this, i, &failures]()
+        {
+            std::vector<double> q(1, 0.0), x;
+
+            for (int j = 0; j < queries; j++)
+            {
+                // Either snapshot is fine, a mix of both is not.
+                if (!iCartesianSolver->fwdKin(q, x) || (std::abs(x[0] - 1) > 1e-9 && std::abs(x[0] - 1.5) > 1e-9))
+                {
+                    failures[i]++;
+                }
+            }
+        }));
+    }
+
+    std::vector<double> tool(6, 0.0);
+    tool[0] = 0.5;
+
+    for (int j = 0; j < 50; j++)
+    {
+        EXPECT_TRUE(iCartesianSolver->appendLink(tool));
+        EXPECT_TRUE(iCartesianSolver->restoreOriginalChain());
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i].join();
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        ASSERT_EQ(failures[i], 0);
+    }
+
+    std::vector<double> q(1, 0.0), x;
+    ASSERT_TRUE(iCartesianSolver->fwdKin(q, x));
+    ASSERT_NEAR(x[0], 1, 1e-9);
+}
+
 TEST_F( KdlSolverTest, KdlSolverInvDyn1)
 {
     std::vector<double> q(1),t;
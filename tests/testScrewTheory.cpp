@@ -1,13 +1,24 @@
 #include "gtest/gtest.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
 #include <functional>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 #include <utility>
 
 #include <kdl/chain.hpp>
 #include <kdl/chainfksolverpos_recursive.hpp>
+#include <kdl/chainjnttojacsolver.hpp>
 #include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
 #include <kdl/jntarray.hpp>
 #include <kdl/joint.hpp>
 #include <kdl/utilities/utility.h>
@@ -16,7 +27,43 @@
 #include "MatrixExponential.hpp"
 #include "ProductOfExponentials.hpp"
 #include "ScrewTheoryIkProblem.hpp"
+#include "ScrewTheoryIkProblemCache.hpp"
+#include "ScrewTheoryIkSolver.hpp"
 #include "ScrewTheoryIkSubproblems.hpp"
+#include "ScrewTheoryPathSolver.hpp"
+#include "ScrewTheoryRedundancySolver.hpp"
+#include "ThreadPool.hpp"
+
+#include "ScrewTheoryTestKinematics.hpp"
+
+namespace
+{
+    // Counts heap allocations while enabled, see ScrewTheoryIkProblemWorkspace.
+    std::atomic<bool> countAllocations(false);
+    std::atomic<int> allocations(0);
+}
+
+void * operator new(std::size_t size)
+{
+    if (countAllocations)
+    {
+        allocations++;
+    }
+
+    void * ptr = std::malloc(size == 0 ? 1 : size);
+
+    if (ptr == NULL)
+    {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void operator delete(void * ptr) noexcept
+{
+    std::free(ptr);
+}
 
 namespace roboticslab
 {
@@ -64,14 +111,16 @@ public:
         return chain;
     }
 
-    static PoeExpression makeTeoRightArmKinematicsFromPoE()
+    static PoeExpression makeRedundantArmKinematicsFromPoE()
     {
+        // TEO's right arm plus an extra joint along the upper arm, parallel to the elbow.
         KDL::Frame H_S_T(KDL::Vector(-0.63401, 0, 0));
         PoeExpression poe(H_S_T);
 
         poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 0, 1), KDL::Vector::Zero()));
         poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector::Zero()));
         poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector::Zero()));
+        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 0, 1), KDL::Vector(-0.2, 0, 0)));
         poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 0, 1), KDL::Vector(-0.32901, 0, 0)));
         poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(-0.32901, 0, 0)));
         poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 0, 1), KDL::Vector(-0.54401, 0, 0)));
@@ -94,21 +143,6 @@ public:
         return chain;
     }
 
-    static PoeExpression makeTeoRightLegKinematicsFromPoE()
-    {
-        KDL::Frame H_S_T(KDL::Rotation::RotY(-KDL::PI / 2) * KDL::Rotation::RotX(KDL::PI / 2), KDL::Vector(0.0175, 0, -0.753005));
-        PoeExpression poe(H_S_T);
-
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0,  0, 1), KDL::Vector::Zero()));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, -1, 0), KDL::Vector::Zero()));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1,  0, 0), KDL::Vector::Zero()));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1,  0, 0), KDL::Vector(     0, 0, -0.33)));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1,  0, 0), KDL::Vector(0.0175, 0, -0.63)));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, -1, 0), KDL::Vector(0.0175, 0, -0.63)));
-
-        return poe;
-    }
-
     static KDL::Chain makeAbbIrb120KinematicsFromDH()
     {
         const KDL::Joint rotZ(KDL::Joint::RotZ);
@@ -128,21 +162,6 @@ public:
         return chain;
     }
 
-    static PoeExpression makeAbbIrb120KinematicsFromPoE()
-    {
-        KDL::Frame H_S_T(KDL::Rotation::RotX(KDL::PI / 2) * KDL::Rotation::RotZ(KDL::PI / 2), KDL::Vector(0.302, 0.47, 0));
-        PoeExpression poe(H_S_T);
-
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0,  1, 0), KDL::Vector::Zero()));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0,  0, 1), KDL::Vector(    0, 0.29, 0)));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0,  0, 1), KDL::Vector(    0, 0.56, 0)));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1,  0, 0), KDL::Vector(0.302, 0.63, 0)));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0,  0, 1), KDL::Vector(0.302, 0.63, 0)));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, -1, 0), KDL::Vector(0.302, 0.63, 0)));
-
-        return poe;
-    }
-
     static KDL::Chain makePumaKinematicsFromDH()
     {
         const KDL::Joint rotZ(KDL::Joint::RotZ);
@@ -162,21 +181,6 @@ public:
         return chain;
     }
 
-    static PoeExpression makePumaKinematicsFromPoE()
-    {
-        KDL::Frame H_S_T(KDL::Vector(0, 5, 1));
-        PoeExpression poe(H_S_T);
-
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector::Zero()));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(0, 2, 0)));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(0, 3, 0)));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector(0, 3, 0)));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(0, 5, 0)));
-        poe.append(MatrixExponential(MatrixExponential::ROTATION, KDL::Vector(0, 0, 1), KDL::Vector(0, 5, 0)));
-
-        return poe;
-    }
-
     static KDL::Chain makeStanfordKinematicsFromDH()
     {
         const KDL::Joint rotZ(KDL::Joint::RotZ);
@@ -198,21 +202,6 @@ public:
         return chain;
     }
 
-    static PoeExpression makeStanfordKinematicsFromPoE()
-    {
-        KDL::Frame H_S_T(KDL::Vector(0, 5, 1));
-        PoeExpression poe(H_S_T);
-
-        poe.append(MatrixExponential(   MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector::Zero()));
-        poe.append(MatrixExponential(   MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(0, 2, 0)));
-        poe.append(MatrixExponential(MatrixExponential::TRANSLATION, KDL::Vector(0, 1, 0)));
-        poe.append(MatrixExponential(   MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector(0, 2, 0)));
-        poe.append(MatrixExponential(   MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(0, 5, 0)));
-        poe.append(MatrixExponential(   MatrixExponential::ROTATION, KDL::Vector(0, 0, 1), KDL::Vector(0, 5, 0)));
-
-        return poe;
-    }
-
     static KDL::Chain makeAbbIrb910scKinematicsFromDH()
     {
         const KDL::Joint rotZ(KDL::Joint::RotZ);
@@ -281,7 +270,7 @@ public:
 
     static void checkSolutions(const ScrewTheoryIkSubproblem::Solutions & actual, const ScrewTheoryIkSubproblem::Solutions & expected)
     {
-        ScrewTheoryIkSubproblem::JointIdsToSolutions actualSorted, expectedSorted;
+        std::vector<ScrewTheoryIkSubproblem::JointIdToSolution> actualSorted, expectedSorted;
 
         for (int i = 0; i < actual.size(); i++)
         {
@@ -311,6 +300,62 @@ public:
         }
     }
 
+    static void checkSubproblemBatch(const ScrewTheoryIkSubproblem & subproblem, const std::vector<MatrixExponential> & exps)
+    {
+        // not a multiple of the block size nor of any lane width
+        const int count = 101;
+
+        std::vector<KDL::Frame> rhs(count), pointTransforms(count);
+
+        for (int i = 0; i < count; i++)
+        {
+            double values[6];
+
+            for (int j = 0; j < 6; j++)
+            {
+                KDL::random(values[j]);
+            }
+
+            if (i % 2 == 0)
+            {
+                // reachable by construction, mostly
+                for (int j = 0; j < exps.size(); j++)
+                {
+                    rhs[i] = rhs[i] * exps[j].asFrame(3 * values[j]);
+                }
+            }
+            else
+            {
+                rhs[i] = KDL::Frame(KDL::Rotation::RPY(values[0], values[1], values[2]), KDL::Vector(values[3], values[4], values[5]));
+                pointTransforms[i] = KDL::Frame(KDL::Rotation::RPY(values[5], values[4], values[3]), KDL::Vector(values[2], values[1], values[0]));
+            }
+        }
+
+        std::vector<ScrewTheoryIkSubproblem::Solutions> batchSolutions(count);
+        bool batchReachable[count];
+
+        int reachableCount = subproblem.solveBatch(&rhs[0], &pointTransforms[0], count, &batchSolutions[0], batchReachable);
+        ASSERT_EQ(reachableCount, std::count(batchReachable, batchReachable + count, true));
+
+        for (int i = 0; i < count; i++)
+        {
+            ScrewTheoryIkSubproblem::Solutions solutions;
+            ASSERT_EQ(subproblem.solve(rhs[i], pointTransforms[i], solutions), batchReachable[i]);
+            ASSERT_EQ(batchSolutions[i].size(), solutions.size());
+
+            for (int j = 0; j < solutions.size(); j++)
+            {
+                ASSERT_EQ(batchSolutions[i][j].size(), solutions[j].size());
+
+                for (int k = 0; k < solutions[j].size(); k++)
+                {
+                    ASSERT_EQ(batchSolutions[i][j][k].first, solutions[j][k].first);
+                    ASSERT_NEAR(batchSolutions[i][j][k].second, solutions[j][k].second, KDL::epsilon);
+                }
+            }
+        }
+    }
+
     static void checkRobotKinematics(const KDL::Chain & chain, const PoeExpression & poe, int soln)
     {
         ASSERT_EQ(poe.size(), chain.getNrOfJoints());
@@ -347,6 +392,42 @@ public:
         }
     }
 
+    template <typename Solver>
+    static void checkIkSolver(const PoeExpression & poe, const std::string & type)
+    {
+        ScrewTheoryIkProblemBuilder builder(poe);
+        ScrewTheoryIkProblem * ikProblem = builder.build();
+
+        ASSERT_TRUE(ikProblem);
+        ASSERT_EQ(describeIkSolverType(*ikProblem), type);
+
+        Solver solver(*ikProblem);
+        ASSERT_TRUE(solver.isValid());
+        ASSERT_EQ(Solver::SOLUTIONS, ikProblem->solutions());
+
+        for (int i = 0; i < 10; i++)
+        {
+            KDL::JntArray q = fillJointValues(poe.size(), 0.1 * i);
+            KDL::Frame H_S_T;
+            ASSERT_TRUE(poe.evaluate(q, H_S_T));
+
+            ScrewTheoryIkProblem::Solutions expected;
+            typename Solver::Solutions actual;
+
+            ASSERT_EQ(solver.solve(H_S_T, actual), ikProblem->solve(H_S_T, expected));
+
+            for (int j = 0; j < Solver::SOLUTIONS; j++)
+            {
+                for (int k = 0; k < poe.size(); k++)
+                {
+                    ASSERT_EQ(actual[j][k], expected[j](k));
+                }
+            }
+        }
+
+        delete ikProblem;
+    }
+
     static int findTargetConfiguration(const ScrewTheoryIkProblem::Solutions & solutions, const KDL::JntArray & target)
     {
         for (int i = 0; i < solutions.size(); i++)
@@ -432,6 +513,52 @@ TEST_F(ScrewTheoryTest, MatrixExponentialTranslation)
     ASSERT_EQ(actual, expected);
 }
 
+TEST_F(ScrewTheoryTest, MatrixExponentialBatch)
+{
+    const int n = 10;
+    double thetas[n];
+    KDL::Frame frames[n];
+
+    for (int i = 0; i < n; i++)
+    {
+        thetas[i] = -KDL::PI + 0.7 * i;
+    }
+
+    KDL::Vector axis(1, -2, 3);
+    axis.Normalize();
+
+    KDL::Vector origin(0.5, 1, -0.2);
+
+    MatrixExponential rotation(MatrixExponential::ROTATION, axis, origin);
+    rotation.asFrames(thetas, n, frames);
+
+    for (int i = 0; i < n; i++)
+    {
+        // Rotate about an axis through the origin point.
+        KDL::Frame expected = KDL::Frame(origin) * KDL::Frame(KDL::Rotation::Rot(axis, thetas[i])) * KDL::Frame(-origin);
+        ASSERT_EQ(rotation.asFrame(thetas[i]), expected);
+        ASSERT_EQ(frames[i], expected);
+    }
+
+    // Precomputed terms must follow a change of base.
+    KDL::Frame H_new_old(KDL::Rotation::RPY(0.1, -0.4, 1.2), KDL::Vector(-1, 0.3, 2));
+    rotation.changeBase(H_new_old);
+
+    for (int i = 0; i < n; i++)
+    {
+        KDL::Frame expected = H_new_old * KDL::Frame(origin) * KDL::Frame(KDL::Rotation::Rot(axis, thetas[i])) * KDL::Frame(-origin) * H_new_old.Inverse();
+        ASSERT_EQ(rotation.asFrame(thetas[i]), expected);
+    }
+
+    MatrixExponential translation(MatrixExponential::TRANSLATION, axis);
+    translation.asFrames(thetas, n, frames);
+
+    for (int i = 0; i < n; i++)
+    {
+        ASSERT_EQ(frames[i], KDL::Frame(axis * thetas[i]));
+    }
+}
+
 TEST_F(ScrewTheoryTest, ProductOfExponentialsInit)
 {
     PoeExpression poe;
@@ -560,6 +687,141 @@ TEST_F(ScrewTheoryTest, ProductOfExponentialsReverse)
     ASSERT_EQ(H_S_T_q_reversed, H_S_T_q.Inverse());
 }
 
+TEST_F(ScrewTheoryTest, ProductOfExponentialsJacobian)
+{
+    KDL::Chain chain = makeAbbIrb120KinematicsFromDH();
+    PoeExpression poe = PoeExpression::fromChain(chain);
+    KDL::ChainJntToJacSolver jacSolver(chain);
+
+    const int n = poe.size();
+    const double dt = 1e-6;
+
+    KDL::Frame H, H_expected;
+    KDL::Jacobian J(n), Jdot(n), J_expected(n), J_wrong(n + 1);
+
+    ASSERT_FALSE(poe.evaluate(KDL::JntArray(n), H, J_wrong));
+    ASSERT_FALSE(poe.evaluate(KDL::JntArray(n), KDL::JntArray(n + 1), H, J, Jdot));
+
+    for (int i = 0; i < 10; i++)
+    {
+        KDL::JntArray q(n), qdot(n);
+
+        for (int j = 0; j < n; j++)
+        {
+            q(j) = 0.3 * (i + 1) - 0.2 * j;
+            qdot(j) = 0.5 - 0.1 * (i + j);
+        }
+
+        ASSERT_TRUE(poe.evaluate(q, H_expected));
+
+        // Hybrid representation, as in KDL.
+        ASSERT_TRUE(poe.evaluate(q, H, J, PoeExpression::HYBRID));
+        ASSERT_EQ(H, H_expected);
+        ASSERT_EQ(jacSolver.JntToJac(q, J_expected), KDL::SolverI::E_NOERROR);
+        ASSERT_LT((J.data - J_expected.data).cwiseAbs().maxCoeff(), 1e-9);
+
+        PoeExpression::jacobian_frame frames[] = {PoeExpression::SPATIAL, PoeExpression::BODY, PoeExpression::HYBRID};
+
+        for (int f = 0; f < 3; f++)
+        {
+            ASSERT_TRUE(poe.evaluate(q, qdot, H, J, Jdot, frames[f]));
+            ASSERT_EQ(H, H_expected);
+
+            // Same twists, different reference point and/or base.
+            for (int j = 0; j < n; j++)
+            {
+                KDL::Twist twist = J_expected.getColumn(j);
+
+                if (frames[f] == PoeExpression::SPATIAL)
+                {
+                    twist = twist.RefPoint(-H.p);
+                }
+                else if (frames[f] == PoeExpression::BODY)
+                {
+                    twist = H.M.Inverse() * twist;
+                }
+
+                ASSERT_TRUE(KDL::Equal(J.getColumn(j), twist, 1e-9));
+            }
+
+            // Central differences.
+            KDL::JntArray q_next(n), q_prev(n);
+            KDL::Jacobian J_next(n), J_prev(n);
+            KDL::Frame H_next;
+
+            for (int j = 0; j < n; j++)
+            {
+                q_next(j) = q(j) + qdot(j) * dt;
+                q_prev(j) = q(j) - qdot(j) * dt;
+            }
+
+            ASSERT_TRUE(poe.evaluate(q_next, H_next, J_next, frames[f]));
+            ASSERT_TRUE(poe.evaluate(q_prev, H_next, J_prev, frames[f]));
+            ASSERT_LT((Jdot.data - (J_next.data - J_prev.data) / (2 * dt)).cwiseAbs().maxCoeff(), 1e-6);
+        }
+    }
+}
+
+TEST_F(ScrewTheoryTest, PoeEvaluator)
+{
+    PoeExpression poe = makeTeoRightArmKinematicsFromPoE();
+    PoeEvaluator evaluator(poe);
+
+    KDL::Frame H_S_T, H_S_T_evaluator;
+    KDL::JntArray q(poe.size());
+
+    ASSERT_FALSE(evaluator.evaluate(KDL::JntArray(poe.size() + 1), H_S_T_evaluator));
+
+    ASSERT_TRUE(poe.evaluate(q, H_S_T));
+    ASSERT_TRUE(evaluator.evaluate(q, H_S_T_evaluator));
+    ASSERT_EQ(H_S_T_evaluator, H_S_T);
+    ASSERT_EQ(evaluator.getUpdatedTerms(), poe.size());
+
+    // Same joint values, nothing to do.
+    ASSERT_TRUE(evaluator.evaluate(q, H_S_T_evaluator));
+    ASSERT_EQ(H_S_T_evaluator, H_S_T);
+    ASSERT_EQ(evaluator.getUpdatedTerms(), 0);
+
+    // Change one joint at a time, results must be identical to a full evaluation.
+    for (int i = 0; i < 3 * poe.size(); i++)
+    {
+        int id = (i * 5) % poe.size();
+        q(id) += 0.1 * (i + 1);
+
+        ASSERT_TRUE(poe.evaluate(q, H_S_T));
+        ASSERT_TRUE(evaluator.evaluate(q, H_S_T_evaluator));
+        ASSERT_EQ(H_S_T_evaluator, H_S_T);
+        ASSERT_EQ(evaluator.getUpdatedTerms(), 1);
+        ASSERT_EQ(evaluator.getPrefix(poe.size() - 1) * poe.getTransform(), H_S_T);
+
+        KDL::Frame H_prefix = KDL::Frame::Identity();
+
+        for (int j = 0; j < poe.size(); j++)
+        {
+            H_prefix = H_prefix * poe.exponentialAtJoint(j).asFrame(q(j));
+            ASSERT_TRUE(KDL::Equal(evaluator.getPrefix(j), H_prefix, KDL::epsilon));
+            ASSERT_TRUE(KDL::Equal(evaluator.getPrefix(j) * evaluator.getSuffix(j + 1), H_S_T, KDL::epsilon));
+        }
+
+        ASSERT_EQ(evaluator.getSuffix(poe.size()), poe.getTransform());
+        ASSERT_TRUE(KDL::Equal(evaluator.getSuffix(0), H_S_T, KDL::epsilon));
+    }
+
+    // Change all joints.
+    q = fillJointValues(poe.size(), KDL::PI / 2);
+
+    ASSERT_TRUE(poe.evaluate(q, H_S_T));
+    ASSERT_TRUE(evaluator.evaluate(q, H_S_T_evaluator));
+    ASSERT_EQ(H_S_T_evaluator, H_S_T);
+    ASSERT_EQ(evaluator.getUpdatedTerms(), poe.size());
+
+    evaluator.reset();
+
+    ASSERT_TRUE(evaluator.evaluate(q, H_S_T_evaluator));
+    ASSERT_EQ(H_S_T_evaluator, H_S_T);
+    ASSERT_EQ(evaluator.getUpdatedTerms(), poe.size());
+}
+
 TEST_F(ScrewTheoryTest, PadenKahanOne)
 {
     KDL::Vector p(0, 1, 0);
@@ -849,6 +1111,50 @@ TEST_F(ScrewTheoryTest, PardosFour)
     checkSolutions(actual, expected);
 }
 
+TEST_F(ScrewTheoryTest, ScrewTheoryIkSubproblemBatch)
+{
+    MatrixExponential rot1(MatrixExponential::ROTATION, KDL::Vector(1, 0, 0), KDL::Vector(1, 0, 0));
+    MatrixExponential rot2(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector(1, 0, 0));
+    MatrixExponential rot3(MatrixExponential::ROTATION, KDL::Vector(0, 1, 0), KDL::Vector(2, 0, 0));
+    MatrixExponential trans1(MatrixExponential::TRANSLATION, KDL::Vector(0, 1, 0));
+    MatrixExponential trans2(MatrixExponential::TRANSLATION, KDL::Vector(1, 0, 0));
+
+    KDL::Vector p(0, 1, 0);
+    KDL::Vector k(2, 1, 1);
+
+    PadenKahanOne pk1(0, rot2, p + KDL::Vector(0, 0, 1));
+    PadenKahanTwo pk2(0, 1, rot1, rot2, p, rot1.getOrigin());
+    PadenKahanThree pk3(0, rot2, p, k);
+    PardosGotorOne pg1(0, trans1, p);
+    PardosGotorTwo pg2(0, 1, trans1, trans2, p);
+    PardosGotorThree pg3(0, trans1, p, k);
+    PardosGotorFour pg4(0, 1, rot3, rot2, p);
+
+    std::vector<const SubproblemKernels *> kernelSets;
+    kernelSets.push_back(&getScalarSubproblemKernels());
+
+    if (getSimdSubproblemKernels() != NULL)
+    {
+        kernelSets.push_back(getSimdSubproblemKernels());
+    }
+
+    for (int i = 0; i < kernelSets.size(); i++)
+    {
+        setUseSimdSubproblemKernels(kernelSets[i] != &getScalarSubproblemKernels());
+        ASSERT_EQ(&getSubproblemKernels(), kernelSets[i]);
+
+        checkSubproblemBatch(pk1, std::vector<MatrixExponential>(1, rot2));
+        checkSubproblemBatch(pk2, {rot1, rot2});
+        checkSubproblemBatch(pk3, std::vector<MatrixExponential>(1, rot2));
+        checkSubproblemBatch(pg1, std::vector<MatrixExponential>(1, trans1));
+        checkSubproblemBatch(pg2, {trans1, trans2});
+        checkSubproblemBatch(pg3, std::vector<MatrixExponential>(1, trans1));
+        checkSubproblemBatch(pg4, {rot3, rot2});
+    }
+
+    setUseSimdSubproblemKernels(true);
+}
+
 TEST_F(ScrewTheoryTest, AbbIrb120Kinematics)
 {
     KDL::Chain chain = makeAbbIrb120KinematicsFromDH();
@@ -905,6 +1211,671 @@ TEST_F(ScrewTheoryTest, TeoRightLegKinematics)
     checkRobotKinematics(chain, poe, 8);
 }
 
+TEST_F(ScrewTheoryTest, ScrewTheoryIkProblemBatch)
+{
+    PoeExpression poe = makeAbbIrb120KinematicsFromPoE();
+
+    ScrewTheoryIkProblemBuilder builder(poe);
+    ScrewTheoryIkProblem * ikProblem = builder.build();
+
+    ASSERT_TRUE(ikProblem);
+
+    const int count = 10;
+    const int soln = ikProblem->solutions();
+
+    std::vector<KDL::Frame> targets(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        KDL::JntArray q = fillJointValues(poe.size(), 0.1 * i);
+        ASSERT_TRUE(poe.evaluate(q, targets[i]));
+    }
+
+    std::vector<KDL::JntArray> batchSolutions(count * soln, KDL::JntArray(poe.size()));
+    bool reachable[count];
+
+    ThreadPool pool(2);
+    ASSERT_EQ(pool.size(), 2);
+
+    ASSERT_EQ(ikProblem->solveBatch(&targets[0], count, &batchSolutions[0], reachable, &pool), count);
+
+    for (int i = 0; i < count; i++)
+    {
+        ScrewTheoryIkProblem::Solutions solutions;
+        ASSERT_EQ(ikProblem->solve(targets[i], solutions), reachable[i]);
+        ASSERT_EQ(solutions.size(), soln);
+
+        for (int j = 0; j < soln; j++)
+        {
+            ASSERT_EQ(batchSolutions[i * soln + j], solutions[j]);
+        }
+    }
+
+    delete ikProblem;
+}
+
+TEST_F(ScrewTheoryTest, ScrewTheoryIkProblemWorkspace)
+{
+    PoeExpression poe = makeAbbIrb120KinematicsFromPoE();
+
+    ScrewTheoryIkProblemBuilder builder(poe);
+    ScrewTheoryIkProblem * ikProblem = builder.build();
+
+    ASSERT_TRUE(ikProblem);
+
+    const int count = 10;
+    const int soln = ikProblem->solutions();
+
+    std::vector<KDL::Frame> targets(count);
+    std::vector<ScrewTheoryIkProblem::Solutions> expected(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        KDL::JntArray q = fillJointValues(poe.size(), 0.1 * i);
+        ASSERT_TRUE(poe.evaluate(q, targets[i]));
+        ASSERT_TRUE(ikProblem->solve(targets[i], expected[i]));
+    }
+
+    ScrewTheoryIkProblem::Workspace workspace(*ikProblem);
+    ScrewTheoryIkProblem::Solutions solutions;
+
+    // warm-up
+    ASSERT_TRUE(ikProblem->solve(targets[0], solutions, workspace));
+
+    allocations = 0;
+    countAllocations = true;
+
+    bool reachable = true;
+
+    for (int i = 0; i < count; i++)
+    {
+        reachable = reachable && ikProblem->solve(targets[i], solutions, workspace);
+        reachable = reachable && solutions == expected[i];
+    }
+
+    countAllocations = false;
+
+    ASSERT_TRUE(reachable);
+    ASSERT_EQ(allocations, 0);
+
+    // same instance shared across threads, one workspace each
+    const int threads = 4;
+    std::atomic<int> mismatches(0);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++)
+    {
+        workers.push_back(std::thread([&]()
+        {
+            ScrewTheoryIkProblem::Workspace localWorkspace(*ikProblem);
+            ScrewTheoryIkProblem::Solutions localSolutions;
+
+            for (int n = 0; n < 100; n++)
+            {
+                int i = n % count;
+
+                if (!ikProblem->solve(targets[i], localSolutions, localWorkspace) || localSolutions != expected[i])
+                {
+                    mismatches++;
+                }
+            }
+        }));
+    }
+
+    for (int t = 0; t < threads; t++)
+    {
+        workers[t].join();
+    }
+
+    ASSERT_EQ(mismatches, 0);
+    ASSERT_EQ(solutions.size(), soln);
+
+    delete ikProblem;
+}
+
+TEST_F(ScrewTheoryTest, ScrewTheoryIkSolver)
+{
+    checkIkSolver<ScrewTheoryIkSolver<6, PadenKahanThree, PadenKahanTwo, PadenKahanTwo, PadenKahanOne> >(
+            makeAbbIrb120KinematicsFromPoE(),
+            "ScrewTheoryIkSolver<6, PadenKahanThree, PadenKahanTwo, PadenKahanTwo, PadenKahanOne>");
+
+    checkIkSolver<ScrewTheoryIkSolver<6, PardosGotorThree, PadenKahanTwo, PadenKahanTwo, PadenKahanOne> >(
+            makeStanfordKinematicsFromPoE(),
+            "ScrewTheoryIkSolver<6, PardosGotorThree, PadenKahanTwo, PadenKahanTwo, PadenKahanOne>");
+
+    checkIkSolver<ScrewTheoryIkSolver<4, PardosGotorOne, PardosGotorFour, PadenKahanOne> >(
+            makeAbbIrb910scKinematicsFromPoE(),
+            "ScrewTheoryIkSolver<4, PardosGotorOne, PardosGotorFour, PadenKahanOne>");
+
+    checkIkSolver<ScrewTheoryIkSolver<6, PardosGotorOne, PardosGotorFour, PadenKahanTwo, PadenKahanOne> >(
+            makeAbbIrb6620lxFromPoE(),
+            "ScrewTheoryIkSolver<6, PardosGotorOne, PardosGotorFour, PadenKahanTwo, PadenKahanOne>");
+
+    // reversed POE
+    checkIkSolver<ScrewTheoryIkSolver<6, PadenKahanThree, PadenKahanTwo, PadenKahanTwo, PadenKahanOne> >(
+            makeTeoRightLegKinematicsFromPoE(),
+            "ScrewTheoryIkSolver<6, PadenKahanThree, PadenKahanTwo, PadenKahanTwo, PadenKahanOne>");
+
+    // mismatched template arguments
+    PoeExpression poe = makeAbbIrb120KinematicsFromPoE();
+    ScrewTheoryIkProblemBuilder builder(poe);
+    ScrewTheoryIkProblem * ikProblem = builder.build();
+
+    ASSERT_TRUE(ikProblem);
+
+    ScrewTheoryIkSolver<6, PadenKahanThree, PadenKahanTwo, PadenKahanTwo, PadenKahanOne> solver(*ikProblem);
+    ASSERT_TRUE(solver.isValid());
+
+    ScrewTheoryIkSolver<6, PadenKahanTwo, PadenKahanThree, PadenKahanTwo, PadenKahanOne> wrongSteps(*ikProblem);
+    ASSERT_FALSE(wrongSteps.isValid());
+
+    ScrewTheoryIkSolver<5, PadenKahanThree, PadenKahanTwo, PadenKahanTwo, PadenKahanOne> wrongDof(*ikProblem);
+    ASSERT_FALSE(wrongDof.isValid());
+
+    decltype(wrongDof)::Solutions solutions;
+    ASSERT_FALSE(wrongDof.solve(KDL::Frame::Identity(), solutions));
+
+    delete ikProblem;
+}
+
+TEST_F(ScrewTheoryTest, ScrewTheoryIkProblemCache)
+{
+    const std::string directory = testing::TempDir();
+
+    PoeExpression poes[] = {makeAbbIrb120KinematicsFromPoE(), makeTeoRightLegKinematicsFromPoE()};
+
+    ASSERT_NE(ScrewTheoryIkProblemCache::makeKey(poes[0]), ScrewTheoryIkProblemCache::makeKey(poes[1]));
+    ASSERT_EQ(ScrewTheoryIkProblemCache::makeKey(poes[0]), ScrewTheoryIkProblemCache::makeKey(makeAbbIrb120KinematicsFromPoE()));
+
+    for (int n = 0; n < 2; n++)
+    {
+        const PoeExpression & poe = poes[n];
+        const std::string path = directory + "/" + ScrewTheoryIkProblemCache::makeKey(poe) + ".txt";
+        std::remove(path.c_str());
+
+        // full search, stored on disk
+        ScrewTheoryIkProblemBuilder::Description description;
+        ScrewTheoryIkProblemBuilder builder(poe);
+        ScrewTheoryIkProblem * reference = builder.build(description);
+
+        ASSERT_TRUE(reference);
+        ASSERT_EQ(description.reversed, reference->isReversed());
+        ASSERT_EQ(description.steps.size(), reference->getSteps().size());
+
+        // text round trip
+        std::stringstream ss;
+        ASSERT_TRUE(ScrewTheoryIkProblemCache::serialize(description, ss));
+
+        ScrewTheoryIkProblemBuilder::Description parsed;
+        ASSERT_TRUE(ScrewTheoryIkProblemCache::deserialize(ss, parsed));
+        ASSERT_EQ(parsed.reversed, description.reversed);
+        ASSERT_EQ(parsed.steps.size(), description.steps.size());
+
+        for (int i = 0; i < parsed.steps.size(); i++)
+        {
+            ASSERT_EQ(parsed.steps[i].type, description.steps[i].type);
+            ASSERT_EQ(parsed.steps[i].ids, description.steps[i].ids);
+            ASSERT_EQ(parsed.steps[i].points, description.steps[i].points);
+        }
+
+        ScrewTheoryIkProblem * first = ScrewTheoryIkProblemCache(directory).build(poe);
+        ASSERT_TRUE(first);
+
+        std::ifstream ifs(path.c_str());
+        ASSERT_TRUE(ifs.is_open());
+        ifs.close();
+
+        // another instance, loaded from disk, no search involved
+        ScrewTheoryIkProblemCache cache(directory);
+        ScrewTheoryIkProblem * second = cache.build(poe);
+        ScrewTheoryIkProblem * replayed = ScrewTheoryIkProblemBuilder::rebuild(poe, parsed);
+
+        ASSERT_TRUE(second);
+        ASSERT_TRUE(replayed);
+        ASSERT_EQ(describeIkSolverType(*second), describeIkSolverType(*first));
+
+        for (int i = 0; i < 10; i++)
+        {
+            KDL::JntArray q = fillJointValues(poe.size(), 0.1 * i);
+            KDL::Frame H_S_T;
+            ASSERT_TRUE(poe.evaluate(q, H_S_T));
+
+            ScrewTheoryIkProblem::Solutions solutionsFirst, solutionsSecond, solutionsReplayed;
+
+            ASSERT_EQ(first->solve(H_S_T, solutionsFirst), second->solve(H_S_T, solutionsSecond));
+            ASSERT_EQ(solutionsFirst, solutionsSecond);
+
+            ASSERT_EQ(replayed->solve(H_S_T, solutionsReplayed), second->solve(H_S_T, solutionsSecond));
+            ASSERT_EQ(solutionsReplayed, solutionsSecond);
+        }
+
+        delete reference;
+        delete first;
+        delete second;
+        delete replayed;
+
+        // corrupted file, search again and overwrite
+        std::ofstream ofs(path.c_str());
+        ofs << "ScrewTheoryIkProblem 1\nreversed 0\nsteps 1\nPadenKahanOne 1 42 1 0 0 0\n";
+        ofs.close();
+
+        ScrewTheoryIkProblem * third = ScrewTheoryIkProblemCache(directory).build(poe);
+        ASSERT_TRUE(third);
+        delete third;
+
+        ScrewTheoryIkProblemBuilder::Description restored;
+        std::ifstream ifs2(path.c_str());
+        ASSERT_TRUE(ScrewTheoryIkProblemCache::deserialize(ifs2, restored));
+        ASSERT_EQ(restored.steps.size(), description.steps.size());
+
+        std::remove(path.c_str());
+    }
+
+    // malformed input
+    ScrewTheoryIkProblemBuilder::Description description;
+    std::istringstream iss("ScrewTheoryIkProblem 1\nreversed 0\nsteps 1\nFooBar 1 0 1 0 0 0\n");
+    ASSERT_FALSE(ScrewTheoryIkProblemCache::deserialize(iss, description));
+}
+
+TEST_F(ScrewTheoryTest, ScrewTheoryIkProblemToolFrame)
+{
+    // not reversed, reversed
+    PoeExpression poes[] = {makeAbbIrb120KinematicsFromPoE(), makeTeoRightLegKinematicsFromPoE()};
+
+    const KDL::Frame H_new_old(KDL::Rotation::RPY(0.1, -0.2, 0.3), KDL::Vector(0.05, -0.1, 0.2));
+
+    for (int n = 0; n < 2; n++)
+    {
+        PoeExpression poe = poes[n];
+
+        ScrewTheoryIkProblemBuilder::Description description;
+        ScrewTheoryIkProblemBuilder builder(poe);
+        ScrewTheoryIkProblem * ikProblem = builder.build(description);
+
+        ASSERT_TRUE(ikProblem);
+        ASSERT_EQ(description.reversed, n == 1);
+
+        poe.changeToolFrame(H_new_old);
+        ScrewTheoryIkProblemBuilder::changeToolFrame(description, H_new_old);
+
+        ScrewTheoryIkProblem * toolProblem = ScrewTheoryIkProblemBuilder::rebuild(poe, description);
+
+        ASSERT_TRUE(toolProblem);
+        ASSERT_EQ(toolProblem->solutions(), ikProblem->solutions());
+
+        // skip singular (stretched) configuration at q = 0
+        for (int i = 1; i < 10; i++)
+        {
+            KDL::JntArray q = fillJointValues(poe.size(), 0.1 * i);
+            KDL::Frame H_S_T_q;
+            ASSERT_TRUE(poe.evaluate(q, H_S_T_q));
+
+            ScrewTheoryIkProblem::Solutions solutions;
+            ASSERT_TRUE(toolProblem->solve(H_S_T_q, solutions));
+            ASSERT_NE(findTargetConfiguration(solutions, q), -1);
+
+            for (int j = 0; j < solutions.size(); j++)
+            {
+                KDL::Frame H_S_T_q_validate;
+                ASSERT_TRUE(poe.evaluate(solutions[j], H_S_T_q_validate));
+                ASSERT_EQ(H_S_T_q_validate, H_S_T_q);
+            }
+        }
+
+        delete ikProblem;
+        delete toolProblem;
+    }
+}
+
+TEST_F(ScrewTheoryTest, ScrewTheoryIkProblemPruning)
+{
+    // not reversed, reversed
+    PoeExpression poes[] = {makeAbbIrb120KinematicsFromPoE(), makeTeoRightLegKinematicsFromPoE()};
+
+    for (int n = 0; n < 2; n++)
+    {
+        const PoeExpression & poe = poes[n];
+
+        ScrewTheoryIkProblemBuilder builder(poe);
+        ScrewTheoryIkProblem * ikProblem = builder.build();
+
+        ASSERT_TRUE(ikProblem);
+
+        ScrewTheoryIkProblem::Workspace workspace(*ikProblem);
+
+        KDL::JntArray qMin = fillJointValues(poe.size(), -1.0);
+        KDL::JntArray qMax = fillJointValues(poe.size(), 1.0);
+
+        KDL::JntArray qMinWide = fillJointValues(poe.size(), -10.0);
+        KDL::JntArray qMaxWide = fillJointValues(poe.size(), 10.0);
+
+        ScrewTheoryIkProblem::PruningStats stats, statsWide;
+
+        for (int i = 1; i < 10; i++)
+        {
+            KDL::JntArray q = fillJointValues(poe.size(), 0.1 * i);
+            KDL::Frame H_S_T_q;
+            ASSERT_TRUE(poe.evaluate(q, H_S_T_q));
+
+            ScrewTheoryIkProblem::Solutions expected, actual;
+            ASSERT_TRUE(ikProblem->solve(H_S_T_q, expected));
+            ASSERT_TRUE(ikProblem->solve(H_S_T_q, actual, qMin, qMax, workspace, &stats));
+            ASSERT_EQ(actual.size(), expected.size());
+
+            for (int j = 0; j < expected.size(); j++)
+            {
+                bool valid = true;
+
+                for (int k = 0; k < poe.size(); k++)
+                {
+                    valid = valid && expected[j](k) >= qMin(k) - KDL::epsilon && expected[j](k) <= qMax(k) + KDL::epsilon;
+                }
+
+                if (valid)
+                {
+                    // Untouched by pruning.
+                    ASSERT_EQ(actual[j], expected[j]);
+                }
+                else
+                {
+                    // Must be rejected by the configuration selector, too.
+                    bool anyOutOfLimits = false;
+
+                    for (int k = 0; k < poe.size(); k++)
+                    {
+                        anyOutOfLimits = anyOutOfLimits || actual[j](k) < qMin(k) - KDL::epsilon || actual[j](k) > qMax(k) + KDL::epsilon;
+                    }
+
+                    ASSERT_TRUE(anyOutOfLimits);
+                }
+            }
+
+            ASSERT_NE(findTargetConfiguration(actual, q), -1);
+
+            ASSERT_TRUE(ikProblem->solve(H_S_T_q, actual, qMinWide, qMaxWide, workspace, &statsWide));
+            ASSERT_EQ(actual, expected);
+        }
+
+        ASSERT_GT(stats.skippedSubproblems, 0);
+        ASSERT_GT(stats.prunedSolutions, 0);
+        ASSERT_EQ(stats.solvedSubproblems + stats.skippedSubproblems, statsWide.solvedSubproblems);
+
+        ASSERT_EQ(statsWide.skippedSubproblems, 0);
+        ASSERT_EQ(statsWide.prunedSolutions, 0);
+
+        delete ikProblem;
+    }
+}
+
+TEST_F(ScrewTheoryTest, ScrewTheoryIkProblemBranch)
+{
+    PoeExpression poes[] = {
+        makeAbbIrb120KinematicsFromPoE(),
+        makePumaKinematicsFromPoE(),
+        makeStanfordKinematicsFromPoE(),
+        makeTeoRightArmKinematicsFromPoE(),
+        makeTeoRightLegKinematicsFromPoE() // reversed
+    };
+
+    for (int n = 0; n < sizeof(poes) / sizeof(poes[0]); n++)
+    {
+        const PoeExpression & poe = poes[n];
+
+        ScrewTheoryIkProblemBuilder builder(poe);
+        ScrewTheoryIkProblem * ikProblem = builder.build();
+
+        ASSERT_TRUE(ikProblem);
+
+        ScrewTheoryIkProblem::Workspace workspace(*ikProblem);
+        KDL::JntArray solution;
+
+        ASSERT_FALSE(ikProblem->solveBranch(KDL::Frame::Identity(), -1, solution, workspace));
+        ASSERT_FALSE(ikProblem->solveBranch(KDL::Frame::Identity(), ikProblem->solutions(), solution, workspace));
+
+        for (int i = 1; i < 10; i++)
+        {
+            KDL::JntArray q = fillJointValues(poe.size(), 0.1 * i);
+            KDL::Frame H_S_T_q;
+            ASSERT_TRUE(poe.evaluate(q, H_S_T_q));
+
+            ScrewTheoryIkProblem::Solutions solutions;
+            ASSERT_TRUE(ikProblem->solve(H_S_T_q, solutions));
+
+            for (int j = 0; j < solutions.size(); j++)
+            {
+                ASSERT_TRUE(ikProblem->solveBranch(H_S_T_q, j, solution, workspace));
+                ASSERT_EQ(solution.rows(), poe.size());
+
+                for (int k = 0; k < poe.size(); k++)
+                {
+                    // Same operations, same results.
+                    ASSERT_EQ(solution(k), solutions[j](k));
+                }
+            }
+        }
+
+        delete ikProblem;
+    }
+}
+
+TEST_F(ScrewTheoryTest, ScrewTheoryIkProblemIterator)
+{
+    PoeExpression poes[] = {
+        makeAbbIrb120KinematicsFromPoE(),
+        makePumaKinematicsFromPoE(),
+        makeStanfordKinematicsFromPoE(),
+        makeTeoRightArmKinematicsFromPoE(),
+        makeTeoRightLegKinematicsFromPoE() // reversed
+    };
+
+    for (int n = 0; n < sizeof(poes) / sizeof(poes[0]); n++)
+    {
+        const PoeExpression & poe = poes[n];
+
+        ScrewTheoryIkProblemBuilder builder(poe);
+        ScrewTheoryIkProblem * ikProblem = builder.build();
+
+        ASSERT_TRUE(ikProblem);
+
+        for (int i = 1; i < 10; i++)
+        {
+            KDL::JntArray q = fillJointValues(poe.size(), 0.1 * i);
+            KDL::Frame H_S_T_q;
+            ASSERT_TRUE(poe.evaluate(q, H_S_T_q));
+
+            ScrewTheoryIkProblem::Solutions solutions;
+            ASSERT_TRUE(ikProblem->solve(H_S_T_q, solutions));
+
+            ScrewTheoryIkProblem::SolutionIterator it(*ikProblem, H_S_T_q);
+            std::vector<bool> visited(solutions.size(), false);
+            KDL::JntArray solution;
+            int count = 0;
+
+            while (it.next(solution))
+            {
+                if (count == 0)
+                {
+                    // Lazy evaluation, one subproblem per step.
+                    ASSERT_EQ(it.solvedSubproblems(), ikProblem->getSteps().size());
+                }
+
+                ASSERT_GE(it.index(), 0);
+                ASSERT_LT(it.index(), solutions.size());
+                ASSERT_FALSE(visited[it.index()]);
+                ASSERT_TRUE(it.isReachable());
+
+                for (int k = 0; k < poe.size(); k++)
+                {
+                    ASSERT_EQ(solution(k), solutions[it.index()](k));
+                }
+
+                visited[it.index()] = true;
+                count++;
+            }
+
+            ASSERT_EQ(count, solutions.size());
+            ASSERT_FALSE(it.next(solution));
+
+            // Stop at the solution that matches the original joint values.
+            int index = ikProblem->findSolution(H_S_T_q, [&q](const KDL::JntArray & candidate, bool reachable)
+                {
+                    return reachable && KDL::Equal(candidate, q);
+                },
+                solution);
+
+            ASSERT_NE(index, -1);
+            ASSERT_EQ(index, findTargetConfiguration(solutions, q));
+            ASSERT_TRUE(KDL::Equal(solution, q));
+
+            index = ikProblem->findSolution(H_S_T_q, [](const KDL::JntArray &, bool) { return false; }, solution);
+            ASSERT_EQ(index, -1);
+        }
+
+        delete ikProblem;
+    }
+}
+
+TEST_F(ScrewTheoryTest, ScrewTheoryPathSolver)
+{
+    // not reversed, reversed
+    PoeExpression poes[] = {makeAbbIrb120KinematicsFromPoE(), makeTeoRightLegKinematicsFromPoE()};
+
+    for (int n = 0; n < 2; n++)
+    {
+        const PoeExpression & poe = poes[n];
+
+        ScrewTheoryIkProblemBuilder builder(poe);
+        ScrewTheoryIkProblem * ikProblem = builder.build();
+
+        ASSERT_TRUE(ikProblem);
+
+        KDL::JntArray qMin = fillJointValues(poe.size(), -KDL::PI);
+        KDL::JntArray qMax = fillJointValues(poe.size(), KDL::PI);
+
+        // Smooth joint-space path, sampled in cartesian space.
+        std::vector<KDL::JntArray> expected;
+        std::vector<KDL::Frame> waypoints;
+
+        for (int i = 0; i < 50; i++)
+        {
+            KDL::JntArray q = fillJointValues(poe.size(), 0.1 + 0.02 * i);
+            KDL::Frame H_S_T_q;
+            ASSERT_TRUE(poe.evaluate(q, H_S_T_q));
+
+            expected.push_back(q);
+            waypoints.push_back(H_S_T_q);
+        }
+
+        ScrewTheoryPathSolver pathSolver(*ikProblem, qMin, qMax);
+        ThreadPool pool(4);
+
+        std::vector<KDL::JntArray> path, pathPool;
+        double cost, costPool;
+
+        ASSERT_TRUE(pathSolver.solve(waypoints, expected[0], path, NULL, &cost));
+        ASSERT_TRUE(pathSolver.solve(waypoints, expected[0], pathPool, &pool, &costPool));
+
+        ASSERT_EQ(path.size(), waypoints.size());
+        ASSERT_EQ(pathPool, path);
+        ASSERT_EQ(costPool, cost);
+
+        // Greedy selection, one waypoint at a time.
+        double greedyCost = 0.0;
+        KDL::JntArray qPrevious = expected[0];
+
+        for (int i = 0; i < waypoints.size(); i++)
+        {
+            KDL::Frame H_S_T_q;
+            ASSERT_TRUE(poe.evaluate(path[i], H_S_T_q));
+            ASSERT_EQ(H_S_T_q, waypoints[i]);
+            ASSERT_TRUE(KDL::Equal(path[i], expected[i]));
+
+            ScrewTheoryIkProblem::Solutions solutions;
+            ASSERT_TRUE(ikProblem->solve(waypoints[i], solutions));
+
+            ConfigurationSelectorLeastOverallAngularDisplacement selector(qMin, qMax);
+            ASSERT_TRUE(selector.configure(solutions));
+            ASSERT_TRUE(selector.findOptimalConfiguration(qPrevious));
+
+            KDL::JntArray q;
+            selector.retrievePose(q);
+
+            for (int j = 0; j < poe.size(); j++)
+            {
+                greedyCost += std::abs(q(j) - qPrevious(j));
+            }
+
+            qPrevious = q;
+        }
+
+        ASSERT_LE(cost, greedyCost + KDL::epsilon);
+
+        // No solution within these limits.
+        ScrewTheoryPathSolver narrowPathSolver(*ikProblem, fillJointValues(poe.size(), -0.01), fillJointValues(poe.size(), 0.01));
+        ASSERT_FALSE(narrowPathSolver.solve(waypoints, expected[0], path));
+
+        delete ikProblem;
+    }
+}
+
+TEST_F(ScrewTheoryTest, ScrewTheoryRedundancySolver)
+{
+    PoeExpression poe = makeRedundantArmKinematicsFromPoE();
+    const int redundantJoint = 3;
+
+    ASSERT_FALSE(ScrewTheoryRedundancySolver::create(poe, poe.size(), -1.0, 1.0, 21));
+    ASSERT_FALSE(ScrewTheoryRedundancySolver::create(poe, redundantJoint, -1.0, 1.0, 0));
+
+    // Samples every 0.1 radians.
+    ScrewTheoryRedundancySolver * solver = ScrewTheoryRedundancySolver::create(poe, redundantJoint, -1.0, 1.0, 21);
+
+    ASSERT_TRUE(solver);
+    ASSERT_EQ(solver->getSamples(), 21);
+    ASSERT_EQ(solver->getRedundantJoint(), redundantJoint);
+    ASSERT_NEAR(solver->getSample(0), -1.0, KDL::epsilon);
+    ASSERT_NEAR(solver->getSample(20), 1.0, KDL::epsilon);
+
+    KDL::JntArray qMin = fillJointValues(poe.size(), -KDL::PI);
+    KDL::JntArray qMax = fillJointValues(poe.size(), KDL::PI);
+
+    ThreadPool pool(4);
+
+    for (int i = 1; i < 10; i++)
+    {
+        KDL::JntArray q = fillJointValues(poe.size(), 0.1 * i);
+        KDL::Frame H_S_T_q;
+        ASSERT_TRUE(poe.evaluate(q, H_S_T_q));
+
+        // Stateless selection, each query starts anew.
+        ConfigurationSelectorLeastOverallAngularDisplacement selector(qMin, qMax);
+        ConfigurationSelectorLeastOverallAngularDisplacement selectorPool(qMin, qMax);
+
+        KDL::JntArray actual, actualPool;
+        ASSERT_TRUE(solver->solve(H_S_T_q, selector, q, actual));
+        ASSERT_TRUE(solver->solve(H_S_T_q, selectorPool, q, actualPool, &pool));
+
+        // Redundant joint lies on the grid, thus the original configuration is found.
+        ASSERT_TRUE(KDL::Equal(actual, q));
+        ASSERT_EQ(actualPool, actual);
+
+        // Now off the grid, any nearby sample will do.
+        q(redundantJoint) += 0.05;
+        ASSERT_TRUE(poe.evaluate(q, H_S_T_q));
+        ASSERT_TRUE(solver->solve(H_S_T_q, selectorPool, q, actual, &pool));
+
+        KDL::Frame H_S_T_actual;
+        ASSERT_TRUE(poe.evaluate(actual, H_S_T_actual));
+        ASSERT_EQ(H_S_T_actual, H_S_T_q);
+    }
+
+    // Out of reach.
+    ConfigurationSelectorLeastOverallAngularDisplacement selector(qMin, qMax);
+    KDL::JntArray q = fillJointValues(poe.size(), 0.0), actual;
+    ASSERT_FALSE(solver->solve(KDL::Frame(KDL::Vector(2.0, 0, 0)), selector, q, actual));
+
+    delete solver;
+}
+
 TEST_F(ScrewTheoryTest, ConfigurationSelector)
 {
     PoeExpression poe = makeTeoRightArmKinematicsFromPoE();